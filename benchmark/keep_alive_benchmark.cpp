@@ -0,0 +1,137 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Load harness for HTTP keep-alive: drives a number of persistent connections against the REST
+// server and reports the request rate and the latency percentiles.
+//
+// Usage: keep_alive_benchmark [connections] [requests per connection]
+
+#include <boost/asio/spawn.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "mtconnect/sink/rest_sink/server.hpp"
+
+using namespace std;
+using namespace mtconnect;
+using namespace mtconnect::sink::rest_sink;
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace http = boost::beast::http;
+using tcp = boost::asio::ip::tcp;
+
+int main(int argc, char *argv[])
+{
+  using namespace mtconnect::configuration;
+
+  const int connections = argc > 1 ? atoi(argv[1]) : 8;
+  const int requests = argc > 2 ? atoi(argv[2]) : 1000;
+  if (connections <= 0 || requests <= 0)
+  {
+    cerr << "Usage: " << argv[0] << " [connections] [requests per connection]" << endl;
+    return 1;
+  }
+
+  asio::io_context context;
+  Server server(context, ConfigOptions {{Port, 0}, {ServerIp, "127.0.0.1"s}});
+
+  const string body(
+      "<MTConnectStreams><Streams><DeviceStream name=\"d1\"/></Streams></MTConnectStreams>");
+  auto handler = [&](SessionPtr session, RequestPtr request) -> bool {
+    session->writeResponse(make_unique<Response>(status::ok, body, "text/xml"));
+    return true;
+  };
+  server.addRouting({http::verb::get, "/current", handler});
+
+  server.start();
+  while (!server.isListening())
+    context.run_one();
+
+  int completed = 0, failed = 0;
+  vector<chrono::nanoseconds> latencies;
+  latencies.reserve(size_t(connections) * requests);
+
+  auto client = [&](asio::yield_context yield) {
+    beast::error_code ec;
+    beast::tcp_stream stream(context);
+    beast::flat_buffer buffer;
+
+    tcp::endpoint endpoint(asio::ip::address_v4::loopback(), server.getPort());
+    stream.async_connect(endpoint, yield[ec]);
+
+    http::request<http::empty_body> req {http::verb::get, "/current", 11};
+    req.set(http::field::host, "localhost");
+
+    for (int i = 0; !ec && i < requests; i++)
+    {
+      auto start = chrono::steady_clock::now();
+      http::async_write(stream, req, yield[ec]);
+      if (ec)
+        break;
+
+      http::response<http::string_body> res;
+      http::async_read(stream, buffer, res, yield[ec]);
+      if (ec)
+        break;
+      latencies.push_back(chrono::steady_clock::now() - start);
+
+      if (!res.keep_alive())
+        ec = http::error::end_of_stream;
+    }
+
+    if (ec)
+    {
+      cerr << "Connection failed: " << ec.message() << endl;
+      failed++;
+    }
+    completed++;
+    stream.socket().shutdown(tcp::socket::shutdown_both, ec);
+  };
+
+  auto begin = chrono::steady_clock::now();
+  for (int i = 0; i < connections; i++)
+    asio::spawn(context, client);
+
+  while (completed < connections && context.run_one() > 0)
+    ;
+  auto elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin);
+  server.stop();
+
+  if (latencies.empty())
+  {
+    cerr << "No requests completed" << endl;
+    return 1;
+  }
+
+  sort(latencies.begin(), latencies.end());
+  auto p50 = chrono::duration<double, micro>(latencies[latencies.size() / 2]);
+  auto p99 = chrono::duration<double, micro>(latencies[(latencies.size() * 99) / 100]);
+
+  cout << connections << " connections, " << latencies.size() << " requests in "
+       << elapsed.count() << "s: " << (latencies.size() / elapsed.count()) << " req/s, p50 "
+       << p50.count() << "us, p99 " << p99.count() << "us" << endl;
+
+  return failed > 0 ? 1 : 0;
+}
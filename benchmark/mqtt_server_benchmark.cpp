@@ -0,0 +1,169 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Load harness for the embedded MQTT server: N publishers send QoS 1 messages that M subscribers
+// receive through a wildcard subscription. Reports the delivered messages per second and the
+// publish to delivery latency percentiles.
+//
+// Usage: mqtt_server_benchmark [publishers] [subscribers] [messages per publisher]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "mtconnect/mqtt/mqtt_server_impl.hpp"
+
+using namespace std;
+using namespace std::chrono;
+using namespace mtconnect;
+using namespace mtconnect::configuration;
+
+namespace {
+  /// @brief run the context until the predicate is true or the time runs out
+  bool runUntil(boost::asio::io_context &ioc, steady_clock::duration timeout,
+                const function<bool()> &pred)
+  {
+    auto end = steady_clock::now() + timeout;
+    while (!pred() && steady_clock::now() < end)
+      ioc.run_for(10ms);
+    return pred();
+  }
+
+  int64_t now()
+  {
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+  }
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+  const int publishers = argc > 1 ? atoi(argv[1]) : 4;
+  const int subscribers = argc > 2 ? atoi(argv[2]) : 8;
+  const int messages = argc > 3 ? atoi(argv[3]) : 1000;
+  if (publishers <= 0 || subscribers <= 0 || messages <= 0)
+  {
+    cerr << "Usage: " << argv[0] << " [publishers] [subscribers] [messages per publisher]"
+         << endl;
+    return 1;
+  }
+  const size_t expected = size_t(publishers) * messages * subscribers;
+
+  boost::asio::io_context ioc;
+  auto server = make_shared<mqtt_server::MqttTcpServer>(
+      ioc, ConfigOptions {{ServerIp, "127.0.0.1"s}, {MqttPort, 0}, {MqttTls, false}});
+  if (!server->start())
+  {
+    cerr << "Cannot start the MQTT server" << endl;
+    return 1;
+  }
+  auto port = server->getPort();
+
+  using client_t = decltype(mqtt::make_async_client(ioc, "localhost", port));
+  vector<client_t> subs, pubs;
+  int subscribed = 0, connected = 0;
+  size_t received = 0;
+  vector<int64_t> latencies;
+  latencies.reserve(expected);
+
+  for (int i = 0; i < subscribers; i++)
+  {
+    auto client = mqtt::make_async_client(ioc, "localhost", port);
+    client->set_client_id("sub" + to_string(i));
+    client->set_clean_session(true);
+    std::weak_ptr<typename client_t::element_type> wp = client;
+    client->set_connack_handler([wp](bool, mqtt::connect_return_code rc) {
+      if (auto c = wp.lock(); c && rc == mqtt::connect_return_code::accepted)
+        c->async_subscribe(c->acquire_unique_packet_id(), "load/#", MQTT_NS::qos::at_least_once,
+                           [](MQTT_NS::error_code) {});
+      return true;
+    });
+    client->set_suback_handler([&subscribed](std::uint16_t, std::vector<mqtt::suback_return_code>) {
+      subscribed++;
+      return true;
+    });
+    client->set_publish_handler([&received, &latencies](mqtt::optional<std::uint16_t>,
+                                                        mqtt::publish_options, mqtt::buffer,
+                                                        mqtt::buffer contents) {
+      latencies.push_back(now() - stoll(string(contents)));
+      received++;
+      return true;
+    });
+    client->async_connect([](MQTT_NS::error_code) {});
+    subs.emplace_back(client);
+  }
+  if (!runUntil(ioc, 10s, [&]() { return subscribed == subscribers; }))
+  {
+    cerr << "Only " << subscribed << " of " << subscribers << " subscribers subscribed" << endl;
+    return 1;
+  }
+
+  for (int i = 0; i < publishers; i++)
+  {
+    auto client = mqtt::make_async_client(ioc, "localhost", port);
+    client->set_client_id("pub" + to_string(i));
+    client->set_clean_session(true);
+    client->set_connack_handler([&connected](bool, mqtt::connect_return_code rc) {
+      if (rc == mqtt::connect_return_code::accepted)
+        connected++;
+      return true;
+    });
+    client->async_connect([](MQTT_NS::error_code) {});
+    pubs.emplace_back(client);
+  }
+  if (!runUntil(ioc, 10s, [&]() { return connected == publishers; }))
+  {
+    cerr << "Only " << connected << " of " << publishers << " publishers connected" << endl;
+    return 1;
+  }
+
+  auto start = steady_clock::now();
+  for (int m = 0; m < messages; m++)
+  {
+    for (int p = 0; p < publishers; p++)
+      pubs[p]->async_publish("load/" + to_string(p) + "/" + to_string(m % 10), to_string(now()),
+                             MQTT_NS::qos::at_least_once, [](MQTT_NS::error_code) {});
+  }
+
+  runUntil(ioc, 60s, [&]() { return received >= expected; });
+  auto elapsed = duration_cast<microseconds>(steady_clock::now() - start).count();
+
+  for (auto &c : pubs)
+    c->async_disconnect();
+  for (auto &c : subs)
+    c->async_disconnect();
+  ioc.run_for(500ms);
+  server->stop();
+
+  if (latencies.empty())
+  {
+    cerr << "No messages delivered" << endl;
+    return 1;
+  }
+
+  sort(latencies.begin(), latencies.end());
+  cout << publishers << " publishers, " << subscribers << " subscribers, " << received << " of "
+       << expected << " messages delivered in " << elapsed / 1000.0 << "ms, "
+       << (received * 1000000.0 / elapsed) << " msgs/sec, latency p50 "
+       << latencies[latencies.size() / 2] << "us p99 " << latencies[latencies.size() * 99 / 100]
+       << "us" << endl;
+
+  return received == expected ? 0 : 1;
+}
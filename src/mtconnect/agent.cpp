@@ -51,6 +51,8 @@
 #include "mtconnect/entity/xml_parser.hpp"
 #include "mtconnect/logging.hpp"
 #include "mtconnect/observation/observation.hpp"
+#include "mtconnect/parser/device_model_cache.hpp"
+#include "mtconnect/printer/cbor_printer.hpp"
 #include "mtconnect/printer/json_printer.hpp"
 #include "mtconnect/printer/xml_printer.hpp"
 #include "mtconnect/sink/rest_sink/file_cache.hpp"
@@ -106,6 +108,7 @@ namespace mtconnect {
     // Create the Printers
     m_printers["xml"] = make_unique<printer::XmlPrinter>(m_pretty);
     m_printers["json"] = make_unique<printer::JsonPrinter>(jsonVersion, m_pretty);
+    m_printers["cbor"] = make_unique<printer::CborPrinter>(m_pretty);
 
     if (m_schemaVersion)
     {
@@ -125,7 +128,17 @@ namespace mtconnect {
     m_loopback =
         std::make_shared<source::LoopbackSource>("AgentSource", m_strand, context, m_options);
 
+    // Log the time taken by each phase of the startup
+    auto start = chrono::steady_clock::now();
+    auto phase = [&start](const char *name) {
+      auto now = chrono::steady_clock::now();
+      LOG(info) << "Startup: " << name << " took "
+                << chrono::duration_cast<chrono::milliseconds>(now - start).count() << "ms";
+      start = now;
+    };
+
     auto devices = loadXMLDeviceFile(m_deviceXmlPath);
+    phase("loading the device model");
     if (!m_schemaVersion)
     {
       m_schemaVersion.emplace(StrDefaultSchemaVersion());
@@ -143,12 +156,18 @@ namespace mtconnect {
 
     // For the DeviceAdded event for each device
     for (auto device : devices)
+    {
+      if (auto uuid = device->getUuid())
+        m_deviceFileHashes.insert_or_assign(*uuid, device->hash());
       addDevice(device);
+    }
+    phase("adding the devices");
 
     if (m_versionDeviceXml && m_createUniqueIds)
       versionDeviceXml();
 
     loadCachedProbe();
+    phase("caching the probe");
 
     m_initialized = true;
 
@@ -161,8 +180,13 @@ namespace mtconnect {
 
     if (!m_observationsInitialized)
     {
+      auto start = chrono::steady_clock::now();
       for (auto device : m_deviceIndex)
         initializeDataItems(device);
+      LOG(info) << "Startup: initializing the data items took "
+                << chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start)
+                       .count()
+                << "ms";
 
       if (m_agentDevice)
       {
@@ -311,11 +335,16 @@ namespace mtconnect {
       }
     }
 
-    // Add hash to asset
+    // An asset that is already stored with the same content is not changed, skip the hash, the
+    // sinks, and the asset changed event. The hash is added only when the asset is stored.
+    std::function<void(asset::Asset &)> addHash;
     if (m_intSchemaVersion >= SCHEMA_VERSION(2, 2))
-      asset->addHash();
-
-    m_assetStorage->addAsset(asset);
+      addHash = [](asset::Asset &a) { a.addHash(); };
+    if (!m_assetStorage->addChangedAsset(asset, addHash))
+    {
+      LOG(debug) << "Asset " << asset->getAssetId() << " is unchanged";
+      return;
+    }
 
     for (auto &sink : m_sinks)
       sink->publish(asset);
@@ -363,11 +392,30 @@ namespace mtconnect {
         return false;
       }
 
+      // Only devices whose definition changed in the file are received
       bool changed = false;
+      size_t unchanged = 0;
       for (auto device : devices)
       {
+        auto uuid = device->getUuid();
+        auto hash = device->hash();
+        if (uuid)
+        {
+          auto last = m_deviceFileHashes.find(*uuid);
+          if (last != m_deviceFileHashes.end() && last->second == hash &&
+              findDeviceByUUIDorName(*uuid))
+          {
+            unchanged++;
+            continue;
+          }
+        }
+
         changed = receiveDevice(device, false) || changed;
+        if (uuid)
+          m_deviceFileHashes.insert_or_assign(*uuid, hash);
       }
+      LOG(info) << "Reloaded devices file: " << (devices.size() - unchanged) << " changed, "
+                << unchanged << " unchanged";
       if (changed)
         loadCachedProbe();
 
@@ -397,32 +445,43 @@ namespace mtconnect {
       return;
     }
 
+    // Parse before pausing the workers so only the model swap stops ingestion
+    DevicePtr device;
+    try
+    {
+      auto printer = dynamic_cast<printer::XmlPrinter *>(m_printers["xml"].get());
+      device = m_xmlParser->parseDevice(deviceXml, printer);
+    }
+    catch (exception &e)
+    {
+      LOG(error) << "Error loading device: " + deviceXml;
+      LOG(error) << "Error detail: " << e.what();
+      cerr << e.what() << endl;
+      return;
+    }
+
+    if (!device)
+    {
+      LOG(error) << "Cannot parse device xml: " << deviceXml;
+      return;
+    }
+
     m_context.pause([=](config::AsyncContext &context) {
       try
       {
-        auto printer = dynamic_cast<printer::XmlPrinter *>(m_printers["xml"].get());
-        auto device = m_xmlParser->parseDevice(deviceXml, printer);
+        bool changed = receiveDevice(device, true);
+        if (changed)
+          loadCachedProbe();
 
-        if (device)
+        if (source)
         {
-          bool changed = receiveDevice(device, true);
-          if (changed)
-            loadCachedProbe();
-
-          if (source)
+          auto s = findSource(*source);
+          if (s)
           {
-            auto s = findSource(*source);
-            if (s)
-            {
-              const auto &name = device->getComponentName();
-              s->setOptions({{config::Device, *name}});
-            }
+            const auto &name = device->getComponentName();
+            s->setOptions({{config::Device, *name}});
           }
         }
-        else
-        {
-          LOG(error) << "Cannot parse device xml: " << deviceXml;
-        }
       }
       catch (runtime_error &e)
       {
@@ -512,12 +571,26 @@ namespace mtconnect {
 
         // Remove the old data items
         set<string> skip;
+        unordered_map<string, DataItemHandlePtr> handles;
         for (auto &di : oldDev->getDeviceDataItems())
         {
-          if (!di.expired())
+          if (auto odi = di.lock())
+          {
+            m_dataItemMap.erase(odi->getId());
+            skip.insert(odi->getId());
+            handles.emplace(odi->getId(), odi->getHandle());
+          }
+        }
+
+        // Observations reference data items by handle, re-pointing the handles moves the
+        // observations in the buffer and checkpoints to the new model.
+        for (auto &di : device->getDeviceDataItems())
+        {
+          if (auto ndi = di.lock())
           {
-            m_dataItemMap.erase(di.lock()->getId());
-            skip.insert(di.lock()->getId());
+            auto handle = handles.find(ndi->getId());
+            if (handle != handles.end())
+              ndi->setHandle(handle->second);
           }
         }
 
@@ -533,9 +606,6 @@ namespace mtconnect {
 
         initializeDataItems(device, skip);
 
-        LOG(info) << "Device " << *uuid << " updating circular buffer";
-        m_circularBuffer.updateDataItems(m_dataItemMap);
-
         if (m_intSchemaVersion > SCHEMA_VERSION(2, 2))
           device->addHash();
 
@@ -733,17 +803,49 @@ namespace mtconnect {
 
     try
     {
-      // Load the configuration for the Agent
-      auto devices = m_xmlParser->parseFile(
-          configXmlPath, dynamic_cast<printer::XmlPrinter *>(m_printers["xml"].get()));
+      auto xmlPrinter = dynamic_cast<printer::XmlPrinter *>(m_printers["xml"].get());
+      std::list<device_model::DevicePtr> devices;
+      std::optional<std::string> schemaVersion;
+
+      // Use the cached device model if the devices file has not changed
+      auto cacheFile = GetOption<string>(m_options, config::DeviceModelCache);
+      std::optional<parser::DeviceModelCache> cache;
+      std::optional<parser::DeviceModelCache::Model> model;
+      string hash;
+      if (cacheFile)
+      {
+        cache.emplace(*cacheFile);
+        hash = parser::DeviceModelCache::hashFile(configXmlPath);
+        if (!hash.empty())
+          model = cache->load(hash);
+      }
+
+      if (model)
+      {
+        LOG(info) << "Loaded the device model from the cache: " << *cacheFile;
+        for (auto &ns : model->m_namespaces)
+          xmlPrinter->addDevicesNamespace(ns.m_urn, ns.m_location, ns.m_prefix);
+        devices = model->m_devices;
+        schemaVersion = model->m_schemaVersion;
+      }
+      else
+      {
+        // Load the configuration for the Agent
+        devices = m_xmlParser->parseFile(configXmlPath, xmlPrinter);
+        schemaVersion = m_xmlParser->getSchemaVersion();
+
+        // Save before the agent modifies the devices
+        if (cache && !hash.empty() &&
+            cache->save(hash, {schemaVersion, m_xmlParser->getNamespaces(), devices}))
+          LOG(info) << "Saved the device model to the cache: " << *cacheFile;
+      }
 
-      if (!m_schemaVersion && m_xmlParser->getSchemaVersion() &&
-          !m_xmlParser->getSchemaVersion()->empty())
+      if (!m_schemaVersion && schemaVersion && !schemaVersion->empty())
       {
-        m_schemaVersion = m_xmlParser->getSchemaVersion();
+        m_schemaVersion = schemaVersion;
         m_intSchemaVersion = IntSchemaVersion(*m_schemaVersion);
       }
-      else if (!m_schemaVersion && !m_xmlParser->getSchemaVersion())
+      else if (!m_schemaVersion && !schemaVersion)
       {
         m_schemaVersion = StrDefaultSchemaVersion();
         m_intSchemaVersion = IntSchemaVersion(*m_schemaVersion);
@@ -1088,6 +1190,16 @@ namespace mtconnect {
     }
   }
 
+  void Agent::removeSource(source::SourcePtr source)
+  {
+    auto it = find(m_sources.begin(), m_sources.end(), source);
+    if (it != m_sources.end())
+    {
+      source->stop();
+      m_sources.erase(it);
+    }
+  }
+
   void Agent::addSink(sink::SinkPtr sink, bool start)
   {
     m_sinks.emplace_back(sink);
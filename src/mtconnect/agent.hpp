@@ -169,6 +169,13 @@ namespace mtconnect {
     /// @param[in] source: shared pointer to the source being added
     /// @param[in] start: starts the source if start is true, otherwise delayed start
     void addSource(source::SourcePtr source, bool start = false);
+    /// @brief Stops and removes a source from the agent
+    ///
+    /// The source's component in the Agent device is kept so the observations in the buffer
+    /// still refer to a data item.
+    ///
+    /// @param[in] source: shared pointer to the source being removed
+    void removeSource(source::SourcePtr source);
     /// @brief Adds a sink to the agent
     /// @param[in] sink shared pointer to the the sink being added
     /// @param[in] start: starts the source if start is true, otherwise delayed start
@@ -517,6 +524,8 @@ namespace mtconnect {
     // Xml Config
     std::optional<std::string> m_schemaVersion;
     std::string m_deviceXmlPath;
+    // Hash of each device as parsed from the devices file by uuid
+    std::unordered_map<std::string, std::string> m_deviceFileHashes;
     bool m_versionDeviceXml {false};
     bool m_createUniqueIds {false};
     int32_t m_intSchemaVersion = IntDefaultSchemaVersion();
@@ -59,7 +59,7 @@ namespace mtconnect {
 
       if (first)
       {
-        root->registerFactory(regex(".+"), ExtendedAsset::getFactory());
+        root->registerFactory(PatternMatcher(".+"), ExtendedAsset::getFactory());
         root->registerMatchers();
         first = false;
       }
@@ -153,7 +153,24 @@ namespace mtconnect {
       /// @return `true` if they have the same asset id
       bool operator==(const Asset &another) const { return getAssetId() == another.getAssetId(); }
 
+      /// @brief compares the content of two assets
+      ///
+      /// The `hash`, `timestamp`, and `removed` properties are not compared, they are not part of
+      /// the hash either. They are only skipped on the asset itself, so a different `timestamp`
+      /// in a nested entity, such as a measurement, is a change.
+      ///
+      /// @param another other asset
+      /// @return `true` if the assets would have the same hash
+      bool sameContent(const Asset &another) const { return equals(another, contentSkip()); }
+
     protected:
+      /// @brief the properties that are not part of the content of the asset
+      static const boost::unordered_set<std::string> &contentSkip()
+      {
+        static const boost::unordered_set<std::string> skip {"hash", "timestamp", "removed"};
+        return skip;
+      }
+
       /// @brief The virtual method that covers `hash(boost::uuids::detail::sha1&,
       /// boost::unordered_set<std::string> skip)`
       ///
@@ -162,8 +179,7 @@ namespace mtconnect {
       /// @param[in,out] sha1 The boost sha1 accumulator
       void hash(boost::uuids::detail::sha1 &sha1) const override
       {
-        static const boost::unordered_set<std::string> skip {"hash", "timestamp", "removed"};
-        entity::Entity::hash(sha1, skip);
+        entity::Entity::hash(sha1, contentSkip());
       }
 
     protected:
@@ -39,6 +39,7 @@
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include "asset.hpp"
 #include "asset_storage.hpp"
@@ -52,9 +53,16 @@ namespace mtconnect::asset {
   {
   public:
     /// @brief Structure to store asset for boost multi index container
+    ///
+    /// The timestamp and removed state are copied from the asset so the keys of the indexes only
+    /// change when the node is modified through the container.
     struct AssetNode
     {
-      AssetNode(AssetPtr &asset) : m_asset(asset), m_identity(asset->getAssetId()) {}
+      AssetNode(AssetPtr &asset, uint64_t sequence)
+        : m_asset(asset), m_identity(asset->getAssetId()), m_added(sequence)
+      {
+        changed(sequence);
+      }
       ~AssetNode() = default;
 
       using element_type = AssetPtr;
@@ -70,7 +78,16 @@ namespace mtconnect::asset {
         else
           return unknown;
       }
-      bool isRemoved() const { return m_asset->isRemoved(); }
+      bool isRemoved() const { return m_removed; }
+
+      /// @brief update the change sequence, timestamp and removed state from the asset
+      /// @param sequence the change sequence
+      void changed(uint64_t sequence)
+      {
+        m_sequence = sequence;
+        m_timestamp = m_asset->getTimestamp().value_or(Timestamp());
+        m_removed = m_asset->isRemoved();
+      }
 
       bool operator<(const AssetNode &o) const { return m_identity < o.m_identity; }
 
@@ -78,6 +95,10 @@ namespace mtconnect::asset {
 
       AssetPtr m_asset;
       std::string m_identity;
+      uint64_t m_added;     ///< change sequence when the asset was added or updated
+      uint64_t m_sequence;  ///< change sequence of the last change, including removal
+      Timestamp m_timestamp;
+      bool m_removed;
     };
 
   public:
@@ -99,6 +120,15 @@ namespace mtconnect::asset {
     /// @brief Index by type
     struct ByType
     {};
+    /// @brief Index by change sequence
+    struct ByChange
+    {};
+    /// @brief Index by timestamp
+    struct ByTimestamp
+    {};
+    /// @brief Index by removed state, most recently added or updated first
+    struct ByActive
+    {};
 
     /// @brief The Multi-Index Container type
     using AssetIndex = mic::multi_index_container<
@@ -108,7 +138,12 @@ namespace mtconnect::asset {
             mic::hashed_unique<mic::tag<ByAssetId>, mic::key<&AssetNode::m_identity>>,
             mic::ordered_non_unique<mic::tag<ByDeviceAndType>,
                                     mic::key<&AssetNode::getDeviceUuid, &AssetNode::getType>>,
-            mic::hashed_non_unique<mic::tag<ByType>, mic::key<&AssetNode::getType>>>>;
+            mic::hashed_non_unique<mic::tag<ByType>, mic::key<&AssetNode::getType>>,
+            mic::ordered_unique<mic::tag<ByChange>, mic::key<&AssetNode::m_sequence>>,
+            mic::ordered_non_unique<mic::tag<ByTimestamp>, mic::key<&AssetNode::m_timestamp>>,
+            mic::ordered_non_unique<
+                mic::tag<ByActive>, mic::key<&AssetNode::m_removed, &AssetNode::m_added>,
+                mic::composite_key_compare<std::less<bool>, std::greater<uint64_t>>>>>;
 
     /// @brief Create an asset buffer with a maximum size
     /// @param max the maximum size
@@ -138,13 +173,18 @@ namespace mtconnect::asset {
         throw entity::PropertyError("Asset does not have an asset id");
       }
 
-      auto added = m_index.emplace_front(asset);
+      auto sequence = ++m_changeSequence;
+      auto added = m_index.emplace_front(asset, sequence);
 
       // Is duplicate
       if (!added.second)
       {
         old = added.first->m_asset;
-        m_index.modify(added.first, [&asset](AssetNode &n) { n.m_asset = asset; });
+        m_index.modify(added.first, [&asset, sequence](AssetNode &n) {
+          n.m_asset = asset;
+          n.m_added = sequence;
+          n.changed(sequence);
+        });
         m_index.relocate(m_index.begin(), added.first);
         if (asset->isRemoved() && !old->isRemoved())
           adjustCount(asset, 1);
@@ -165,6 +205,27 @@ namespace mtconnect::asset {
       return old;
     }
 
+    bool addChangedAsset(AssetPtr asset,
+                         const std::function<void(Asset &)> &prepare = nullptr) override
+    {
+      std::lock_guard<std::recursive_mutex> lock(m_bufferLock);
+
+      const auto &idx = m_index.get<ByAssetId>();
+      if (auto it = idx.find(asset->getAssetId()); it != idx.end())
+      {
+        const auto &stored = it->m_asset;
+        if (stored != asset && stored->isRemoved() == asset->isRemoved() &&
+            stored->sameContent(*asset))
+          return false;
+      }
+
+      if (prepare)
+        prepare(*asset);
+      addAsset(asset);
+
+      return true;
+    }
+
     AssetPtr removeAsset(const std::string &id,
                          const std::optional<Timestamp> &time = std::nullopt) override
     {
@@ -181,6 +242,7 @@ namespace mtconnect::asset {
           asset->setProperty("removed", true);
           Timestamp ts = time ? *time : std::chrono::system_clock::now();
           asset->setProperty("timestamp", ts);
+          idx.modify(it, [this](AssetNode &n) { n.changed(++m_changeSequence); });
           adjustCount(asset, 1);
         }
       }
@@ -217,6 +279,10 @@ namespace mtconnect::asset {
       {
         range = m_index.get<ByType>().equal_range(*type);
       }
+      else if (active)
+      {
+        range = m_index.get<ByActive>().equal_range(std::make_tuple(false));
+      }
       else
       {
         auto &idx = m_index.get<ByFifo>();
@@ -234,6 +300,56 @@ namespace mtconnect::asset {
       return list.size();
     }
 
+    size_t getAssetChanges(AssetList &list, uint64_t &next, size_t max, uint64_t from = 0,
+                           const std::optional<std::string> device = std::nullopt,
+                           const std::optional<std::string> type = std::nullopt,
+                           const std::optional<Timestamp> since = std::nullopt) const override
+    {
+      std::lock_guard<std::recursive_mutex> lock(m_bufferLock);
+
+      auto matches = [&](const AssetNode &a) {
+        return a.m_sequence >= from && (!device || a.getDeviceUuid() == *device) &&
+            (!type || a.getType() == *type) && (!since || a.m_timestamp >= *since);
+      };
+
+      // Collect the candidates in change order, when a time is given only the assets with a
+      // later timestamp need to be considered.
+      std::vector<const AssetNode *> nodes;
+      if (since)
+      {
+        auto &idx = m_index.get<ByTimestamp>();
+        for (auto it = idx.lower_bound(*since); it != idx.end(); it++)
+        {
+          if (matches(*it))
+            nodes.push_back(&*it);
+        }
+        std::sort(nodes.begin(), nodes.end(),
+                  [](const auto *a, const auto *b) { return a->m_sequence < b->m_sequence; });
+      }
+      else
+      {
+        auto &idx = m_index.get<ByChange>();
+        for (auto it = idx.lower_bound(from); it != idx.end() && nodes.size() <= max; it++)
+        {
+          if (matches(*it))
+            nodes.push_back(&*it);
+        }
+      }
+
+      size_t count = std::min(nodes.size(), max);
+      for (size_t i = 0; i < count; i++)
+        list.push_back(nodes[i]->m_asset);
+      next = nodes.size() > count ? nodes[count]->m_sequence : m_changeSequence + 1;
+
+      return count;
+    }
+
+    uint64_t getNextChange() const override
+    {
+      std::lock_guard<std::recursive_mutex> lock(m_bufferLock);
+      return m_changeSequence + 1;
+    }
+
     virtual size_t getAssets(AssetList &list, const std::list<std::string> &ids) const override
     {
       for (auto id : ids)
@@ -402,6 +518,7 @@ namespace mtconnect::asset {
 
   protected:
     size_t m_removedAssets {0};
+    uint64_t m_changeSequence {0};
     AssetIndex m_index;
 
     RemoveCountByDeviceAndType m_deviceRemoveCount;
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
@@ -41,6 +42,10 @@ namespace mtconnect {
     /// is added. The oldest assets are removed first.
     ///
     /// Removal does not change the asset position and marks the asset as removed.
+    ///
+    /// Every add, update, or removal gives the asset the next change sequence. Clients can page
+    /// through the assets in the order they changed, or only get the changes since they last
+    /// asked, using the change sequence as a cursor.
     class AGENT_LIB_API AssetStorage
     {
     public:
@@ -73,6 +78,16 @@ namespace mtconnect {
       /// @param[in] asset an asset
       /// @return shared pointer to the old asset if changed
       virtual AssetPtr addAsset(AssetPtr asset) = 0;
+      /// @brief add an asset unless the stored asset with the same id has the same content
+      ///
+      /// The comparison and the add are done under the storage lock, so two threads receiving
+      /// the same asset cannot both add it.
+      ///
+      /// @param[in] asset an asset
+      /// @param[in] prepare optional, called under the lock before a changed asset is added
+      /// @return `true` if the asset was added, `false` if it was unchanged
+      virtual bool addChangedAsset(AssetPtr asset,
+                                   const std::function<void(Asset &)> &prepare = nullptr) = 0;
 
       /// @brief mark an asset as removed by assetId
       /// @param[in] id the assetId
@@ -114,6 +129,28 @@ namespace mtconnect {
       /// @param[in] ids assetIds to find
       /// @return the number of assets found
       virtual size_t getAssets(AssetList &list, const std::list<std::string> &ids) const = 0;
+      /// @brief get the assets changed at or after a change sequence in the order they changed
+      ///
+      /// An asset that changes again while a client is paging moves to the end, so it may be
+      /// returned twice but is never missed. Removed assets are always included with their
+      /// `removed` attribute set, so clients following the changes see the removals.
+      ///
+      /// @param[out] list returned list of assets
+      /// @param[out] next the change sequence to continue from
+      /// @param[in] max maximum number of assets to find
+      /// @param[in] from the first change sequence to include
+      /// @param[in] device optional device uuid to select
+      /// @param[in] type optional type to select
+      /// @param[in] since optional, only select assets with a timestamp at or after this time
+      /// @return the number of assets found
+      virtual size_t getAssetChanges(AssetList &list, uint64_t &next, size_t max,
+                                     uint64_t from = 0,
+                                     const std::optional<std::string> device = std::nullopt,
+                                     const std::optional<std::string> type = std::nullopt,
+                                     const std::optional<Timestamp> since = std::nullopt) const = 0;
+      /// @brief get the change sequence the next change will have
+      /// @return the next change sequence
+      virtual uint64_t getNextChange() const = 0;
       ///@}
 
       /// @name Count related methods
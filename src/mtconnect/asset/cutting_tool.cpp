@@ -57,10 +57,10 @@ namespace mtconnect {
         static auto measurements = make_shared<Factory>(Requirements(
             {Requirement("Measurement", ENTITY, measurement, 1, Requirement::Infinite)}));
         measurements->registerMatchers();
-        measurements->registerFactory(regex(".+"), measurement);
+        measurements->registerFactory(PatternMatcher(".+"), measurement);
 
         static auto ext = make_shared<Factory>();
-        ext->registerFactory(regex(".+"), ext);
+        ext->registerFactory(PatternMatcher(".+"), ext);
         ext->setAny(true);
 
         static auto item =
@@ -73,7 +73,7 @@ namespace mtconnect {
                                                {"ItemLife", ENTITY, toolLife, 0, 3},
                                                {"ProgramToolGroup", false},
                                                {"Measurements", ENTITY_LIST, measurements, false}});
-        item->registerFactory(regex(".+"), ext);
+        item->registerFactory(PatternMatcher(".+"), ext);
         item->setAny(true);
 
         measurements->registerMatchers();
@@ -92,7 +92,7 @@ namespace mtconnect {
              Requirement("ConnectionCodeMachineSide", false),
              Requirement("Measurements", ENTITY_LIST, measurements, false),
              Requirement("CuttingItems", ENTITY_LIST, items, false)}));
-        lifeCycle->registerFactory(regex(".+"), ext);
+        lifeCycle->registerFactory(PatternMatcher(".+"), ext);
         lifeCycle->setAny(true);
 
         measurements->registerMatchers();
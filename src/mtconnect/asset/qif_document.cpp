@@ -27,12 +27,12 @@ namespace mtconnect::asset {
     if (!factory)
     {
       static auto ext = make_shared<Factory>();
-      ext->registerFactory(regex(".+"), ext);
+      ext->registerFactory(PatternMatcher(".+"), ext);
       ext->setAny(true);
       ext->setList(true);
 
       static auto doc = make_shared<Factory>();
-      doc->registerFactory(regex(".+"), ext);
+      doc->registerFactory(PatternMatcher(".+"), ext);
       doc->setAny(true);
 
       factory = make_shared<Factory>(*Asset::getFactory());
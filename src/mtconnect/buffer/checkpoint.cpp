@@ -17,6 +17,8 @@
 
 #include "checkpoint.hpp"
 
+#include <algorithm>
+
 #include "mtconnect/device_model/data_item/data_item.hpp"
 
 using namespace std;
@@ -36,84 +38,102 @@ namespace mtconnect {
       copy(checkpoint, filter);
     }
 
-    void Checkpoint::clear() { m_observations.clear(); }
+    void Checkpoint::clear()
+    {
+      m_observations.clear();
+      m_conditions.clear();
+    }
 
     Checkpoint::~Checkpoint() { clear(); }
 
-    void Checkpoint::addObservation(ConditionPtr event, ObservationPtr &&old)
+    void Checkpoint::addObservation(const std::string &id, ConditionPtr event, ObservationPtr &old)
     {
-      bool assign = true;
-      Condition *cond = dynamic_cast<Condition *>(old.get());
-      if (cond->getLevel() != Condition::NORMAL && event->getLevel() != Condition::NORMAL &&
-          cond->getLevel() != Condition::UNAVAILABLE && event->getLevel() != Condition::UNAVAILABLE)
+      auto set = m_conditions.find(id);
+      const auto &code = event->getCode();
+
+      if (event->isActive())
       {
-        // Check to see if the native code matches an existing
-        // active condition
-        if (auto e = cond->find(event->getCode()))
-        {
-          // Replace in chain.
-          old = cond->deepCopyAndRemove(e);
-          // Check if this is the only event...
-          // ??
-        }
+        // Activate the code, replacing the active condition with the same code. Copy the set
+        // first if another checkpoint shares it.
+        if (set == m_conditions.end())
+          set = m_conditions.emplace(id, make_shared<ConditionSet>()).first;
+        else if (set->second.use_count() > 1)
+          set->second = make_shared<ConditionSet>(*set->second);
 
-        // Chain the event
-        if (old)
-          event->appendTo(dynamic_pointer_cast<Condition>(old));
+        set->second->activate(event);
+        old = event;
+        return;
       }
-      else if (event->getLevel() == Condition::NORMAL)
+
+      // Check for a normal that clears an active condition by code
+      if (event->getLevel() == Condition::NORMAL && !code.empty())
       {
-        // Check for a normal that clears an active condition by code
-        if (!event->getCode().empty())
+        auto *head = dynamic_cast<Condition *>(old.get());
+        bool found = set != m_conditions.end() ? bool(set->second->find(code))
+                                               : head && head->getCode() == code;
+        if (found)
         {
-          if (auto e = cond->find(event->getCode()))
+          // Clear the one condition by removing it from the set
+          if (set != m_conditions.end())
           {
-            // Clear the one condition by removing it from the chain
-            old = cond->deepCopyAndRemove(e);
+            if (set->second.use_count() > 1)
+              set->second = make_shared<ConditionSet>(*set->second);
+            set->second->clear(code);
 
-            if (!old)
+            if (!set->second->empty())
             {
-              // Need to put a normal event in with no code since this
-              // is the last one.
-              auto n = make_shared<Condition>(*event);
-              n->normal();
-              old = n;
+              old = set->second->getNewest();
+              return;
             }
-            assign = false;
-          }
-          else
-          {
-            // Not sure if we should register code specific normals if
-            // previous normal was not found
-            // (*ptr) = event;
+            m_conditions.erase(set);
           }
+
+          // Need to put a normal event in with no code since this
+          // is the last one.
+          auto n = make_shared<Condition>(*event);
+          n->normal();
+          old = n;
+          return;
         }
+
+        // Not sure if we should register code specific normals if
+        // previous normal was not found
       }
-      if (assign)
-        old = event;
+
+      // Normal or unavailable clears all the active conditions
+      if (set != m_conditions.end())
+        m_conditions.erase(set);
+      old = event;
     }
 
     void Checkpoint::addObservation(const DataSetEventPtr event, ObservationPtr &&old)
     {
       if (!event->isUnavailable() && !old->isUnavailable() && !event->hasProperty("resetTriggered"))
       {
-        // Get the existing data set from the existing event
-        DataSet set = old->getValue<DataSet>();
+        // Get the existing data set from the existing event. If the checkpoint holds the only
+        // reference to the event, take the set instead of copying it. Merged events are only
+        // shared after the checkpoint is copied, so most updates only touch the changed entries.
+        DataSet set;
+        auto &value = old->getValue();
+        if (old.use_count() == 1 && holds_alternative<DataSet>(value))
+          set = std::move(get<DataSet>(value));
+        else
+          set = old->getValue<DataSet>();
 
         // For data sets merge the maps together
         for (auto &e : event->getValue<DataSet>())
         {
-          const auto &oe = set.find(e);
+          auto oe = set.find(e);
           if (oe != set.end())
-            set.erase(oe);
+            oe = set.erase(oe);
           if (!e.m_removed)
-            set.insert(e);
+            set.emplace_hint(oe, e);
         }
 
         // Replace the old event with a copy of the new event with sets merged
         // Do not modify the new event.
         auto n = make_shared<DataSetEvent>(*event);
-        n->setDataSet(set);
+        n->setDataSet(std::move(set));
         old = n;
       }
       else
@@ -131,18 +151,18 @@ namespace mtconnect {
 
       auto item = obs->getDataItem();
       const auto &id = item->getId();
-      auto old = m_observations.find(id);
 
+      if (item->isCondition())
+      {
+        // Conditions also track the set of active conditions
+        addObservation(id, dynamic_pointer_cast<Condition>(obs), m_observations[id]);
+        return;
+      }
+
+      auto old = m_observations.find(id);
       if (old != m_observations.end())
       {
-        if (item->isCondition())
-        {
-          auto cond = dynamic_pointer_cast<Condition>(obs);
-          // Chain event only if it is normal or unavailable and the
-          // previous condition was not normal or unavailable
-          addObservation(cond, std::forward<ObservationPtr>(old->second));
-        }
-        else if (item->isDataSet())
+        if (item->isDataSet())
         {
           auto set = dynamic_pointer_cast<DataSetEvent>(obs);
           addObservation(set, std::forward<ObservationPtr>(old->second));
@@ -172,6 +192,13 @@ namespace mtconnect {
         if (!m_filter || m_filter->count(event.first) > 0)
           m_observations[event.first] = dynamic_pointer_cast<Observation>(event.second->getptr());
       }
+
+      // The condition sets are shared until one of the checkpoints changes them
+      for (const auto &set : checkpoint.m_conditions)
+      {
+        if (!m_filter || m_filter->count(set.first) > 0)
+          m_conditions.emplace(set);
+      }
     }
 
     void Checkpoint::getObservations(ObservationList &list, const FilterSetOpt &filterSet) const
@@ -185,9 +212,16 @@ namespace mtconnect {
           {
             if (e->getDataItem()->isCondition())
             {
-              for (auto ev = dynamic_pointer_cast<Condition>(e); ev; ev = ev->getPrev())
+              // Newest condition first
+              auto set = m_conditions.find(obs.first);
+              if (set != m_conditions.end())
               {
-                list.push_back(ev);
+                auto conditions = set->second->getConditions();
+                list.insert(list.end(), conditions.rbegin(), conditions.rend());
+              }
+              else
+              {
+                list.push_back(e);
               }
             }
             else
@@ -223,6 +257,14 @@ namespace mtconnect {
           ++it;
         }
       }
+
+      for (auto it = m_conditions.begin(); it != m_conditions.end();)
+      {
+        if (!m_filter->count(it->first))
+          it = m_conditions.erase(it);
+        else
+          ++it;
+      }
     }
 
     ObservationPtr Checkpoint::dataSetDifference(const ObservationPtr &obs,
@@ -237,30 +279,27 @@ namespace mtconnect {
       {
         auto oldEvent = dynamic_pointer_cast<const DataSetEvent>(old);
         auto &oldSet = oldEvent->getDataSet();
-        DataSet eventSet = setEvent->getDataSet();
-        bool changed = false;
+        auto &eventSet = setEvent->getDataSet();
+        auto same = [&oldSet](const DataSetEntry &e) {
+          const auto v = oldSet.find(e);
+          return v != oldSet.end() && v->same(e);
+        };
 
-        for (auto it = eventSet.begin(); it != eventSet.end();)
+        // If some entries are unchanged, create an event with only the entries that changed.
+        // The event set is only copied when there is something to remove.
+        if (std::any_of(eventSet.begin(), eventSet.end(), same))
         {
-          const auto v = oldSet.find(*it);
-          if (v == oldSet.end() || !v->same(*it))
+          DataSet changed;
+          for (const auto &e : eventSet)
           {
-            it++;
+            if (!same(e))
+              changed.emplace_hint(changed.end(), e);
           }
-          else
-          {
-            changed = true;
-            eventSet.erase(it++);
-          }
-        }
 
-        // If the data set has changed and been edited by delting it against the current latest.
-        if (changed)
-        {
-          if (!eventSet.empty())
+          if (!changed.empty())
           {
             auto copy = dynamic_pointer_cast<DataSetEvent>(setEvent->copy());
-            copy->setDataSet(eventSet);
+            copy->setDataSet(std::move(changed));
             return copy;
           }
           else
@@ -43,6 +43,10 @@ namespace mtconnect::buffer {
     ~Checkpoint();
 
     /// @brief Add an observation to the checkpoint
+    ///
+    /// Not thread safe, readers must be serialized with updates, the circular buffer uses its
+    /// lock. A merged data set is moved out of the previous event only when the checkpoint holds
+    /// the only reference, events held by readers are copied.
     /// @param[in] observation an observation
     void addObservation(observation::ObservationPtr observation);
 
@@ -94,7 +98,12 @@ namespace mtconnect::buffer {
 
           // If there is already an active condition with this code,
           // then check if nothing has changed between activations.
-          if (const auto &e = oldCond->find(cond->getCode()))
+          ConditionPtr e;
+          if (auto set = m_conditions.find(id); set != m_conditions.end())
+            e = set->second->find(cond->getCode());
+          else if (oldCond->getCode() == cond->getCode())
+            e = std::dynamic_pointer_cast<Condition>(oldObs);
+          if (e)
           {
             if (cond->getLevel() != e->getLevel())
               return obs;
@@ -166,20 +175,6 @@ namespace mtconnect::buffer {
       return m_observations;
     }
 
-    /// @brief updates the data item reference of an observation in a checkpoint
-    ///
-    /// Used when the device model is modified and data items may have been removed or
-    /// changed. The new data item shared pointer will replace the old.
-    ///
-    /// @param[in] diMap the map of data ids to data item pointers
-    void updateDataItems(std::unordered_map<std::string, WeakDataItemPtr> &diMap)
-    {
-      for (auto &o : m_observations)
-      {
-        o.second->updateDataItem(diMap);
-      }
-    }
-
     /// @brief Get a list of observations from the checkpoint
     /// @param[in,out] list the list to add the observations to
     /// @param[in] filter an optional filter for the observations
@@ -197,13 +192,26 @@ namespace mtconnect::buffer {
       return nullptr;
     }
 
+    /// @brief Get the active conditions for a condition data item id
+    /// @param[in] id the data item id
+    /// @return the active conditions, `nullptr` if no condition is active
+    observation::ConstConditionSetPtr getConditions(const std::string &id) const
+    {
+      auto pos = m_conditions.find(id);
+      if (pos != m_conditions.end())
+        return pos->second;
+      return nullptr;
+    }
+
   protected:
-    void addObservation(observation::ConditionPtr event, observation::ObservationPtr &&old);
+    void addObservation(const std::string &id, observation::ConditionPtr event,
+                        observation::ObservationPtr &old);
     void addObservation(const observation::DataSetEventPtr event,
                         observation::ObservationPtr &&old);
 
   protected:
     std::unordered_map<std::string, observation::ObservationPtr> m_observations;
+    std::unordered_map<std::string, observation::ConditionSetPtr> m_conditions;
     FilterSetOpt m_filter;
   };
 }  // namespace mtconnect::buffer
@@ -78,24 +78,6 @@ namespace mtconnect::buffer {
     /// @return first sequence
     SequenceNumber_t getFirstSequence() const { return m_firstSequence; }
 
-    /// @brief update the data item references when device model changes
-    /// @param diMap the map of data item ids to new data item entities
-    void updateDataItems(std::unordered_map<std::string, WeakDataItemPtr> &diMap)
-    {
-      for (auto &o : m_slidingBuffer)
-      {
-        o->updateDataItem(diMap);
-      }
-
-      m_first.updateDataItems(diMap);
-      m_latest.updateDataItems(diMap);
-
-      for (auto &cp : m_checkpoints)
-      {
-        cp->updateDataItems(diMap);
-      }
-    }
-
     /// @brief Set the sequence number
     ///
     /// recomputes the first sequence if the sequence is larger than the circular buffer size.
@@ -155,6 +137,9 @@ namespace mtconnect::buffer {
     ///@{
 
     /// @brief Get the checkpoint at the end of the circular buffer
+    ///
+    /// The checkpoint is updated by `addToBuffer`, hold the buffer lock while reading it.
+    /// Observations copied out of it can be used after the lock is released.
     /// @return reference to the checkpoint
     const Checkpoint &getLatest() const { return m_latest; }
     /// @brief Get the checkpoint at the beginning of the circular buffer
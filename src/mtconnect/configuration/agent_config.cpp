@@ -55,6 +55,7 @@
 #include "mtconnect/agent.hpp"
 #include "mtconnect/configuration/config_options.hpp"
 #include "mtconnect/device_model/device.hpp"
+#include "mtconnect/pipeline/pipeline_profiler.hpp"
 #include "mtconnect/printer/xml_printer.hpp"
 #include "mtconnect/sink/mqtt_sink/mqtt_service.hpp"
 #include "mtconnect/sink/rest_sink/rest_service.hpp"
@@ -102,7 +103,9 @@ namespace mtconnect::configuration {
   boost::log::trivial::logger_type *gAgentLogger = nullptr;
 
   AgentConfiguration::AgentConfiguration()
-    : m_context {make_unique<AsyncContext>()}, m_monitorTimer(m_context->get())
+    : m_context {make_unique<AsyncContext>()},
+      m_monitorStrand(m_context->get()),
+      m_monitorTimer(m_context->get())
   {
     NAMED_SCOPE("AgentConfiguration::AgentConfiguration");
     using namespace source;
@@ -230,7 +233,9 @@ namespace mtconnect::configuration {
 
     if (ec)
     {
-      LOG(info) << "Monitor files stopped";
+      // A file event replaces the pending wait, so only log when the watcher was stopped
+      if (!m_fileWatcher || !m_fileWatcher->isWatching())
+        LOG(info) << "Monitor files stopped";
       return;
     }
 
@@ -300,79 +305,194 @@ namespace mtconnect::configuration {
     if (delta < m_monitorDelay)
     {
       LOG(warning) << "... Waiting " << int32_t((m_monitorDelay - delta).count()) << " seconds";
-      scheduleMonitorTimer();
+
+      // When watching, check again as soon as the youngest file is old enough
+      if (m_fileWatcher && m_fileWatcher->isWatching())
+        scheduleMonitorTimer(ceil<milliseconds>(m_monitorDelay - delta));
+      else
+        scheduleMonitorTimer();
+      return;
+    }
+
+    // If only adapter blocks changed, the adapters are rebuilt without restarting the agent. A
+    // failed device reload sets the config time to min to force a restart.
+    optional<ptree> adapters;
+    if (cfgTime != *m_configTime && *m_configTime != filesystem::file_time_type::min())
+      adapters = changedAdapters();
+
+    if (cfgTime != *m_configTime && !adapters)
+    {
+      LOG(warning) << "Monitor thread has detected change in configuration files.";
+      LOG(warning) << ".... Restarting agent: " << m_configFile;
+
+      m_beforeStopHooks.exec(*this);
+      m_agent->stop();
+
+      // The pending watch would keep the context from stopping
+      if (m_fileWatcher)
+        m_fileWatcher->stop();
+
+      m_context->pause(
+          [this](AsyncContext &context) {
+            m_agent.reset();
+            m_configTime.reset();
+            m_deviceTime.reset();
+
+            // Re initialize
+            boost::program_options::variables_map options;
+            boost::program_options::variable_value value(
+                boost::optional<string>(m_configFile.string()), false);
+            options.insert(make_pair("config-file"s, value));
+            initialize(options);
+            m_beforeStartHooks.exec(*this);
+            m_agent->start();
+
+            if (m_monitorFiles)
+            {
+              watchFiles();
+              scheduleMonitorTimer();
+            }
+          },
+          true);
     }
     else
     {
-      if (cfgTime != *m_configTime)
-      {
-        LOG(warning) << "Monitor thread has detected change in configuration files.";
-        LOG(warning) << ".... Restarting agent: " << m_configFile;
-
-        m_beforeStopHooks.exec(*this);
-        m_agent->stop();
-
-        m_context->pause(
-            [this](AsyncContext &context) {
-              m_agent.reset();
-              m_configTime.reset();
-              m_deviceTime.reset();
-
-              // Re initialize
-              boost::program_options::variables_map options;
-              boost::program_options::variable_value value(
-                  boost::optional<string>(m_configFile.string()), false);
-              options.insert(make_pair("config-file"s, value));
-              initialize(options);
-              m_beforeStartHooks.exec(*this);
-              m_agent->start();
-
-              if (m_monitorFiles)
-              {
-                scheduleMonitorTimer();
-              }
-            },
-            true);
-      }
-      else if (devTime != *m_deviceTime)
+      bool devices = devTime != *m_deviceTime;
+      if (devices)
       {
         // Handle device changed by delivering the device file to the agent
         LOG(warning) << "Monitor thread has detected change in devices files.";
         LOG(warning) << "... Reloading Devices File: " << m_devicesFile;
+      }
+      if (adapters)
+      {
+        LOG(warning) << "Monitor thread has detected change in the adapter configuration.";
+        LOG(warning) << "... Reloading changed adapters from: " << m_configFile;
+      }
 
-        m_context->pause([this](AsyncContext &context) {
-          if (!m_agent->reloadDevices(m_devicesFile))
-          {
-            m_configTime.emplace(m_configTime->min());
-            using namespace chrono;
-            using namespace chrono_literals;
+      m_context->pause([this, devices, adapters](AsyncContext &context) {
+        if (devices && !m_agent->reloadDevices(m_devicesFile))
+        {
+          m_configTime.emplace(m_configTime->min());
+          scheduleMonitorTimer(100ms);
+          return;
+        }
 
-            using boost::placeholders::_1;
+        if (adapters)
+          reloadAdapters(*adapters);
 
-            m_monitorTimer.expires_from_now(100ms);
-            m_monitorTimer.async_wait(boost::bind(&AgentConfiguration::monitorFiles, this, _1));
-          }
-          else
-          {
-            m_deviceTime.reset();
-            scheduleMonitorTimer();
-          }
-        });
+        m_deviceTime.reset();
+        m_configTime.reset();
+        scheduleMonitorTimer();
+      });
+    }
+  }
+
+  std::optional<pt::ptree> AgentConfiguration::changedAdapters()
+  {
+    NAMED_SCOPE("AgentConfiguration::changedAdapters");
+
+    try
+    {
+      ifstream file(m_configFile.c_str());
+      std::stringstream buffer;
+      buffer << file.rdbuf();
+      auto config = Parser::parse(buffer.str());
+
+      if (!config.get_child_optional("Adapters") || !m_config.get_child_optional("Adapters"))
+        return nullopt;
+
+      auto next = config, current = m_config;
+      next.erase("Adapters");
+      current.erase("Adapters");
+      if (next != current)
+        return nullopt;
+
+      return config;
+    }
+    catch (std::exception &e)
+    {
+      LOG(warning) << "Cannot parse configuration file " << m_configFile << ": " << e.what();
+    }
+
+    return nullopt;
+  }
+
+  void AgentConfiguration::reloadAdapters(const ptree &config)
+  {
+    NAMED_SCOPE("AgentConfiguration::reloadAdapters");
+
+    auto blocks = [](const ptree &tree) {
+      map<string, ptree> blocks;
+      for (auto &block : tree.get_child("Adapters"))
+        blocks.emplace(block.first, block.second);
+      return blocks;
+    };
+    auto current = blocks(m_config);
+    auto next = blocks(config);
+
+    for (auto &[name, block] : current)
+    {
+      auto n = next.find(name);
+      if (n == next.end() || n->second != block)
+      {
+        auto source = m_adapterSources.find(name);
+        if (source != m_adapterSources.end())
+        {
+          LOG(info) << "Removing adapter: " << name;
+          m_agent->removeSource(source->second);
+#ifdef WITH_RUBY
+          if (m_ruby)
+            m_ruby->removeSource(source->second);
+#endif
+          m_adapterSources.erase(source);
+        }
       }
     }
 
-    return;
+    for (auto &[name, block] : next)
+    {
+      auto c = current.find(name);
+      if (c == current.end() || c->second != block)
+      {
+        auto source = loadAdapter(config, m_options, name, block);
+        if (source)
+        {
+          applyRules(source);
+#ifdef WITH_RUBY
+          if (m_ruby)
+            m_ruby->addSource(source);
+#endif
+          m_agent->addSource(source, true);
+        }
+      }
+    }
+
+    m_config = config;
   }
 
-  void AgentConfiguration::scheduleMonitorTimer()
+  void AgentConfiguration::scheduleMonitorTimer() { scheduleMonitorTimer(m_monitorInterval); }
+
+  void AgentConfiguration::scheduleMonitorTimer(std::chrono::milliseconds delay)
+  {
+    using boost::placeholders::_1;
+
+    m_monitorTimer.expires_from_now(delay);
+    m_monitorTimer.async_wait(asio::bind_executor(
+        m_monitorStrand, boost::bind(&AgentConfiguration::monitorFiles, this, _1)));
+  }
+
+  void AgentConfiguration::watchFiles()
   {
-    using namespace chrono;
     using namespace chrono_literals;
 
-    using boost::placeholders::_1;
+    if (!m_fileWatcher)
+      m_fileWatcher = make_unique<FileWatcher>(m_monitorStrand);
 
-    m_monitorTimer.expires_from_now(m_monitorInterval);
-    m_monitorTimer.async_wait(boost::bind(&AgentConfiguration::monitorFiles, this, _1));
+    // Check the files shortly after a change so a burst of events is handled once
+    if (m_fileWatcher->watch({m_configFile, m_devicesFile},
+                             [this](const fs::path &path) { scheduleMonitorTimer(100ms); }))
+      LOG(info) << "Watching " << m_configFile << " and " << m_devicesFile << " for changes";
   }
 
   void AgentConfiguration::start()
@@ -387,6 +507,8 @@ namespace mtconnect::configuration {
         m_deviceTime.reset();
       });
 
+      watchFiles();
+
       boost::system::error_code ec;
       AgentConfiguration::monitorFiles(ec);
     }
@@ -401,6 +523,8 @@ namespace mtconnect::configuration {
   {
     LOG(info) << "Agent stopping";
     m_beforeStopHooks.exec(*this);
+    if (m_fileWatcher)
+      m_fileWatcher->stop();
     m_monitorTimer.cancel();
     m_restart = false;
     if (m_agent)
@@ -660,16 +784,20 @@ namespace mtconnect::configuration {
                 {configuration::MonitorConfigFiles, false},
                 {configuration::MonitorInterval, 10s},
                 {configuration::VersionDeviceXml, false},
+                {configuration::DeviceModelCache, ""s},
                 {configuration::EnableSourceDeviceModels, false},
                 {configuration::MinimumConfigReloadAge, 15s},
                 {configuration::Pretty, false},
                 {configuration::PidFile, "agent.pid"s},
+                {configuration::PipelineProfiling, false},
                 {configuration::Port, 5000},
                 {configuration::MaxCachedFileSize, "20k"s},
+                {configuration::MaxAssetBodySize, "64M"s},
                 {configuration::MinCompressFileSize, "100k"s},
                 {configuration::ServiceName, "MTConnect Agent"s},
                 {configuration::SchemaVersion, ""s},
                 {configuration::LogStreams, false},
+                {configuration::DisconnectSlowClients, false},
                 {configuration::ShdrVersion, 1},
                 {configuration::WorkerThreads, 1},
                 {configuration::TlsCertificateChain, ""s},
@@ -738,6 +866,8 @@ namespace mtconnect::configuration {
     // Make the PipelineContext
     m_pipelineContext = std::make_shared<pipeline::PipelineContext>();
     m_pipelineContext->m_contract = m_agent->makePipelineContract();
+    if (IsOptionSet(options, configuration::PipelineProfiling))
+      m_pipelineContext->m_profiler = make_shared<pipeline::PipelineProfiler>();
 
     loadSinks(config, options);
 
@@ -751,8 +881,15 @@ namespace mtconnect::configuration {
         device->setPreserveUuid(get<bool>(options[configuration::PreserveUUID]));
     }
 
+    m_config = config;
+    m_options = options;
+    m_adapterSources.clear();
     loadAdapters(config, options);
 
+    loadRules(config);
+    for (auto &source : m_agent->getSources())
+      applyRules(source);
+
 #ifdef WITH_PYTHON
     configurePython(config, options);
 #endif
@@ -791,104 +928,116 @@ namespace mtconnect::configuration {
     }
   }
 
-  void AgentConfiguration::loadAdapters(const pt::ptree &config, const ConfigOptions &options)
+  source::SourcePtr AgentConfiguration::loadAdapter(const pt::ptree &config,
+                                                    const ConfigOptions &options,
+                                                    const std::string &blockName,
+                                                    const pt::ptree &block)
   {
     using namespace source::adapter;
     using namespace pipeline;
 
-    NAMED_SCOPE("AgentConfiguration::loadAdapters");
+    ConfigOptions adapterOptions = options;
 
-    DevicePtr device;
-    auto adapters = config.get_child_optional("Adapters");
-    if (adapters)
+    GetOptions(block, adapterOptions, options);
+    AddOptions(block, adapterOptions,
+               {{configuration::Url, string()}, {configuration::Device, string()}});
+
+    auto qname = entity::QName(blockName);
+    auto [factory, name] = qname.getPair();
+
+    auto deviceName = GetOption<string>(adapterOptions, configuration::Device).value_or(name);
+    auto device = m_agent->getDeviceByName(deviceName);
+
+    if (!device)
     {
-      for (const auto &block : *adapters)
+      LOG(warning) << "Cannot locate device name '" << deviceName << "', trying default";
+      device = getDefaultDevice();
+      if (device)
       {
-        ConfigOptions adapterOptions = options;
+        deviceName = *device->getComponentName();
+        adapterOptions[configuration::Device] = deviceName;
+        LOG(info) << "Assigning default device " << deviceName << " to adapter";
+      }
+    }
+    else
+    {
+      adapterOptions[configuration::Device] = *device->getUuid();
+    }
+    if (!device)
+    {
+      LOG(warning) << "Cannot locate device name '" << deviceName << "', assuming dynamic";
+    }
 
-        GetOptions(block.second, adapterOptions, options);
-        AddOptions(block.second, adapterOptions,
-                   {{configuration::Url, string()}, {configuration::Device, string()}});
+    auto additional = block.get_optional<string>(configuration::AdditionalDevices);
+    if (additional)
+    {
+      StringList deviceList;
+      istringstream devices(*additional);
+      string name;
+      while (getline(devices, name, ','))
+      {
+        auto index = name.find_first_not_of(" \r\t");
+        if (index != string::npos && index > 0)
+          name.erase(0, index);
+        index = name.find_last_not_of(" \r\t");
+        if (index != string::npos)
+          name.erase(index + 1);
+
+        deviceList.push_back(name);
+      }
 
-        auto qname = entity::QName(block.first);
-        auto [factory, name] = qname.getPair();
+      adapterOptions[configuration::AdditionalDevices] = deviceList;
+    }
 
-        auto deviceName = GetOption<string>(adapterOptions, configuration::Device).value_or(name);
-        device = m_agent->getDeviceByName(deviceName);
+    // Get protocol, hosts, and topics from URL
+    if (HasOption(adapterOptions, configuration::Url))
+    {
+      parseUrl(adapterOptions);
+    }
 
-        if (!device)
-        {
-          LOG(warning) << "Cannot locate device name '" << deviceName << "', trying default";
-          device = getDefaultDevice();
-          if (device)
-          {
-            deviceName = *device->getComponentName();
-            adapterOptions[configuration::Device] = deviceName;
-            LOG(info) << "Assigning default device " << deviceName << " to adapter";
-          }
-        }
-        else
-        {
-          adapterOptions[configuration::Device] = *device->getUuid();
-        }
-        if (!device)
-        {
-          LOG(warning) << "Cannot locate device name '" << deviceName << "', assuming dynamic";
-        }
+    // Override if protocol if not specified
+    AddDefaultedOptions(block, adapterOptions, {{configuration::Protocol, "shdr"s}});
+    auto protocol = *GetOption<string>(adapterOptions, configuration::Protocol);
 
-        auto additional = block.second.get_optional<string>(configuration::AdditionalDevices);
-        if (additional)
-        {
-          StringList deviceList;
-          istringstream devices(*additional);
-          string name;
-          while (getline(devices, name, ','))
-          {
-            auto index = name.find_first_not_of(" \r\t");
-            if (index != string::npos && index > 0)
-              name.erase(0, index);
-            index = name.find_last_not_of(" \r\t");
-            if (index != string::npos)
-              name.erase(index + 1);
-
-            deviceList.push_back(name);
-          }
-
-          adapterOptions[configuration::AdditionalDevices] = deviceList;
-        }
+    if (factory.empty())
+      factory = protocol;
 
-        // Get protocol, hosts, and topics from URL
-        if (HasOption(adapterOptions, configuration::Url))
-        {
-          parseUrl(adapterOptions);
-        }
+    if (!m_sourceFactory.hasFactory(factory) && !loadPlugin(factory, block))
+      return nullptr;
 
-        // Override if protocol if not specified
-        AddDefaultedOptions(block.second, adapterOptions, {{configuration::Protocol, "shdr"s}});
-        auto protocol = *GetOption<string>(adapterOptions, configuration::Protocol);
+    auto blockOptions = block;
+    if (!blockOptions.get_child_optional("logger_config"))
+    {
+      auto logger = config.get_child_optional("logger_config");
+      if (logger)
+        blockOptions.add_child("logger_config", *logger);
+    }
 
-        if (factory.empty())
-          factory = protocol;
+    auto source = m_sourceFactory.make(factory, name, getAsyncContext(), m_pipelineContext,
+                                       adapterOptions, blockOptions);
 
-        if (!m_sourceFactory.hasFactory(factory) && !loadPlugin(factory, block.second))
-          continue;
+    if (source)
+    {
+      m_adapterSources.insert_or_assign(blockName, source);
+      LOG(info) << protocol << ": Adding adapter for " << deviceName << ": " << blockName;
+    }
 
-        auto blockOptions = block.second;
-        if (!blockOptions.get_child_optional("logger_config"))
-        {
-          auto logger = config.get_child_optional("logger_config");
-          if (logger)
-            blockOptions.add_child("logger_config", *logger);
-        }
+    return source;
+  }
 
-        auto source = m_sourceFactory.make(factory, name, getAsyncContext(), m_pipelineContext,
-                                           adapterOptions, blockOptions);
+  void AgentConfiguration::loadAdapters(const pt::ptree &config, const ConfigOptions &options)
+  {
+    NAMED_SCOPE("AgentConfiguration::loadAdapters");
 
+    DevicePtr device;
+    auto adapters = config.get_child_optional("Adapters");
+    if (adapters)
+    {
+      for (const auto &block : *adapters)
+      {
+        auto source = loadAdapter(config, options, block.first, block.second);
         if (source)
-        {
           m_agent->addSource(source, false);
-          LOG(info) << protocol << ": Adding adapter for " << deviceName << ": " << block.first;
-        }
       }
     }
     else if ((device = getDefaultDevice()))
@@ -913,6 +1062,74 @@ namespace mtconnect::configuration {
     }
   }
 
+  void AgentConfiguration::loadRules(const ptree &config)
+  {
+    NAMED_SCOPE("AgentConfiguration::loadRules");
+
+    m_rules.clear();
+    auto rules = config.get_child_optional("Rules");
+    if (!rules)
+      return;
+
+    for (const auto &block : *rules)
+    {
+      auto &tree = block.second;
+      auto rule = make_shared<pipeline::Rule>();
+      rule->m_name = block.first;
+
+      try
+      {
+        if (auto v = tree.get_optional<string>("DataItem"))
+          rule->m_dataItem = *v;
+        if (auto v = tree.get_optional<string>("Type"))
+          rule->m_type = *v;
+        if (auto v = tree.get_optional<string>("When"))
+          rule->m_when = pipeline::RuleExpression::compile(*v);
+        if (auto v = tree.get_optional<string>("Value"))
+          rule->m_value = pipeline::RuleExpression::compile(*v);
+        if (auto v = tree.get_optional<string>("Rename"))
+          rule->m_rename = *v;
+        rule->m_drop = tree.get_optional<bool>("Drop").value_or(false);
+        if (auto map = tree.get_child_optional("Map"))
+        {
+          for (const auto &entry : *map)
+            rule->m_map.emplace(entry.first, entry.second.data());
+        }
+      }
+      catch (std::invalid_argument &e)
+      {
+        LOG(error) << "Ignoring rule " << block.first << ": " << e.what();
+        continue;
+      }
+      catch (pt::ptree_error &e)
+      {
+        LOG(error) << "Ignoring rule " << block.first << ": " << e.what();
+        continue;
+      }
+
+      m_rules.emplace_back(rule);
+    }
+
+    LOG(info) << "Loaded " << m_rules.size() << " rules";
+  }
+
+  void AgentConfiguration::applyRules(source::SourcePtr source)
+  {
+    if (m_rules.empty())
+      return;
+
+    auto pipe = source->getPipeline();
+    if (pipe == nullptr)
+      return;
+
+    // Apply the rules before duplicates are filtered so the filter sees the new values
+    auto rules = make_shared<pipeline::RuleTransform>(m_pipelineContext, m_rules);
+    if (!pipe->spliceBefore("DuplicateFilter", rules) &&
+        !pipe->spliceBefore("DeliverObservation", rules))
+      LOG(warning) << "Cannot apply rules to " << source->getName()
+                   << ", it does not deliver observations";
+  }
+
 #ifdef WITH_PYTHON
   void AgentConfiguration::configurePython(const ptree &tree, ConfigOptions &options)
   {
@@ -933,7 +1150,8 @@ namespace mtconnect::configuration {
                  {{"Module", string()},
                   {"Initialization", string()},
                   {"module", string()},
-                  {"initialization", string()}});
+                  {"initialization", string()},
+                  {"PerPipeline", false}});
     }
     m_ruby = make_unique<ruby::Embedded>(m_agent.get(), rubyOptions);
   }
@@ -28,9 +28,11 @@
 #include <thread>
 
 #include "async_context.hpp"
+#include "file_watcher.hpp"
 #include "hook_manager.hpp"
 #include "mtconnect/agent.hpp"
 #include "mtconnect/config.hpp"
+#include "mtconnect/pipeline/rule_transform.hpp"
 #include "mtconnect/sink/rest_sink/file_cache.hpp"
 #include "mtconnect/sink/sink.hpp"
 #include "mtconnect/source/adapter/adapter.hpp"
@@ -183,7 +185,13 @@ namespace mtconnect {
     protected:
       DevicePtr getDefaultDevice();
       void loadAdapters(const ptree &tree, const ConfigOptions &options);
+      source::SourcePtr loadAdapter(const ptree &tree, const ConfigOptions &options,
+                                    const std::string &blockName, const ptree &block);
+      std::optional<ptree> changedAdapters();
+      void reloadAdapters(const ptree &tree);
       void loadSinks(const ptree &sinks, ConfigOptions &options);
+      void loadRules(const ptree &tree);
+      void applyRules(source::SourcePtr source);
 
 #ifdef WITH_PYTHON
       void configurePython(const ptree &tree, ConfigOptions &options);
@@ -199,6 +207,8 @@ namespace mtconnect {
 
       void monitorFiles(boost::system::error_code ec);
       void scheduleMonitorTimer();
+      void scheduleMonitorTimer(std::chrono::milliseconds delay);
+      void watchFiles();
 
     protected:
       using text_sink = boost::log::sinks::synchronous_sink<boost::log::sinks::text_file_backend>;
@@ -209,6 +219,7 @@ namespace mtconnect {
       std::unique_ptr<Agent> m_agent;
 
       pipeline::PipelineContextPtr m_pipelineContext;
+      pipeline::RuleList m_rules;
       std::unique_ptr<source::adapter::Handler> m_adapterHandler;
       boost::shared_ptr<text_sink> m_sink;
       std::string m_version;
@@ -216,8 +227,15 @@ namespace mtconnect {
       std::filesystem::path m_exePath;
       std::filesystem::path m_working;
 
+      // Configuration used to create the adapters
+      ptree m_config;
+      ConfigOptions m_options;
+      std::map<std::string, source::SourcePtr> m_adapterSources;
+
       // File monitoring
+      boost::asio::io_context::strand m_monitorStrand;
       boost::asio::steady_timer m_monitorTimer;
+      std::unique_ptr<FileWatcher> m_fileWatcher;
       bool m_monitorFiles = false;
       std::chrono::seconds m_monitorInterval;
       std::chrono::seconds m_monitorDelay;
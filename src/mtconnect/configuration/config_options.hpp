@@ -46,9 +46,12 @@ namespace mtconnect {
     DECLARE_CONFIGURATION(BufferSize);
     DECLARE_CONFIGURATION(CheckpointFrequency);
     DECLARE_CONFIGURATION(Devices);
+    DECLARE_CONFIGURATION(DeviceModelCache);
+    DECLARE_CONFIGURATION(DisconnectSlowClients);
     DECLARE_CONFIGURATION(HttpHeaders);
     DECLARE_CONFIGURATION(JsonVersion);
     DECLARE_CONFIGURATION(LogStreams);
+    DECLARE_CONFIGURATION(MaxAssetBodySize);
     DECLARE_CONFIGURATION(MaxAssets);
     DECLARE_CONFIGURATION(MaxCachedFileSize);
     DECLARE_CONFIGURATION(MinCompressFileSize);
@@ -56,6 +59,7 @@ namespace mtconnect {
     DECLARE_CONFIGURATION(MonitorConfigFiles);
     DECLARE_CONFIGURATION(MonitorInterval);
     DECLARE_CONFIGURATION(PidFile);
+    DECLARE_CONFIGURATION(PipelineProfiling);
     DECLARE_CONFIGURATION(Port);
     DECLARE_CONFIGURATION(Pretty);
     DECLARE_CONFIGURATION(SchemaVersion);
@@ -79,6 +83,8 @@ namespace mtconnect {
     DECLARE_CONFIGURATION(DeviceTopic);
     DECLARE_CONFIGURATION(AssetTopic);
     DECLARE_CONFIGURATION(ObservationTopic);
+    DECLARE_CONFIGURATION(SampleTopic);
+    DECLARE_CONFIGURATION(CurrentTopic);
     DECLARE_CONFIGURATION(MqttCaCert);
     DECLARE_CONFIGURATION(MqttCert);
     DECLARE_CONFIGURATION(MqttPrivateKey);
@@ -89,6 +95,12 @@ namespace mtconnect {
     DECLARE_CONFIGURATION(MqttConnectInterval);
     DECLARE_CONFIGURATION(MqttUserName);
     DECLARE_CONFIGURATION(MqttPassword);
+    DECLARE_CONFIGURATION(MqttFlushInterval);
+    DECLARE_CONFIGURATION(MqttDeviceBatch);
+    DECLARE_CONFIGURATION(MqttMaxInFlight);
+    DECLARE_CONFIGURATION(MqttSampleInterval);
+    DECLARE_CONFIGURATION(MqttSampleCount);
+    DECLARE_CONFIGURATION(MqttCurrentInterval);
     ///@}
 
     /// @name Adapter Configuration
@@ -0,0 +1,134 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "file_watcher.hpp"
+
+#include <boost/asio/bind_executor.hpp>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "mtconnect/logging.hpp"
+
+using namespace std;
+namespace fs = std::filesystem;
+namespace asio = boost::asio;
+
+namespace mtconnect::configuration {
+#ifdef __linux__
+  bool FileWatcher::watch(const list<fs::path> &files, Handler handler)
+  {
+    NAMED_SCOPE("FileWatcher::watch");
+
+    stop();
+
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+    {
+      LOG(warning) << "Cannot initialize inotify, files will be polled";
+      return false;
+    }
+
+    m_descriptor = make_unique<asio::posix::stream_descriptor>(m_strand.context(), fd);
+    m_handler = handler;
+    for (auto &file : files)
+    {
+      auto path = fs::absolute(file).lexically_normal();
+      auto directory = path.parent_path();
+      int wd = inotify_add_watch(fd, directory.c_str(),
+                                 IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ATTRIB);
+      if (wd < 0)
+      {
+        LOG(warning) << "Cannot watch directory " << directory << ", files will be polled";
+        stop();
+        return false;
+      }
+
+      m_directories.emplace(wd, directory);
+      m_files.emplace(path);
+      LOG(debug) << "Watching " << path;
+    }
+
+    read();
+    return true;
+  }
+
+  void FileWatcher::read()
+  {
+    m_descriptor->async_read_some(
+        asio::buffer(m_buffer),
+        asio::bind_executor(m_strand, [this](boost::system::error_code ec, size_t len) {
+          if (ec)
+          {
+            if (ec != asio::error::operation_aborted)
+              LOG(warning) << "File watcher stopped: " << ec.message();
+            return;
+          }
+
+          // Coalesce the events so each file is only reported once per read
+          set<fs::path> changed;
+          for (size_t pos = 0; pos + sizeof(inotify_event) <= len;)
+          {
+            auto event = reinterpret_cast<const inotify_event *>(m_buffer.data() + pos);
+            auto directory = m_directories.find(event->wd);
+            if (directory != m_directories.end() && event->len > 0)
+            {
+              auto path = directory->second / event->name;
+              if (m_files.count(path) > 0)
+                changed.emplace(path);
+            }
+            pos += sizeof(inotify_event) + event->len;
+          }
+
+          for (auto &path : changed)
+          {
+            LOG(debug) << "File changed: " << path;
+            m_handler(path);
+          }
+
+          if (m_descriptor)
+            read();
+        }));
+  }
+
+  void FileWatcher::stop()
+  {
+    if (m_descriptor)
+    {
+      boost::system::error_code ec;
+      m_descriptor->close(ec);
+      m_descriptor.reset();
+    }
+    m_directories.clear();
+    m_files.clear();
+  }
+
+  bool FileWatcher::isWatching() const { return bool(m_descriptor); }
+#else
+  bool FileWatcher::watch(const list<fs::path> &files, Handler handler)
+  {
+    LOG(debug) << "File notifications are not supported on this platform, files will be polled";
+    return false;
+  }
+
+  void FileWatcher::stop() {}
+
+  bool FileWatcher::isWatching() const { return false; }
+#endif
+}  // namespace mtconnect::configuration
@@ -0,0 +1,76 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <boost/asio/io_context_strand.hpp>
+
+#include <array>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+
+#include "mtconnect/config.hpp"
+
+#ifdef __linux__
+#include <boost/asio/posix/stream_descriptor.hpp>
+#endif
+
+namespace mtconnect::configuration {
+  /// @brief Watches files for changes using operating system notifications
+  ///
+  /// The directories containing the files are watched so a file replaced with a rename, as most
+  /// editors do, is also detected. Only supported on Linux with `inotify`. On other platforms
+  /// `watch()` returns `false` and the caller must poll.
+  class AGENT_LIB_API FileWatcher
+  {
+  public:
+    /// @brief Called with the path of a file that changed
+    using Handler = std::function<void(const std::filesystem::path &)>;
+
+    /// @brief Create a watcher
+    /// @param[in] strand the strand the handler is called on
+    FileWatcher(boost::asio::io_context::strand &strand) : m_strand(strand) {}
+    ~FileWatcher() { stop(); }
+
+    /// @brief start watching files
+    /// @param[in] files the files to watch
+    /// @param[in] handler called when one of the files changes
+    /// @return `true` if the files are being watched
+    bool watch(const std::list<std::filesystem::path> &files, Handler handler);
+    /// @brief stop watching
+    void stop();
+    /// @brief check if the watcher is active
+    bool isWatching() const;
+
+  protected:
+    boost::asio::io_context::strand &m_strand;
+    Handler m_handler;
+    std::set<std::filesystem::path> m_files;
+
+#ifdef __linux__
+    void read();
+
+    std::unique_ptr<boost::asio::posix::stream_descriptor> m_descriptor;
+    std::map<int, std::filesystem::path> m_directories;
+    alignas(8) std::array<char, 4096> m_buffer;
+#endif
+  };
+}  // namespace mtconnect::configuration
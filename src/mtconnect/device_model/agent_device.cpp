@@ -69,6 +69,16 @@ namespace mtconnect {
           GetOption<bool>(adapter->getOptions(), config::SuppressIPAddress).value_or(false);
       auto id = adapter->getIdentity();
 
+      // An adapter that is reconfigured keeps its component and data items
+      if (auto adapters = m_adapters->getChildren())
+      {
+        for (auto &c : *adapters)
+        {
+          if (c->get<string>("id") == id)
+            return;
+        }
+      }
+
       stringstream name;
       name << adapter->getHost() << ':' << adapter->getPort();
 
@@ -53,6 +53,9 @@ namespace mtconnect {
       }
 
       /// @brief Add an adapter and create a component to track it
+      ///
+      /// Does nothing if there is already a component for the adapter's identity.
+      ///
       /// @param adapter the adapter
       void addAdapter(const source::adapter::AdapterPtr adapter);
 
@@ -123,7 +123,7 @@ namespace mtconnect {
             {"Description", "Configuration", "DataItems", "Compositions", "References"});
         auto component = make_shared<Factory>(
             Requirements {{"Component", ENTITY, factory, 1, Requirement::Infinite}});
-        component->registerFactory(regex(".+"), factory);
+        component->registerFactory(PatternMatcher(".+"), factory);
         component->registerMatchers();
         factory->addRequirements(Requirements {{"Components", ENTITY_LIST, component, false}});
       }
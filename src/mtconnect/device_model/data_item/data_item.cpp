@@ -74,6 +74,7 @@ namespace mtconnect {
             {"ResetTrigger", false}});
         factory->setFunction([](const std::string &name, Properties &props) -> EntityPtr {
           auto ptr = make_shared<DataItem>(name, props);
+          ptr->m_handle = make_shared<DataItemHandle>(ptr);
           return dynamic_pointer_cast<Entity>(ptr);
         });
 
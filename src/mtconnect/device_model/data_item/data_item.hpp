@@ -44,6 +44,9 @@ namespace mtconnect {
 
     /// @brief DataItem related entities
     namespace data_item {
+      class DataItemHandle;
+      using DataItemHandlePtr = std::shared_ptr<DataItemHandle>;
+
       /// @brief Data Item entity
       class AGENT_LIB_API DataItem : public entity::Entity, public observation::ChangeSignaler
       {
@@ -219,6 +222,20 @@ namespace mtconnect {
         /// @param[in] topic the topic
         void setTopic(const std::string &topic) { m_topic = topic; }
 
+        /// @brief get the stable handle observations use to reference this data item
+        ///
+        /// The handle is created by the factory with the data item and is only replaced by
+        /// `setHandle()` when the device model is updated.
+        ///
+        /// @return the handle
+        const DataItemHandlePtr &getHandle() const { return m_handle; }
+        /// @brief take over the handle of the data item this data item replaces
+        ///
+        /// The handle is re-pointed to this data item so existing observations resolve to it.
+        ///
+        /// @param[in] handle the handle of the previous version of the data item
+        void setHandle(const DataItemHandlePtr &handle);
+
         bool operator<(const DataItem &another) const;
         bool operator==(const DataItem &another) const { return m_id == another.m_id; }
 
@@ -313,9 +330,50 @@ namespace mtconnect {
 
         // Conversions
         std::unique_ptr<UnitConversion> m_converter;
+
+        // Shared with observations and later versions of this data item
+        DataItemHandlePtr m_handle;
       };
 
       using DataItemPtr = std::shared_ptr<DataItem>;
+
+      /// @brief Stable reference to the current version of a data item
+      ///
+      /// Observations reference their data item through the handle. When the device model changes,
+      /// the handle is re-pointed to the new data item with the same id, so the observations in
+      /// the buffer and checkpoints resolve to the new model without being visited. The reference
+      /// is swapped atomically and never blocks readers.
+      class AGENT_LIB_API DataItemHandle
+      {
+      public:
+        /// @brief create a handle referencing a data item
+        /// @param[in] dataItem the data item
+        DataItemHandle(const DataItemPtr &dataItem)
+          : m_dataItem(std::make_shared<const std::weak_ptr<DataItem>>(dataItem))
+        {}
+
+        /// @brief resolve the current data item
+        /// @return the data item or `nullptr` if it has been removed
+        DataItemPtr get() const { return std::atomic_load(&m_dataItem)->lock(); }
+        /// @brief check if the data item has been removed
+        /// @return `true` if there is no current data item
+        bool expired() const { return std::atomic_load(&m_dataItem)->expired(); }
+        /// @brief point the handle to a new version of the data item
+        /// @param[in] dataItem the data item
+        void set(const DataItemPtr &dataItem)
+        {
+          std::atomic_store(&m_dataItem, std::make_shared<const std::weak_ptr<DataItem>>(dataItem));
+        }
+
+      protected:
+        std::shared_ptr<const std::weak_ptr<DataItem>> m_dataItem;
+      };
+
+      inline void DataItem::setHandle(const DataItemHandlePtr &handle)
+      {
+        m_handle = handle;
+        m_handle->set(std::dynamic_pointer_cast<DataItem>(getptr()));
+      }
     }  // namespace data_item
   }    // namespace device_model
   using DataItemPtr = std::shared_ptr<device_model::data_item::DataItem>;
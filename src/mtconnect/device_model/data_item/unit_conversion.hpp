@@ -48,18 +48,29 @@ namespace mtconnect::device_model::data_item {
     entity::Vector convert(const entity::Vector &value) const
     {
       entity::Vector res(value.size());
-      for (size_t i = 0; i < value.size(); i++)
-        res[i] = convert(value[i]);
+      convert(value.data(), res.data(), value.size());
 
       return res;
     }
 
     /// @brief convert a vector of values in place
     /// @param[in,out] value the vector of double
-    void convert(entity::Vector &value) const
+    void convert(entity::Vector &value) const { convert(value.data(), value.data(), value.size()); }
+
+    /// @brief convert an array of values
+    ///
+    /// The factor and offset are copied to locals so the compiler does not reload them for every
+    /// element and can vectorize the loop. `in` and `out` may be the same array.
+    ///
+    /// @param[in] in the values to convert
+    /// @param[out] out the converted values
+    /// @param[in] count the number of values
+    void convert(const double *in, double *out, size_t count) const
     {
-      for (size_t i = 0; i < value.size(); i++)
-        value[i] = convert(value[i]);
+      const double factor = m_factor;
+      const double offset = m_offset;
+      for (size_t i = 0; i < count; i++)
+        out[i] = (in[i] + offset) * factor;
     }
     /// @brief Convert a entity variant Value if it holds a double or a vector of doubles
     /// @param[in] value a Value variant
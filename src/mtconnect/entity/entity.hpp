@@ -357,6 +357,11 @@ namespace mtconnect {
       /// @param other the other entity
       /// @return `true` if they have equal name and properties
       bool operator==(const Entity &other) const;
+      /// @brief compare two entities for equality skipping some properties
+      /// @param other the other entity
+      /// @param skip properties that are not compared–not recursive
+      /// @return `true` if they have equal name and properties other than the skipped
+      bool equals(const Entity &other, const boost::unordered_set<std::string> &skip) const;
 
       /// @brief compare two entities for inequality
       /// @param other the other entity
@@ -454,6 +459,8 @@ namespace mtconnect {
         const auto &list = std::get<EntityList>(m_this);
         if (list.size() != other.size())
           return false;
+        if (list.empty())
+          return true;
 
         auto it = list.cbegin();
         if (!std::holds_alternative<std::monostate>((*it)->getIdentity()))
@@ -518,6 +525,30 @@ namespace mtconnect {
       return true;
     }
 
+    inline bool Entity::equals(const Entity &other,
+                               const boost::unordered_set<std::string> &skip) const
+    {
+      if (m_name != other.m_name)
+        return false;
+
+      auto it1 = m_properties.cbegin(), it2 = other.m_properties.cbegin();
+      while (true)
+      {
+        while (it1 != m_properties.cend() && skip.contains(it1->first))
+          it1++;
+        while (it2 != other.m_properties.cend() && skip.contains(it2->first))
+          it2++;
+
+        if (it1 == m_properties.cend() || it2 == other.m_properties.cend())
+          return it1 == m_properties.cend() && it2 == other.m_properties.cend();
+        if (it1->first != it2->first || it1->second != it2->second)
+          return false;
+
+        it1++;
+        it2++;
+      }
+    }
+
     /// @brief variant visitor to merge two entities
     struct ValueMergeVisitor
     {
@@ -291,13 +291,13 @@ namespace mtconnect::entity {
     std::string printEntity(const EntityPtr entity)
     {
       using namespace rapidjson;
-      StringBuffer output;
+      StringOutput output;
       RenderJson(output, m_pretty, [&](auto &writer) {
         JsonPrinter printer(writer, m_version, m_includeHidden);
         printer.printEntity(entity);
       });
 
-      return std::string(output.GetString(), output.GetLength());
+      return output.getContent();
     }
 
     /// @brief wrapper around the JsonPrinter print method that creates the correct printer
@@ -310,13 +310,13 @@ namespace mtconnect::entity {
     std::string print(const EntityPtr entity)
     {
       using namespace rapidjson;
-      StringBuffer output;
+      StringOutput output;
       RenderJson(output, m_pretty, [&](auto &writer) {
         JsonPrinter printer(writer, m_version, m_includeHidden);
         printer.print(entity);
       });
 
-      return std::string(output.GetString(), output.GetLength());
+      return output.getContent();
     }
 
   protected:
@@ -57,6 +57,137 @@ namespace mtconnect {
       m_factory = f;
     }
 
+    Vocabulary::Vocabulary(const ControlledVocab &words)
+    {
+      set<string_view> unique(words.begin(), words.end());
+      m_size = unique.size();
+
+      // Find a seed that gives every word its own slot, growing the table if the
+      // seeds run out. The table is at least twice the number of words.
+      size_t size = 1;
+      while (size < m_size * 2)
+        size <<= 1;
+
+      vector<bool> used;
+      for (;; size <<= 1)
+      {
+        m_mask = size - 1;
+        for (m_seed = 0; m_seed < 256; m_seed++)
+        {
+          used.assign(size, false);
+          bool perfect = true;
+          for (const auto &w : unique)
+          {
+            auto slot = hash(w, m_seed) & m_mask;
+            if (used[slot])
+            {
+              perfect = false;
+              break;
+            }
+            used[slot] = true;
+          }
+
+          if (perfect)
+          {
+            m_table.resize(size);
+            for (const auto &w : unique)
+              m_table[hash(w, m_seed) & m_mask].emplace(w);
+            return;
+          }
+        }
+      }
+    }
+
+    uint64_t Vocabulary::hash(std::string_view s, uint64_t seed)
+    {
+      // FNV-1a with the seed mixed into the offset and a final avalanche so the low bits
+      // used for the slot depend on every character
+      uint64_t h = 0xcbf29ce484222325ull ^ (seed * 0x9e3779b97f4a7c15ull);
+      for (auto c : s)
+      {
+        h ^= uint8_t(c);
+        h *= 0x100000001b3ull;
+      }
+      h ^= h >> 33;
+      h *= 0xff51afd7ed558ccdull;
+      h ^= h >> 33;
+      return h;
+    }
+
+    static bool isLiteral(std::string_view s)
+    {
+      return s.find_first_of("\\^$.|?*+()[]{}") == string_view::npos;
+    }
+
+    PatternMatcher::PatternMatcher(const std::string &pattern) : m_form(REGEX)
+    {
+      string_view p(pattern);
+      auto wild = [](string_view w) { return w == ".*" || w == ".+"; };
+
+      if (wild(p))
+      {
+        m_form = ANY;
+        m_minLength = p[1] == '+' ? 1 : 0;
+      }
+      else if (isLiteral(p))
+      {
+        m_form = LITERAL;
+        m_text = pattern;
+      }
+      else if (p.size() > 2 && wild(p.substr(p.size() - 2)) && isLiteral(p.substr(0, p.size() - 2)))
+      {
+        m_form = PREFIX;
+        m_text = p.substr(0, p.size() - 2);
+        m_minLength = m_text.size() + (p.back() == '+' ? 1 : 0);
+      }
+      else if (p.size() > 2 && wild(p.substr(0, 2)) && isLiteral(p.substr(2)))
+      {
+        m_form = SUFFIX;
+        m_text = p.substr(2);
+        m_minLength = m_text.size() + (p[1] == '+' ? 1 : 0);
+      }
+      else if (p.find('|') != string_view::npos)
+      {
+        ControlledVocab words;
+        boost::split(words, pattern, boost::is_any_of("|"));
+        if (all_of(words.begin(), words.end(), [](const string &w) { return isLiteral(w); }))
+        {
+          m_form = ALTERNATIVES;
+          m_alternatives = Vocabulary(words);
+        }
+      }
+
+      if (m_form == REGEX)
+        m_regex.emplace(pattern);
+    }
+
+    bool PatternMatcher::matches(const std::string &s) const
+    {
+      switch (m_form)
+      {
+        case ANY:
+          return s.size() >= m_minLength;
+
+        case LITERAL:
+          return s == m_text;
+
+        case PREFIX:
+          return s.size() >= m_minLength && s.compare(0, m_text.size(), m_text) == 0;
+
+        case SUFFIX:
+          return s.size() >= m_minLength &&
+                 s.compare(s.size() - m_text.size(), m_text.size(), m_text) == 0;
+
+        case ALTERNATIVES:
+          return m_alternatives.contains(s);
+
+        case REGEX:
+          return std::regex_match(s, *m_regex);
+      }
+
+      return false;
+    }
+
     bool Requirement::isMetBy(const Value &value) const
     {
       // Is this a multiple entry
@@ -111,12 +242,12 @@ namespace mtconnect {
         if (std::holds_alternative<std::string>(value))
         {
           auto &v = std::get<std::string>(value);
-          if (m_pattern && !std::regex_match(v, *m_pattern))
+          if (m_pattern && !m_pattern->matches(v))
           {
             throw PropertyError("Invalid value for '" + m_name + "': '" + v + "' is not allowed",
                                 m_name);
           }
-          else if (m_vocabulary && m_vocabulary->count(v) == 0)
+          else if (m_vocabulary && !m_vocabulary->contains(v))
           {
             throw PropertyError("Invalid value for '" + m_name + "': '" + v + "' is not allowed",
                                 m_name);
@@ -173,10 +304,8 @@ namespace mtconnect {
       }
       void operator()(const string &arg, double &r)
       {
-        char *ep = nullptr;
         const char *sp = arg.c_str();
-        r = strtod(sp, &ep);
-        if (ep == sp)
+        if (parseDouble(sp, sp + arg.size(), r) == sp)
           throw PropertyError("cannot convert string '" + arg + "' to double");
       }
       void operator()(const string &arg, Timestamp &ts)
@@ -199,18 +328,31 @@ namespace mtconnect {
         if (arg.empty())
           return;
 
-        char *np(nullptr);
         const char *cp = arg.c_str();
+        const char *end = cp + arg.size();
 
-        while (cp && *cp != '\0')
+        // Count the values first so large time series are only allocated once
+        size_t count = 0;
+        bool inValue = false;
+        for (auto p = cp; p != end; p++)
         {
-          if (isspace(*cp))
+          bool space = isspace((unsigned char)*p);
+          if (!space && !inValue)
+            count++;
+          inValue = !space;
+        }
+        r.reserve(r.size() + count);
+
+        while (cp != end)
+        {
+          if (isspace((unsigned char)*cp))
           {
             cp++;
           }
           else
           {
-            double v = strtod(cp, &np);
+            double v;
+            auto np = parseDouble(cp, end, v);
             if (cp == np)
             {
               throw PropertyError("cannot convert string '" + arg + "' to vector");
@@ -279,10 +421,14 @@ namespace mtconnect {
       {
         if (arg.size() > 0)
         {
-          stringstream s;
-          for (auto &v : arg)
-            s << formatted(v) << ' ';
-          v = string_view(s.str().c_str(), s.str().size() - 1);
+          v.clear();
+          v.reserve(arg.size() * 12);
+          for (auto &d : arg)
+          {
+            if (!v.empty())
+              v.push_back(' ');
+            formatTo(v, d);
+          }
         }
       }
       template <typename T>
@@ -32,6 +32,7 @@
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <typeindex>
 #include <unordered_set>
@@ -81,8 +82,6 @@ namespace mtconnect::entity {
   class Factory;
   using FactoryPtr = std::shared_ptr<Factory>;
   using ControlledVocab = std::list<std::string>;
-  using Pattern = std::optional<std::regex>;
-  using VocabSet = std::optional<std::unordered_set<std::string>>;
 
   /// @brief Convert a `Value` to a given type
   /// @param value The value to convert
@@ -180,6 +179,87 @@ namespace mtconnect::entity {
 
   using MatcherPtr = std::weak_ptr<Matcher>;
 
+  /// @brief A controlled vocabulary compiled into a perfect hash table
+  ///
+  /// Every word has its own slot in the table, checking a value hashes it once and compares it
+  /// with at most one word.
+  class AGENT_LIB_API Vocabulary
+  {
+  public:
+    Vocabulary() = default;
+    /// @brief compile a vocabulary
+    /// @param words the words in the vocabulary
+    explicit Vocabulary(const ControlledVocab &words);
+
+    /// @brief check if a value is in the vocabulary
+    /// @param s the value
+    /// @return `true` if it is one of the words
+    bool contains(std::string_view s) const
+    {
+      if (m_table.empty())
+        return false;
+      const auto &word = m_table[hash(s, m_seed) & m_mask];
+      return word && *word == s;
+    }
+    /// @brief get the number of words
+    size_t size() const { return m_size; }
+
+  protected:
+    static uint64_t hash(std::string_view s, uint64_t seed);
+
+  protected:
+    std::vector<std::optional<std::string>> m_table;
+    uint64_t m_seed {0};
+    uint64_t m_mask {0};
+    size_t m_size {0};
+  };
+
+  /// @brief A regular expression compiled for matching names and values
+  ///
+  /// The common forms, `.*`, `.+`, a literal, alternative literals like `A|B`, and a literal
+  /// with a `.*` or `.+` prefix or suffix, are matched without the regex engine. Other
+  /// expressions fall back to `std::regex`. Like `std::regex_match`, the whole text must match.
+  class AGENT_LIB_API PatternMatcher
+  {
+  public:
+    /// @brief compile a pattern
+    /// @param pattern the regular expression
+    explicit PatternMatcher(const std::string &pattern);
+    /// @brief use an already compiled regular expression
+    /// @param regex the regular expression
+    explicit PatternMatcher(const std::regex &regex) : m_form(REGEX), m_regex(regex) {}
+
+    /// @brief check if text matches the pattern
+    /// @param s the text
+    /// @return `true` if the whole text matches
+    bool matches(const std::string &s) const;
+    /// @brief check if text matches the pattern so the pattern can be used as a factory matcher
+    bool operator()(const std::string &s) const { return matches(s); }
+    /// @brief does this pattern need the regex engine
+    /// @return `true` if the pattern is not one of the simple forms
+    bool usesRegex() const { return m_form == REGEX; }
+
+  protected:
+    enum Form
+    {
+      ANY,
+      LITERAL,
+      PREFIX,
+      SUFFIX,
+      ALTERNATIVES,
+      REGEX
+    };
+
+    Form m_form;
+    std::string m_text;
+    size_t m_minLength {0};
+    Vocabulary m_alternatives;
+    std::optional<std::regex> m_regex;
+  };
+
+  using Pattern = std::optional<PatternMatcher>;
+  using VocabSet = std::optional<Vocabulary>;
+
   /// @brief A requirement for a an entity property
   class AGENT_LIB_API Requirement
   {
@@ -240,17 +320,28 @@ namespace mtconnect::entity {
     /// @param vocab the set of possible values
     /// @param required `true` if the property is required
     Requirement(const std::string &name, const ControlledVocab &vocab, bool required = true)
-      : m_name(name), m_upperMultiplicity(1), m_lowerMultiplicity(required ? 1 : 0), m_type(STRING)
-    {
-      m_vocabulary.emplace();
-      for (auto &s : vocab)
-        m_vocabulary->emplace(s);
-    }
+      : m_name(name),
+        m_upperMultiplicity(1),
+        m_lowerMultiplicity(required ? 1 : 0),
+        m_type(STRING),
+        m_vocabulary(std::in_place, vocab)
+    {}
     /// @brief propery requirement where the text must match a regex pattern
     /// @param name the property key
     /// @param pattern the regex
     /// @param required `true` if the property is required
     Requirement(const std::string &name, const std::regex &pattern, bool required = true)
+      : m_name(name),
+        m_upperMultiplicity(1),
+        m_lowerMultiplicity(required ? 1 : 0),
+        m_type(STRING),
+        m_pattern(std::in_place, pattern)
+    {}
+    /// @brief propery requirement where the text must match a compiled pattern
+    /// @param name the property key
+    /// @param pattern the pattern
+    /// @param required `true` if the property is required
+    Requirement(const std::string &name, const PatternMatcher &pattern, bool required = true)
       : m_name(name),
         m_upperMultiplicity(1),
         m_lowerMultiplicity(required ? 1 : 0),
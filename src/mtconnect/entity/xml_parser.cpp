@@ -18,6 +18,7 @@
 #include "mtconnect/entity/xml_parser.hpp"
 
 #include <libxml/parser.h>
+#include <libxml/parserInternals.h>
 #include <libxml/xpath.h>
 #include <libxml/xpathInternals.h>
 
@@ -68,8 +69,310 @@ namespace mtconnect::entity {
     }
   }
 
+  namespace {
+    /// @brief SAX handlers that stream the content of entities with a `RAW` property
+    ///
+    /// The default SAX2 handlers build the document, except the content of a raw entity is
+    /// serialized as it is parsed, the same as `xmlNodeDump` would write it. Its nodes are freed
+    /// as soon as libxml2 no longer needs them to detect ignorable whitespace, only the first and
+    /// last child of each open element are kept, so a large raw payload costs its size in bytes.
+    /// The content is attached to the entity's node as `_private` and taken by `parseRawNode`.
+    class RawContentHandler
+    {
+    public:
+      RawContentHandler(FactoryPtr factory, xmlParserCtxtPtr ctxt)
+        : m_root(factory), m_ctxt(ctxt), m_sax(*ctxt->sax)
+      {
+        ctxt->_private = this;
+        ctxt->sax->startElementNs = startElement;
+        ctxt->sax->endElementNs = endElement;
+        ctxt->sax->characters = characters;
+        ctxt->sax->cdataBlock = cdataBlock;
+        ctxt->sax->comment = comment;
+        ctxt->sax->processingInstruction = processingInstruction;
+        ctxt->sax->reference = reference;
+      }
+      ~RawContentHandler()
+      {
+        if (m_buffer != nullptr)
+          xmlBufferFree(m_buffer);
+      }
+
+    protected:
+      static RawContentHandler *self(void *ctx)
+      {
+        return static_cast<RawContentHandler *>(static_cast<xmlParserCtxtPtr>(ctx)->_private);
+      }
+
+      static void startElement(void *ctx, const xmlChar *localname, const xmlChar *prefix,
+                               const xmlChar *URI, int nb_namespaces, const xmlChar **namespaces,
+                               int nb_attributes, int nb_defaulted, const xmlChar **attributes)
+      {
+        auto h = self(ctx);
+        if (h->m_raw != nullptr)
+        {
+          h->closeTag();
+          h->m_last = nullptr;
+          h->m_sax.startElementNs(ctx, localname, prefix, URI, nb_namespaces, namespaces,
+                                  nb_attributes, nb_defaulted, attributes);
+          auto node = h->m_ctxt->node;
+          h->m_depth++;
+          if (node != nullptr && node->parent != nullptr)
+          {
+            // An element without children is written as <name .../>, leave the tag open
+            h->dump(node);
+            h->m_content.resize(h->m_content.size() - 2);
+            h->m_open = true;
+            h->prune(node->parent);
+          }
+        }
+        else
+        {
+          bool capture = true;
+          auto ef = h->factoryFor(localname, prefix, URI, capture);
+          h->m_sax.startElementNs(ctx, localname, prefix, URI, nb_namespaces, namespaces,
+                                  nb_attributes, nb_defaulted, attributes);
+          h->m_factories.push_back(ef);
+          if (ef && ef->hasRaw() && capture && h->m_ctxt->node != nullptr)
+          {
+            h->m_raw = h->m_ctxt->node;
+            h->m_depth = 0;
+          }
+        }
+      }
+
+      static void endElement(void *ctx, const xmlChar *localname, const xmlChar *prefix,
+                             const xmlChar *URI)
+      {
+        auto h = self(ctx);
+        if (h->m_raw != nullptr && h->m_depth > 0)
+        {
+          auto node = h->m_ctxt->node;
+          h->m_last = nullptr;
+          if (h->m_open)
+          {
+            h->m_content.append("/>");
+            h->m_open = false;
+          }
+          else
+          {
+            h->m_content.append("</");
+            if (prefix != nullptr)
+              h->m_content.append((const char *)prefix).append(":");
+            h->m_content.append((const char *)localname).append(">");
+          }
+          h->m_sax.endElementNs(ctx, localname, prefix, URI);
+          h->m_depth--;
+          if (node != nullptr)
+            freeChildren(node);
+        }
+        else
+        {
+          h->m_sax.endElementNs(ctx, localname, prefix, URI);
+          h->m_factories.pop_back();
+          if (h->m_raw != nullptr)
+          {
+            auto &content = h->m_captured.emplace_back(std::move(h->m_content));
+            h->m_raw->_private = &content;
+            freeChildren(h->m_raw);
+            h->m_raw = nullptr;
+            h->m_last = nullptr;
+            h->m_content.clear();
+          }
+        }
+      }
+
+      static void characters(void *ctx, const xmlChar *ch, int len)
+      {
+        auto h = self(ctx);
+        h->m_sax.characters(ctx, ch, len);
+        if (h->m_raw != nullptr)
+        {
+          h->closeTag();
+          h->m_last = nullptr;
+          h->escape(ch, len);
+          h->prune(h->m_ctxt->node);
+        }
+      }
+
+      static void cdataBlock(void *ctx, const xmlChar *value, int len)
+      {
+        auto h = self(ctx);
+        h->closeTag();
+        h->m_sax.cdataBlock(ctx, value, len);
+        h->dumpLast();
+      }
+
+      static void comment(void *ctx, const xmlChar *value)
+      {
+        auto h = self(ctx);
+        h->closeTag();
+        h->m_sax.comment(ctx, value);
+        h->dumpLast();
+      }
+
+      static void processingInstruction(void *ctx, const xmlChar *target, const xmlChar *data)
+      {
+        auto h = self(ctx);
+        h->closeTag();
+        h->m_sax.processingInstruction(ctx, target, data);
+        h->dumpLast();
+      }
+
+      static void reference(void *ctx, const xmlChar *name)
+      {
+        auto h = self(ctx);
+        h->closeTag();
+        h->m_sax.reference(ctx, name);
+        h->dumpLast();
+      }
+
+      /// @brief find the factory the same way as `parseXmlNode`
+      /// @param[out] capture `false` if the element may be parsed as a simple property
+      FactoryPtr factoryFor(const xmlChar *localname, const xmlChar *prefix, const xmlChar *URI,
+                            bool &capture)
+      {
+        entity::QName qname((const char *)localname);
+        if (prefix != nullptr &&
+            (URI == nullptr ||
+             strncmp((const char *)URI, "urn:mtconnect.org:MTConnectDevices", 34u)))
+        {
+          qname.setNs((const char *)prefix);
+        }
+
+        if (m_factories.empty())
+          return m_root->factoryFor(qname);
+
+        auto parent = m_factories.back();
+        if (!parent || parent->hasRaw() || parent->isSimpleProperty(qname))
+          return nullptr;
+
+        // Elements of an any entity that only contain text are simple properties and need the
+        // text node in the document.
+        if (parent->isAny() && !parent->isProperty(qname))
+          capture = false;
+
+        return parent->factoryFor(qname);
+      }
+
+      void closeTag()
+      {
+        if (m_open)
+        {
+          m_content.push_back('>');
+          m_open = false;
+        }
+      }
+
+      void escape(const xmlChar *ch, int len)
+      {
+        for (auto cp = (const char *)ch, end = cp + len; cp < end; cp++)
+        {
+          switch (*cp)
+          {
+            case '<':
+              m_content.append("&lt;");
+              break;
+
+            case '>':
+              m_content.append("&gt;");
+              break;
+
+            case '&':
+              m_content.append("&amp;");
+              break;
+
+            case '\r':
+              m_content.append("&#13;");
+              break;
+
+            default:
+              m_content.push_back(*cp);
+              break;
+          }
+        }
+      }
+
+      void dump(xmlNodePtr node)
+      {
+        if (m_buffer == nullptr)
+        {
+          THROW_IF_XML2_NULL(m_buffer = xmlBufferCreate());
+        }
+        else
+        {
+          xmlBufferEmpty(m_buffer);
+        }
+
+        if (xmlNodeDump(m_buffer, node->doc, node, 0, 0) > 0)
+          m_content.append((const char *)xmlBufferContent(m_buffer), xmlBufferLength(m_buffer));
+      }
+
+      void dumpLast()
+      {
+        if (m_raw != nullptr && m_ctxt->node != nullptr && m_ctxt->node->last != nullptr)
+        {
+          // Adjacent CDATA sections are merged into the same node, write it again
+          auto last = m_ctxt->node->last;
+          if (last == m_last)
+            m_content.resize(m_lastOffset);
+          m_last = last;
+          m_lastOffset = m_content.size();
+
+          dump(last);
+          prune(m_ctxt->node);
+        }
+      }
+
+      /// @brief free the node before the last child unless it is the first child
+      static void prune(xmlNodePtr parent)
+      {
+        auto last = parent->last;
+        if (last != nullptr && last->prev != nullptr && last->prev != parent->children)
+        {
+          auto node = last->prev;
+          xmlUnlinkNode(node);
+          xmlFreeNode(node);
+        }
+      }
+
+      static void freeChildren(xmlNodePtr node)
+      {
+        xmlFreeNodeList(node->children);
+        node->children = node->last = nullptr;
+      }
+
+    protected:
+      FactoryPtr m_root;
+      xmlParserCtxtPtr m_ctxt;
+      xmlSAXHandler m_sax;
+      xmlBufferPtr m_buffer {nullptr};
+
+      // The factories of the open elements outside of the raw content
+      std::vector<FactoryPtr> m_factories;
+
+      // The raw entity being streamed
+      xmlNodePtr m_raw {nullptr};
+      int m_depth {0};
+      bool m_open {false};
+      xmlNodePtr m_last {nullptr};
+      size_t m_lastOffset {0};
+      std::string m_content;
+      std::list<std::string> m_captured;
+    };
+  }  // namespace
+
   static Value parseRawNode(xmlNodePtr node)
   {
+    if (node->_private != nullptr)
+    {
+      auto &raw = *static_cast<string *>(node->_private);
+      if (raw.empty())
+        return nullptr;
+      else
+        return std::move(raw);
+    }
+
     stringstream str;
     for (xmlNodePtr child = node->children; child; child = child->next)
     {
@@ -250,10 +553,26 @@ namespace mtconnect::entity {
       xmlXPathInit();
       xmlSetGenericErrorFunc(nullptr, entityXMLErrorFunc);
 
-      unique_ptr<xmlDoc, function<void(xmlDocPtr)>> doc(
-          xmlReadMemory(document.c_str(), int32_t(document.length()), "document.xml", nullptr,
-                        XML_PARSE_NOBLANKS),
-          [](xmlDocPtr d) { xmlFreeDoc(d); });
+      unique_ptr<xmlParserCtxt, function<void(xmlParserCtxtPtr)>> ctxt(
+          xmlCreateMemoryParserCtxt(document.c_str(), int32_t(document.length())),
+          [](xmlParserCtxtPtr c) { xmlFreeParserCtxt(c); });
+      optional<RawContentHandler> handler;
+      unique_ptr<xmlDoc, function<void(xmlDocPtr)>> doc(nullptr,
+                                                        [](xmlDocPtr d) { xmlFreeDoc(d); });
+      if (ctxt)
+      {
+        if (ctxt->input != nullptr && ctxt->input->filename == nullptr)
+          ctxt->input->filename = (char *)xmlStrdup(BAD_CAST "document.xml");
+        xmlCtxtUseOptions(ctxt.get(), XML_PARSE_NOBLANKS);
+        handler.emplace(factory, ctxt.get());
+
+        xmlParseDocument(ctxt.get());
+        if (ctxt->wellFormed)
+          doc.reset(ctxt->myDoc);
+        else if (ctxt->myDoc != nullptr)
+          xmlFreeDoc(ctxt->myDoc);
+        ctxt->myDoc = nullptr;
+      }
       xmlNodePtr root = xmlDocGetRootElement(doc.get());
       if (root != nullptr)
         entity = parseXmlNode(factory, root, errors, parseNamespaces);
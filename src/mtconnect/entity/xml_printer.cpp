@@ -19,8 +19,6 @@
 
 #include <unordered_map>
 
-#include <libxml/xmlwriter.h>
-
 #include "mtconnect/logging.hpp"
 #include "mtconnect/printer/xml_printer_helper.hpp"
 
@@ -41,20 +39,16 @@ namespace mtconnect {
       return name;
     }
 
-    static inline void addAttributes(xmlTextWriterPtr writer,
-                                     const std::map<string, string> &attributes)
+    static inline void addAttributes(XmlWriter &writer, const std::map<string, string> &attributes)
     {
       for (const auto &attr : attributes)
       {
         if (!attr.second.empty())
-        {
-          THROW_IF_XML2_ERROR(xmlTextWriterWriteAttribute(writer, BAD_CAST attr.first.c_str(),
-                                                          BAD_CAST attr.second.c_str()));
-        }
+          writer.writeAttribute(attr.first, attr.second);
       }
     }
 
-    static void addSimpleElement(xmlTextWriterPtr writer, const string &element, const string &body,
+    static void addSimpleElement(XmlWriter &writer, const string &element, const string &body,
                                  const map<string, string> &attributes = {}, bool raw = false)
     {
       AutoElement ele(writer, element);
@@ -64,18 +58,14 @@ namespace mtconnect {
 
       if (!body.empty())
       {
-        xmlChar *text = nullptr;
         if (!raw)
-          text = xmlEncodeEntitiesReentrant(nullptr, BAD_CAST body.c_str());
+          writer.writeEntities(body);
         else
-          text = BAD_CAST body.c_str();
-        THROW_IF_XML2_ERROR(xmlTextWriterWriteRaw(writer, text));
-        if (!raw)
-          xmlFree(text);
+          writer.writeRaw(body);
       }
     }
 
-    void printDataSet(xmlTextWriterPtr writer, const std::string &name, const DataSet &set)
+    void printDataSet(XmlWriter &writer, const std::string &name, const DataSet &set)
     {
       AutoElement ele(writer);
       if (name != "VALUE")
@@ -147,7 +137,7 @@ namespace mtconnect {
       return s->c_str();
     }
 
-    void printProperty(xmlTextWriterPtr writer, const Property &p,
+    void printProperty(XmlWriter &writer, const Property &p,
                        const unordered_set<string> &namespaces)
     {
       string t;
@@ -155,22 +145,22 @@ namespace mtconnect {
       if (p.first == "VALUE")
       {
         // The value is the content for a simple element
-        THROW_IF_XML2_ERROR(xmlTextWriterWriteString(writer, BAD_CAST s));
+        writer.writeString(s);
       }
       else if (p.first == "RAW")
       {
-        THROW_IF_XML2_ERROR(xmlTextWriterWriteRaw(writer, BAD_CAST s));
+        writer.writeRaw(s);
       }
       else
       {
         QName name(p.first);
         string qname = stripUndeclaredNamespace(name, namespaces);
         AutoElement element(writer, qname);
-        THROW_IF_XML2_ERROR(xmlTextWriterWriteString(writer, BAD_CAST s));
+        writer.writeString(s);
       }
     }
 
-    void XmlPrinter::print(xmlTextWriterPtr writer, const EntityPtr entity,
+    void XmlPrinter::print(XmlWriter &writer, const EntityPtr entity,
                            const std::unordered_set<std::string> &namespaces)
     {
       NAMED_SCOPE("entity.xml_printer");
@@ -239,8 +229,7 @@ namespace mtconnect {
         bool isNsDecl = name.hasNs() && name.getNs() == "xmlns";
         if (!isNsDecl || namespaces.count(string(name.getName())) == 0)
         {
-          THROW_IF_XML2_ERROR(xmlTextWriterWriteAttribute(writer, BAD_CAST a.first.c_str(),
-                                                          BAD_CAST toCharPtr(a.second, t)));
+          writer.writeAttribute(a.first, toCharPtr(a.second, t));
         }
       }
 
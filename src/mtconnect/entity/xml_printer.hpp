@@ -22,13 +22,11 @@
 #include "mtconnect/config.hpp"
 #include "mtconnect/entity/entity.hpp"
 
-extern "C"
-{
-  using xmlTextWriter = struct _xmlTextWriter;
-  using xmlTextWriterPtr = xmlTextWriter *;
-}
-
 namespace mtconnect {
+  namespace printer {
+    class XmlWriter;
+  }
+
   namespace entity {
     /// @brief Convert an entity to an XML document
     class AGENT_LIB_API XmlPrinter
@@ -36,11 +34,11 @@ namespace mtconnect {
     public:
       XmlPrinter(bool includeHidden = false) : m_includeHidden(includeHidden) {}
 
-      /// @brief convert an entity to a XML document using `libxml2`
-      /// @param writer libxml2 `xmlTextWriterPtr`
+      /// @brief convert an entity to a XML document
+      /// @param writer the XML writer
       /// @param entity the entity
       /// @param namespaces a set of namespaces to use in the document
-      void print(xmlTextWriterPtr writer, const EntityPtr entity,
+      void print(printer::XmlWriter &writer, const EntityPtr entity,
                  const std::unordered_set<std::string> &namespaces);
 
     protected:
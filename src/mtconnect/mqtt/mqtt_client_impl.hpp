@@ -21,6 +21,7 @@
 #include <boost/uuid/name_generator_sha1.hpp>
 
 #include <inttypes.h>
+#include <list>
 #include <mqtt/async_client.hpp>
 #include <mqtt/setup_log.hpp>
 
@@ -110,6 +111,14 @@ namespace mtconnect {
         auto ci = GetOption<Seconds>(options, configuration::MqttConnectInterval);
         if (ci)
           m_connectInterval = *ci;
+
+        auto maxInFlight = GetOption<int>(options, configuration::MqttMaxInFlight).value_or(0);
+        if (maxInFlight < 0)
+        {
+          LOG(warning) << "MqttMaxInFlight must not be negative, publishes will not be limited";
+          maxInFlight = 0;
+        }
+        m_maxInFlight = size_t(maxInFlight);
       }
 
       ~MqttClientImpl() { stop(); }
@@ -158,6 +167,13 @@ namespace mtconnect {
           LOG(info) << "MQTT " << m_url << ": connection closed";
           // Queue on a strand
           m_connected = false;
+          {
+            // Everything is published again when the connection is restored
+            std::lock_guard<std::mutex> lock(m_publishMutex);
+            m_inFlight = 0;
+            m_queued.clear();
+            m_queuedTopics.clear();
+          }
           if (m_handler && m_handler->m_disconnected)
             m_handler->m_disconnected(shared_from_this());
           if (m_running)
@@ -177,6 +193,11 @@ namespace mtconnect {
             reconnect();
         });
 
+        client->set_puback_handler([this](std::uint16_t packet_id) {
+          publishComplete();
+          return true;
+        });
+
         client->set_publish_handler([this](mqtt::optional<std::uint16_t> packet_id,
                                            mqtt::publish_options pubopts, mqtt::buffer topic_name,
                                            mqtt::buffer contents) {
@@ -268,18 +289,82 @@ namespace mtconnect {
           return false;
         }
 
+        if (m_maxInFlight > 0)
+        {
+          std::lock_guard<std::mutex> lock(m_publishMutex);
+          if (m_inFlight >= m_maxInFlight)
+          {
+            // Messages are retained, so only the latest payload for a topic needs to be sent
+            auto queued = m_queuedTopics.find(topic);
+            if (queued != m_queuedTopics.end())
+            {
+              queued->second->second = payload;
+            }
+            else
+            {
+              m_queued.emplace_back(topic, payload);
+              m_queuedTopics.emplace(topic, std::prev(m_queued.end()));
+            }
+            return true;
+          }
+          m_inFlight++;
+        }
+
+        asyncPublish(topic, payload);
+
+        return true;
+      }
+
+      /// @brief get the number of QoS 1 publishes waiting for an acknowledgement
+      /// @return the number in flight, only counted if `MqttMaxInFlight` is set
+      size_t getInFlight()
+      {
+        std::lock_guard<std::mutex> lock(m_publishMutex);
+        return m_inFlight;
+      }
+
+    protected:
+      /// @brief publish with QoS 1 and retain
+      void asyncPublish(const std::string &topic, const std::string &payload)
+      {
         m_packetId = derived().getClient()->acquire_unique_packet_id();
         derived().getClient()->async_publish(
             m_packetId, topic, payload, mqtt::qos::at_least_once | mqtt::retain::yes,
-            [topic](mqtt::error_code ec) {
+            [this, topic](mqtt::error_code ec) {
               if (ec)
               {
                 LOG(error) << "MqttClientImpl::publish: Publish failed to topic " << topic << ": "
                            << ec.message();
+                publishComplete();
               }
             });
+      }
 
-        return true;
+      /// @brief a publish was acknowledged or failed, send the next queued message
+      ///
+      /// When disconnected the queued messages are kept and the publish is no longer in flight.
+      void publishComplete()
+      {
+        if (m_maxInFlight == 0)
+          return;
+
+        std::optional<std::pair<std::string, std::string>> next;
+        {
+          std::lock_guard<std::mutex> lock(m_publishMutex);
+          if (m_connected && !m_queued.empty())
+          {
+            m_queuedTopics.erase(m_queued.front().first);
+            next.emplace(std::move(m_queued.front()));
+            m_queued.pop_front();
+          }
+          else if (m_inFlight > 0)
+          {
+            m_inFlight--;
+          }
+        }
+
+        if (next)
+          asyncPublish(next->first, next->second);
       }
 
     protected:
@@ -356,6 +441,14 @@ namespace mtconnect {
       std::optional<std::string> m_password;
 
       boost::asio::steady_timer m_reconnectTimer;
+
+      // QoS 1 flow control
+      size_t m_maxInFlight {0};
+      size_t m_inFlight {0};
+      std::mutex m_publishMutex;
+      std::list<std::pair<std::string, std::string>> m_queued;
+      std::unordered_map<std::string, std::list<std::pair<std::string, std::string>>::iterator>
+          m_queuedTopics;
     };
 
     /// @brief Create an Mqtt TCP Client
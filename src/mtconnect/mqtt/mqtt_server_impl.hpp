@@ -16,18 +16,17 @@
 //
 
 #include <boost/log/trivial.hpp>
-#include <boost/multi_index/composite_key.hpp>
-#include <boost/multi_index/member.hpp>
-#include <boost/multi_index/ordered_index.hpp>
-#include <boost/multi_index_container.hpp>
 #include <boost/uuid/name_generator_sha1.hpp>
 
+#include <deque>
 #include <inttypes.h>
 #include <mqtt/async_client.hpp>
 #include <mqtt/setup_log.hpp>
 #include <mqtt_server_cpp.hpp>
+#include <mutex>
 
 #include "mqtt_server.hpp"
+#include "mqtt_topic_trie.hpp"
 #include "mtconnect/configuration/config_options.hpp"
 #include "mtconnect/source/adapter/adapter.hpp"
 #include "mtconnect/source/adapter/mqtt/mqtt_adapter.hpp"
@@ -40,42 +39,12 @@ namespace mtconnect {
   using namespace entity;
   using namespace pipeline;
   using namespace source::adapter;
-  namespace mi = boost::multi_index;
 
   namespace mqtt_server {
 
     using con_t = MQTT_NS::server_tls_ws<>::endpoint_t;
     using con_sp_t = std::shared_ptr<con_t>;
 
-    struct sub_con
-    {
-      sub_con(MQTT_NS::buffer topic, con_sp_t con, MQTT_NS::qos qos_value)
-        : topic(std::move(topic)), con(std::move(con)), qos_value(qos_value)
-      {}
-      MQTT_NS::buffer topic;
-      con_sp_t con;
-      MQTT_NS::qos qos_value;
-    };
-
-    struct tag_topic
-    {};
-    struct tag_con
-    {};
-    struct tag_con_topic
-    {};
-
-    using mi_sub_con = mi::multi_index_container<
-        sub_con,
-        mi::indexed_by<
-            mi::ordered_unique<
-                mi::tag<tag_con_topic>,
-                mi::composite_key<sub_con, BOOST_MULTI_INDEX_MEMBER(sub_con, con_sp_t, con),
-                                  BOOST_MULTI_INDEX_MEMBER(sub_con, MQTT_NS::buffer, topic)>>,
-            mi::ordered_non_unique<mi::tag<tag_topic>,
-                                   BOOST_MULTI_INDEX_MEMBER(sub_con, MQTT_NS::buffer, topic)>,
-            mi::ordered_non_unique<mi::tag<tag_con>,
-                                   BOOST_MULTI_INDEX_MEMBER(sub_con, con_sp_t, con)>>>;
-
     template <typename Derived>
     class MqttServerImpl : public MqttServer
     {
@@ -86,6 +55,9 @@ namespace mtconnect {
       /// - Port, defaults to 0/1883
       /// - MqttTls, defaults to false
       /// - ServerIp, defaults to 127.0.0.1/LocalHost
+      /// - MqttMaxInFlight, QoS 1 messages sent to a subscriber before waiting for
+      ///   acknowledgements, defaults to 64, 0 is unlimited. Later messages are queued and a
+      ///   subscriber with `MAX_QUEUED` messages waiting is disconnected.
       MqttServerImpl(boost::asio::io_context &ioContext, const ConfigOptions &options)
         : MqttServer(ioContext),
           m_options(options),
@@ -94,6 +66,14 @@ namespace mtconnect {
         std::stringstream url;
         url << "mqtt://" << m_host << ':' << m_port;
         m_url = url.str();
+
+        auto maxInFlight = GetOption<int>(options, configuration::MqttMaxInFlight).value_or(64);
+        if (maxInFlight < 0)
+        {
+          LOG(warning) << "Server: MqttMaxInFlight must not be negative, using 64";
+          maxInFlight = 64;
+        }
+        m_maxInFlight = size_t(maxInFlight);
       }
 
       ~MqttServerImpl() { stop(); }
@@ -108,20 +88,15 @@ namespace mtconnect {
 
         auto &server = derived().createServer();
 
-        server.set_accept_handler([&server, this](con_sp_t spep) {
+        server.set_accept_handler([this](con_sp_t spep) {
           auto &ep = *spep;
           std::weak_ptr<con_t> wp = spep;
           using packet_id_t = typename std::remove_reference_t<decltype(ep)>::packet_id_t;
           LOG(info) << "Server: Accepted" << std::endl;
-          // For server close if ep is closed.
-          auto g = MQTT_NS::shared_scope_guard([&server] {
-            LOG(info) << "Server: session end" << std::endl;
-            server.close();
-          });
           // Pass spep to keep lifetime.
           // It makes sure wp.lock() never return nullptr in the handlers below
           // including close_handler and error_handler.
-          ep.start_session(std::make_tuple(std::move(spep), std::move(g)));
+          ep.start_session(std::move(spep));
           ep.set_connect_handler([this, wp](MQTT_NS::buffer client_id,
                                             MQTT_NS::optional<MQTT_NS::buffer> username,
                                             MQTT_NS::optional<MQTT_NS::buffer> password,
@@ -141,7 +116,10 @@ namespace mtconnect {
               LOG(error) << "Server: Endpoint has been deleted";
               return false;
             }
-            m_connections.insert(sp);
+            {
+              std::lock_guard<std::mutex> lock(m_mutex);
+              m_sessions.try_emplace(sp);
+            }
             sp->connack(false, MQTT_NS::connect_return_code::accepted);
             return true;
           });
@@ -155,10 +133,7 @@ namespace mtconnect {
               LOG(error) << "Server Endpoint has been deleted";
               return false;
             }
-            m_connections.erase(con);
-            auto &idx = m_subs.get<tag_con>();
-            auto r = idx.equal_range(con);
-            idx.erase(r.first, r.second);
+            removeSession(con);
 
             return true;
           });
@@ -171,10 +146,7 @@ namespace mtconnect {
               LOG(error) << "Server Endpoint has been deleted";
               return false;
             }
-            m_connections.erase(con);
-            auto &idx = m_subs.get<tag_con>();
-            auto r = idx.equal_range(con);
-            idx.erase(r.first, r.second);
+            removeSession(con);
 
             return true;
           });
@@ -191,36 +163,87 @@ namespace mtconnect {
                   LOG(error) << "Server Endpoint has been deleted";
                   return false;
                 }
+
+                std::lock_guard<std::mutex> lock(m_mutex);
                 for (auto const &e : entries)
                 {
                   LOG(debug) << "Server: topic_filter: " << e.topic_filter
                              << " qos: " << e.subopts.get_qos() << std::endl;
                   res.emplace_back(MQTT_NS::qos_to_suback_return_code(e.subopts.get_qos()));
-                  m_subs.emplace(std::move(e.topic_filter), sp, e.subopts.get_qos());
+                  m_subscriptions.subscribe(e.topic_filter, sp, e.subopts.get_qos());
                 }
                 sp->suback(packet_id, res);
+
+                // Send the retained messages matching the new subscriptions
+                auto session = m_sessions.find(sp);
+                if (session != m_sessions.end())
+                {
+                  for (auto const &e : entries)
+                  {
+                    for (auto &[topic, retained] : m_retained)
+                    {
+                      if (Trie::matches(e.topic_filter, topic))
+                        deliver(sp, session->second, retained.m_topic, retained.m_contents,
+                                std::min(retained.m_qos, e.subopts.get_qos()), true);
+                    }
+                  }
+                }
+                return true;
+              });
+
+          ep.set_unsubscribe_handler(
+              [this, wp](packet_id_t packet_id, std::vector<MQTT_NS::unsubscribe_entry> entries) {
+                LOG(debug) << "Server: Unsubscribe received. packet_id: " << packet_id;
+                auto sp = wp.lock();
+                if (!sp)
+                {
+                  LOG(error) << "Server Endpoint has been deleted";
+                  return false;
+                }
+
+                {
+                  std::lock_guard<std::mutex> lock(m_mutex);
+                  for (auto const &e : entries)
+                    m_subscriptions.unsubscribe(e.topic_filter, sp);
+                }
+                sp->unsuback(packet_id);
                 return true;
               });
 
+          ep.set_puback_handler([this, wp](packet_id_t packet_id) {
+            auto sp = wp.lock();
+            if (sp)
+              acknowledged(sp);
+            return true;
+          });
+
           ep.set_publish_handler([this](mqtt::optional<std::uint16_t> packet_id,
                                         mqtt::publish_options pubopts, mqtt::buffer topic_name,
                                         mqtt::buffer contents) {
-            LOG(debug) << "Server: publish received."
+            LOG(trace) << "Server: publish received."
                        << " dup: " << pubopts.get_dup() << " qos: " << pubopts.get_qos()
-                       << " retain: " << pubopts.get_retain() << std::endl;
+                       << " retain: " << pubopts.get_retain() << " topic_name: " << topic_name;
 
-            if (packet_id)
-              LOG(debug) << "Server packet_id: " << *packet_id;
-
-            LOG(debug) << "Server topic_name: " << topic_name;
-            LOG(debug) << "Server contents: " << contents;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (pubopts.get_retain() == MQTT_NS::retain::yes)
+            {
+              // An empty payload clears the retained message
+              if (contents.empty())
+                m_retained.erase(std::string(topic_name));
+              else
+                m_retained.insert_or_assign(std::string(topic_name),
+                                            Retained {topic_name, contents, pubopts.get_qos()});
+            }
 
-            auto const &idx = m_subs.get<tag_topic>();
-            auto r = idx.equal_range(topic_name);
-            for (; r.first != r.second; ++r.first)
+            // The buffers are reference counted, every subscriber shares the received payload
+            typename Trie::Matches matches;
+            m_subscriptions.match(topic_name, matches);
+            for (auto &[con, qos] : matches)
             {
-              r.first->con->publish(topic_name, contents,
-                                    std::min(r.first->qos_value, pubopts.get_qos()));
+              auto session = m_sessions.find(con);
+              if (session != m_sessions.end())
+                deliver(con, session->second, topic_name, contents,
+                        std::min(qos, pubopts.get_qos()), false);
             }
 
             return true;
@@ -250,11 +273,117 @@ namespace mtconnect {
         }
       }
 
+    protected:
+      using Trie = TopicTrie<con_sp_t, MQTT_NS::qos>;
+
+      /// @brief A message waiting for the subscriber to acknowledge earlier messages
+      struct Pending
+      {
+        MQTT_NS::buffer m_topic;
+        MQTT_NS::buffer m_contents;
+        MQTT_NS::publish_options m_options;
+      };
+
+      /// @brief QoS 1 flow control for a connection
+      struct Session
+      {
+        size_t m_inFlight {0};
+        std::deque<Pending> m_queue;
+        bool m_disconnecting {false};
+      };
+
+      /// @brief A retained message for a topic
+      struct Retained
+      {
+        MQTT_NS::buffer m_topic;
+        MQTT_NS::buffer m_contents;
+        MQTT_NS::qos m_qos;
+      };
+
+      /// @brief maximum number of messages queued for a slow subscriber
+      ///
+      /// Dropping queued QoS 1 messages would break the delivery guarantee, so a subscriber that
+      /// falls this far behind is disconnected instead. It can reconnect and resubscribe.
+      static constexpr size_t MAX_QUEUED = 10000;
+
+      /// @brief send a message to a subscriber, must be called with the mutex held
+      void deliver(const con_sp_t &con, Session &session, const MQTT_NS::buffer &topic,
+                   const MQTT_NS::buffer &contents, MQTT_NS::qos qos, bool retain)
+      {
+        MQTT_NS::publish_options options =
+            qos | (retain ? MQTT_NS::retain::yes : MQTT_NS::retain::no);
+
+        if (session.m_disconnecting)
+          return;
+
+        if (qos != MQTT_NS::qos::at_most_once && m_maxInFlight > 0)
+        {
+          if (session.m_inFlight >= m_maxInFlight)
+          {
+            if (session.m_queue.size() >= MAX_QUEUED)
+            {
+              LOG(warning) << "Server: subscriber " << con->get_client_id() << " has "
+                           << MAX_QUEUED << " unacknowledged messages queued, disconnecting";
+              session.m_disconnecting = true;
+              session.m_queue.clear();
+              con->async_force_disconnect();
+              return;
+            }
+            session.m_queue.push_back(Pending {topic, contents, options});
+            return;
+          }
+          session.m_inFlight++;
+        }
+
+        send(con, topic, contents, options);
+      }
+
+      void send(const con_sp_t &con, const MQTT_NS::buffer &topic,
+                const MQTT_NS::buffer &contents, MQTT_NS::publish_options options)
+      {
+        con->async_publish(topic, contents, options, [topic](MQTT_NS::error_code ec) {
+          if (ec)
+            LOG(error) << "Server: publish to " << topic << " failed: " << ec.message();
+        });
+      }
+
+      /// @brief a QoS 1 message was acknowledged, send the next queued message
+      void acknowledged(const con_sp_t &con)
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto session = m_sessions.find(con);
+        if (session == m_sessions.end())
+          return;
+
+        auto &s = session->second;
+        if (!s.m_queue.empty())
+        {
+          auto next = std::move(s.m_queue.front());
+          s.m_queue.pop_front();
+          send(con, next.m_topic, next.m_contents, next.m_options);
+        }
+        else if (s.m_inFlight > 0)
+        {
+          s.m_inFlight--;
+        }
+      }
+
+      void removeSession(const con_sp_t &con)
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_sessions.erase(con);
+        m_subscriptions.unsubscribeAll(con);
+      }
+
     protected:
       ConfigOptions m_options;
-      std::set<con_sp_t> m_connections;
-      mi_sub_con m_subs;
       std::string m_host;
+      size_t m_maxInFlight {64};
+
+      std::mutex m_mutex;
+      std::map<con_sp_t, Session> m_sessions;
+      Trie m_subscriptions;
+      std::map<std::string, Retained> m_retained;
     };
 
     /// @brief Create an Mqtt TCP server
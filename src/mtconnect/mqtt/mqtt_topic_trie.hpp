@@ -0,0 +1,233 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mtconnect::mqtt_server {
+  /// @brief Subscriptions indexed by topic filter level for wildcard matching
+  ///
+  /// Each level of a topic filter is a node in the trie. A topic is matched by walking the levels
+  /// and following the literal, `+` and `#` children, so the cost depends on the depth of the
+  /// topic and not on the number of subscriptions. Topics starting with `$` are not matched by
+  /// wildcards in the first level.
+  ///
+  /// @tparam Subscriber the subscriber key, must be ordered
+  /// @tparam Qos the quality of service, must be ordered
+  template <typename Subscriber, typename Qos>
+  class TopicTrie
+  {
+  public:
+    using Matches = std::map<Subscriber, Qos>;
+
+    /// @brief add or replace a subscription
+    /// @param[in] filter the topic filter
+    /// @param[in] subscriber the subscriber
+    /// @param[in] qos the maximum quality of service
+    void subscribe(std::string_view filter, const Subscriber &subscriber, Qos qos)
+    {
+      Node *node = &m_root;
+      for (auto level : split(filter))
+      {
+        auto child = node->m_children.find(level);
+        if (child == node->m_children.end())
+          child =
+              node->m_children.emplace(std::string(level), std::make_unique<Node>()).first;
+        node = child->second.get();
+      }
+      node->m_subscribers[subscriber] = qos;
+      m_filters[subscriber].emplace(filter);
+    }
+
+    /// @brief remove a subscription
+    /// @param[in] filter the topic filter
+    /// @param[in] subscriber the subscriber
+    void unsubscribe(std::string_view filter, const Subscriber &subscriber)
+    {
+      auto levels = split(filter);
+      remove(m_root, levels, 0, subscriber);
+
+      auto filters = m_filters.find(subscriber);
+      if (filters != m_filters.end())
+      {
+        auto f = filters->second.find(filter);
+        if (f != filters->second.end())
+          filters->second.erase(f);
+        if (filters->second.empty())
+          m_filters.erase(filters);
+      }
+    }
+
+    /// @brief remove all subscriptions for a subscriber
+    /// @param[in] subscriber the subscriber
+    void unsubscribeAll(const Subscriber &subscriber)
+    {
+      auto filters = m_filters.find(subscriber);
+      if (filters == m_filters.end())
+        return;
+
+      for (auto &filter : filters->second)
+      {
+        auto levels = split(filter);
+        remove(m_root, levels, 0, subscriber);
+      }
+      m_filters.erase(filters);
+    }
+
+    /// @brief find the subscribers for a topic
+    ///
+    /// A subscriber matching more than one filter is only returned once with the highest
+    /// quality of service.
+    ///
+    /// @param[in] topic the topic name
+    /// @param[out] matches the subscribers and their quality of service
+    void match(std::string_view topic, Matches &matches) const
+    {
+      auto levels = split(topic);
+      match(m_root, levels, 0, !topic.empty() && topic.front() == '$', matches);
+    }
+
+    /// @brief check if a topic filter matches a topic name
+    /// @param[in] filter the topic filter
+    /// @param[in] topic the topic name
+    /// @return `true` if the filter matches
+    static bool matches(std::string_view filter, std::string_view topic)
+    {
+      if (!topic.empty() && topic.front() == '$' && !filter.empty() &&
+          (filter.front() == '+' || filter.front() == '#'))
+        return false;
+
+      auto f = split(filter);
+      auto t = split(topic);
+      size_t i = 0;
+      for (; i < f.size(); i++)
+      {
+        if (f[i] == "#")
+          return true;
+        if (i >= t.size() || (f[i] != "+" && f[i] != t[i]))
+          return false;
+      }
+
+      return i == t.size();
+    }
+
+    /// @brief number of subscribers with at least one subscription
+    size_t subscriberCount() const { return m_filters.size(); }
+
+    /// @brief check if there are no subscriptions
+    bool empty() const { return m_filters.empty(); }
+
+  protected:
+    struct Node
+    {
+      std::map<std::string, std::unique_ptr<Node>, std::less<>> m_children;
+      std::map<Subscriber, Qos> m_subscribers;
+
+      bool empty() const { return m_children.empty() && m_subscribers.empty(); }
+    };
+
+    static std::vector<std::string_view> split(std::string_view topic)
+    {
+      std::vector<std::string_view> levels;
+      size_t start = 0;
+      while (true)
+      {
+        auto pos = topic.find('/', start);
+        if (pos == std::string_view::npos)
+        {
+          levels.emplace_back(topic.substr(start));
+          break;
+        }
+        levels.emplace_back(topic.substr(start, pos - start));
+        start = pos + 1;
+      }
+      return levels;
+    }
+
+    static void add(const Node &node, Matches &matches)
+    {
+      for (auto &[subscriber, qos] : node.m_subscribers)
+      {
+        auto res = matches.try_emplace(subscriber, qos);
+        if (!res.second)
+          res.first->second = std::max(res.first->second, qos);
+      }
+    }
+
+    static void match(const Node &node, const std::vector<std::string_view> &levels, size_t pos,
+                      bool system, Matches &matches)
+    {
+      bool wildcards = !(system && pos == 0);
+
+      // # matches the parent level and everything below it
+      if (wildcards)
+      {
+        auto multi = node.m_children.find("#");
+        if (multi != node.m_children.end())
+          add(*multi->second, matches);
+      }
+
+      if (pos == levels.size())
+      {
+        add(node, matches);
+        return;
+      }
+
+      auto literal = node.m_children.find(levels[pos]);
+      if (literal != node.m_children.end())
+        match(*literal->second, levels, pos + 1, system, matches);
+
+      if (wildcards)
+      {
+        auto single = node.m_children.find("+");
+        if (single != node.m_children.end())
+          match(*single->second, levels, pos + 1, system, matches);
+      }
+    }
+
+    static bool remove(Node &node, const std::vector<std::string_view> &levels, size_t pos,
+                       const Subscriber &subscriber)
+    {
+      if (pos == levels.size())
+      {
+        node.m_subscribers.erase(subscriber);
+      }
+      else
+      {
+        auto child = node.m_children.find(levels[pos]);
+        if (child != node.m_children.end() &&
+            remove(*child->second, levels, pos + 1, subscriber))
+          node.m_children.erase(child);
+      }
+
+      // Prune empty branches
+      return node.empty();
+    }
+
+  protected:
+    Node m_root;
+    std::map<Subscriber, std::set<std::string, std::less<>>> m_filters;
+  };
+}  // namespace mtconnect::mqtt_server
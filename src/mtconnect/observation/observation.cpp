@@ -158,7 +158,7 @@ namespace mtconnect {
 
       auto obs = dynamic_pointer_cast<Observation>(ent);
       obs->m_timestamp = timestamp;
-      obs->m_dataItem = dataItem;
+      obs->m_dataItem = dataItem->getHandle();
 
       if (unavailable)
         obs->makeUnavailable();
@@ -414,51 +414,132 @@ namespace mtconnect {
       return factory;
     }
 
-    bool Condition::replace(ConditionPtr &old, ConditionPtr &_new)
+    ObservationBuilder::ObservationBuilder(const DataItemPtr dataItem)
     {
-      if (!m_prev)
-        return false;
-
-      if (m_prev == old)
+      NAMED_SCOPE("ObservationBuilder");
+
+      if (dataItem->isCondition() || dataItem->hasProperty("ResetTrigger") ||
+          dataItem->getConstantValue())
+        return;
+
+      Kind kind {NONE};
+      auto factory = Observation::getFactory()->factoryFor(dataItem->getKey());
+      if (factory == Sample::getFactory())
+        kind = SAMPLE;
+      else if (factory == Event::getFactory())
+        kind = EVENT;
+      else if (factory == DoubleEvent::getFactory())
+        kind = DOUBLE_EVENT;
+      else if (factory == IntEvent::getFactory())
+        kind = INT_EVENT;
+      else
+        return;
+
+      // Validate the data item properties once so they can be copied as is
+      Properties props;
+      Observation::setProperties(dataItem, props);
+      props.insert_or_assign("timestamp", Timestamp());
+      ErrorList errors;
+      auto ent = factory->make(dataItem->getKey(), props, errors);
+      if (!ent || !errors.empty())
       {
-        _new->m_prev = old->m_prev;
-        m_prev = _new;
-        return true;
+        LOG(debug) << "Data item " << dataItem->getId()
+                   << " observation properties require validation, using factory";
+        return;
       }
 
-      return m_prev->replace(old, _new);
+      m_kind = kind;
+      m_key = dataItem->getKey();
+      m_properties = ent->getProperties();
+      m_properties.erase("timestamp");
     }
 
-    ConditionPtr Condition::deepCopy()
+    ObservationPtr ObservationBuilder::create(const DataItemPtr dataItem,
+                                              const Timestamp &timestamp) const
     {
-      auto n = make_shared<Condition>(*this);
-
-      if (m_prev)
+      ObservationPtr obs;
+      switch (m_kind)
       {
-        n->m_prev = m_prev->deepCopy();
+        case SAMPLE:
+          obs = make_shared<Sample>(m_key, m_properties);
+          break;
+
+        case EVENT:
+          obs = make_shared<Event>(m_key, m_properties);
+          break;
+
+        case DOUBLE_EVENT:
+          obs = make_shared<DoubleEvent>(m_key, m_properties);
+          break;
+
+        case INT_EVENT:
+          obs = make_shared<IntEvent>(m_key, m_properties);
+          break;
+
+        case NONE:
+          return nullptr;
       }
 
-      return n;
+      obs->m_properties.insert_or_assign("timestamp", timestamp);
+      obs->m_timestamp = timestamp;
+      obs->m_dataItem = dataItem->getHandle();
+
+      return obs;
     }
 
-    ConditionPtr Condition::deepCopyAndRemove(ConditionPtr &old)
+    ObservationPtr ObservationBuilder::make(const DataItemPtr dataItem, const std::string &value,
+                                            const Timestamp &timestamp) const
     {
-      if (this->getptr() == old)
+      entity::Value converted;
+      switch (m_kind)
       {
-        if (m_prev)
-          return m_prev->deepCopy();
-        else
+        case SAMPLE:
+        case DOUBLE_EVENT:
+        {
+          double d;
+          const char *sp = value.c_str();
+          if (parseDouble(sp, sp + value.size(), d) == sp)
+            return nullptr;
+          converted = d;
+          break;
+        }
+
+        case INT_EVENT:
+        {
+          char *ep = nullptr;
+          int64_t i = strtoll(value.c_str(), &ep, 10);
+          if (ep == value.c_str())
+            return nullptr;
+          converted = i;
+          break;
+        }
+
+        case EVENT:
+          converted = value;
+          break;
+
+        case NONE:
           return nullptr;
       }
 
-      auto n = make_shared<Condition>(*this);
+      auto obs = create(dataItem, timestamp);
+      obs->m_properties.insert_or_assign("VALUE", std::move(converted));
+      obs->setEntityName();
+
+      return obs;
+    }
 
-      if (m_prev)
+    ObservationPtr ObservationBuilder::makeUnavailable(const DataItemPtr dataItem,
+                                                       const Timestamp &timestamp) const
+    {
+      auto obs = create(dataItem, timestamp);
+      if (obs)
       {
-        n->m_prev = m_prev->deepCopyAndRemove(old);
+        obs->makeUnavailable();
+        obs->setEntityName();
       }
 
-      return n;
+      return obs;
     }
   }  // namespace observation
 }  // namespace mtconnect
@@ -17,10 +17,12 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 #include <date/date.h>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -75,29 +77,20 @@ namespace mtconnect::observation {
     /// @param[in] dataItem the data item
     void setDataItem(const DataItemPtr dataItem)
     {
-      m_dataItem = dataItem;
+      m_dataItem = dataItem->getHandle();
       setProperties(dataItem, m_properties);
     }
 
     /// @brief get the associated data item
+    ///
+    /// Resolves the current version of the data item if the device model has changed.
+    ///
     /// @return shared pointer to the data item
-    const auto getDataItem() const { return m_dataItem.lock(); }
+    DataItemPtr getDataItem() const { return m_dataItem ? m_dataItem->get() : nullptr; }
     /// @brief get the sequence number of the observation
     /// @return the sequence number
     auto getSequence() const { return m_sequence; }
 
-    /// @brief update related data item when the device is updated
-    /// @param[in] diMap a map of data item ids to data items
-    void updateDataItem(std::unordered_map<std::string, WeakDataItemPtr> &diMap)
-    {
-      auto old = m_dataItem.lock();
-      auto ndi = diMap.find(old->getId());
-      if (ndi != diMap.end())
-        m_dataItem = ndi->second;
-      else
-        LOG(trace) << "Observation cannot find data item: " << old->getId();
-    }
-
     /// @brief set the timestamp
     /// @param[in] ts the timestamp
     void setTimestamp(const Timestamp &ts)
@@ -129,7 +122,7 @@ namespace mtconnect::observation {
     /// @brief set the entity name (QName) from the data item observation name
     virtual void setEntityName()
     {
-      auto di = m_dataItem.lock();
+      auto di = getDataItem();
       if (di)
         Entity::setQName(di->getObservationName());
     }
@@ -140,10 +133,10 @@ namespace mtconnect::observation {
     /// @return `true` if this observation is less than `another`
     bool operator<(const Observation &another) const
     {
-      auto di = m_dataItem.lock();
+      auto di = getDataItem();
       if (!di)
         return false;
-      auto odi = another.m_dataItem.lock();
+      auto odi = another.getDataItem();
       if (!odi)
         return true;
 
@@ -160,13 +153,13 @@ namespace mtconnect::observation {
     bool isOrphan() const
     {
 #ifdef NDEBUG
-      return m_dataItem.expired();
+      return !m_dataItem || m_dataItem->expired();
 #else
-      if (m_dataItem.expired())
+      auto di = getDataItem();
+      if (!di)
         return true;
-      if (m_dataItem.lock()->isOrphan())
+      if (di->isOrphan())
       {
-        auto di = m_dataItem.lock();
         LOG(trace) << "!!! DataItem " << di->getTopicName() << " orphaned";
         return true;
       }
@@ -178,9 +171,11 @@ namespace mtconnect::observation {
     void clearResetTriggered() { m_properties.erase("resetTriggered"); }
 
   protected:
+    friend class ObservationBuilder;
+
     Timestamp m_timestamp;
     bool m_unavailable {false};
-    std::weak_ptr<device_model::data_item::DataItem> m_dataItem;
+    device_model::data_item::DataItemHandlePtr m_dataItem;
     uint64_t m_sequence {0};
   };
 
@@ -223,12 +218,11 @@ namespace mtconnect::observation {
 
   class Condition;
   using ConditionPtr = std::shared_ptr<Condition>;
-  using ConditionList = std::list<ConditionPtr>;
 
   /// @brief An MTConnect Condition
   ///
-  /// Conditions are linked together to keep track of all the conditions that are
-  /// active at one time. When the normal condition arrives, the list is cleared.
+  /// The checkpoint keeps track of all the conditions that are active at one time in a
+  /// `ConditionSet`. When the normal condition arrives, the set is cleared.
   class AGENT_LIB_API Condition : public Observation
   {
   public:
@@ -316,88 +310,120 @@ namespace mtconnect::observation {
       }
     }
 
-    /// @brief get the first condition in the chain
-    ///
-    /// Conditions are chained together to allow for mutiple conditions active at the same time
-    /// @return shared pointer the first condition in the chain
-    ConditionPtr getFirst()
-    {
-      if (m_prev)
-        return m_prev->getFirst();
+    /// @brief Get the code for the condition
+    /// @return the code
+    const std::string &getCode() const { return m_code; }
+    /// @brief get the condition level
+    /// @return the level
+    Level getLevel() const { return m_level; }
+    /// @brief is the condition active
+    /// @return `true` if the condition is a warning or a fault
+    bool isActive() const { return m_level == WARNING || m_level == FAULT; }
 
-      return getptr();
-    }
+  protected:
+    std::string m_code;
+    Level m_level {NORMAL};
+  };
 
-    /// @brief Get a list of all active conditions
-    /// @param[out] list the list condtions
-    void getConditionList(ConditionList &list)
-    {
-      if (m_prev)
-        m_prev->getConditionList(list);
+  /// @brief The active conditions of a condition data item
+  ///
+  /// The conditions are kept in the order they were activated, at most one per native code, and
+  /// indexed by native code. Activating or clearing a code is constant time: a cleared entry is
+  /// left empty and the list is compacted once half of it is empty. Checkpoints share the set
+  /// and copy it only when they change a shared set, the conditions are never copied.
+  class AGENT_LIB_API ConditionSet
+  {
+  public:
+    using Conditions = std::vector<ConditionPtr>;
 
-      list.emplace_back(getptr());
+    /// @brief find the active condition for a native code
+    /// @param[in] code the native code
+    /// @return shared pointer to the condition if found
+    ConditionPtr find(const std::string &code) const
+    {
+      auto it = m_index.find(code);
+      if (it != m_index.end())
+        return m_conditions[it->second];
+      return nullptr;
     }
 
-    /// @brief find a condition by code in the condition list
-    /// @param[in] code te code
-    /// @return shared pointer to the condition if found
-    ConditionPtr find(const std::string &code)
+    /// @brief activate a condition replacing the active condition with the same native code
+    /// @param[in] cond the condition, it becomes the newest condition
+    void activate(ConditionPtr cond)
     {
-      if (m_code == code)
-        return getptr();
+      remove(cond->getCode());
+      m_index[cond->getCode()] = m_conditions.size();
+      m_conditions.emplace_back(std::move(cond));
+      m_count++;
+    }
 
-      if (m_prev)
-        return m_prev->find(code);
+    /// @brief clear the active condition for a native code
+    /// @param[in] code the native code
+    /// @return `true` if the code was active
+    bool clear(const std::string &code) { return remove(code); }
 
-      return nullptr;
+    /// @brief get the active conditions
+    /// @return the conditions, oldest first
+    Conditions getConditions() const
+    {
+      Conditions conditions;
+      conditions.reserve(m_count);
+      for (const auto &cond : m_conditions)
+        if (cond)
+          conditions.push_back(cond);
+      return conditions;
     }
+    /// @brief get the most recently activated condition
+    /// @return the newest condition, the set must not be empty
+    const ConditionPtr &getNewest() const { return m_conditions.back(); }
+    /// @brief get the number of active conditions
+    size_t size() const { return m_count; }
+    /// @brief are there no active conditions
+    bool empty() const { return m_count == 0; }
 
-    /// @brief const find a condition by code in the condition list
-    /// @param[in] code te code
-    /// @return shared pointer to the condition if found
-    const ConditionPtr find(const std::string &code) const
+  protected:
+    bool remove(const std::string &code)
     {
-      if (m_code == code)
-        return std::dynamic_pointer_cast<Condition>(Entity::getptr());
+      auto it = m_index.find(code);
+      if (it == m_index.end())
+        return false;
 
-      if (m_prev)
-        return m_prev->find(code);
+      m_conditions[it->second].reset();
+      m_index.erase(it);
+      m_count--;
 
-      return nullptr;
-    }
+      // Keep the newest condition at the back
+      while (!m_conditions.empty() && !m_conditions.back())
+        m_conditions.pop_back();
+      if (m_conditions.size() > m_count * 2)
+        compact();
 
-    /// @brief replace a condition with another in the condition list
-    /// @param[in] old the condition to be placed
-    /// @param[in] _new the replacement condition
-    /// @return `true` if the old condition was found
-    bool replace(ConditionPtr &old, ConditionPtr &_new);
-    /// @brief copy the condition and all conditions in the list
-    /// @return a new shared condition pointer
-    ConditionPtr deepCopy();
-    /// @brief copy the condition and all conditions in the list removing one condition
-    /// @param[in] old the condition to skip
-    /// @return the new condition pointer
-    ConditionPtr deepCopyAndRemove(ConditionPtr &old);
+      return true;
+    }
 
-    /// @brief Get the code for the condition
-    /// @return the code
-    const std::string &getCode() const { return m_code; }
-    /// @brief get the condition level
-    /// @return the level
-    Level getLevel() const { return m_level; }
-    /// @brief get the previous condition in the list
-    /// @return the previous condition if it exists
-    ConditionPtr getPrev() const { return m_prev; }
-    /// @brief make a condition as the previous condition linking it to the list
-    /// @param[in] cond the previous condition
-    void appendTo(ConditionPtr cond) { m_prev = cond; }
+    void compact()
+    {
+      size_t to = 0;
+      for (auto &cond : m_conditions)
+      {
+        if (cond)
+        {
+          m_index[cond->getCode()] = to;
+          m_conditions[to++] = std::move(cond);
+        }
+      }
+      m_conditions.resize(to);
+    }
 
   protected:
-    std::string m_code;
-    Level m_level {NORMAL};
-    ConditionPtr m_prev;
+    Conditions m_conditions;
+    std::unordered_map<std::string, size_t> m_index;
+    size_t m_count {0};
   };
 
+  using ConditionSetPtr = std::shared_ptr<ConditionSet>;
+  using ConstConditionSetPtr = std::shared_ptr<const ConditionSet>;
+
   /// @brief an MTConnect Event with a string value or controlled vocabulary
   class AGENT_LIB_API Event : public Observation
   {
@@ -465,6 +491,13 @@ namespace mtconnect::observation {
       setValue(set);
       setProperty("count", int64_t(set.size()));
     }
+    /// @brief set the data set value and the count without copying the set
+    /// @param[in] set the data set
+    void setDataSet(entity::DataSet &&set)
+    {
+      setProperty("count", int64_t(set.size()));
+      m_properties.insert_or_assign("VALUE", std::move(set));
+    }
   };
 
   using DataSetEventPtr = std::shared_ptr<DataSetEvent>;
@@ -528,6 +561,61 @@ namespace mtconnect::observation {
     ObservationPtr copy() const override { return std::make_shared<Alarm>(*this); }
   };
 
+  /// @brief Precompiled builder for observations of simple samples and events
+  ///
+  /// The data item's observation properties are validated by the factory once when the builder
+  /// is created. Observations are then created directly from a single value token without
+  /// running the factory requirements. Conditions, data sets, tables, time series, three space
+  /// samples, messages, alarms, and data items with reset triggers are not handled and must use
+  /// Observation::make().
+  class AGENT_LIB_API ObservationBuilder
+  {
+  public:
+    /// @brief the kind of observation created by the builder
+    enum Kind
+    {
+      NONE,
+      SAMPLE,
+      EVENT,
+      DOUBLE_EVENT,
+      INT_EVENT
+    };
+
+    ObservationBuilder() = default;
+    /// @brief create a builder for a data item
+    /// @param[in] dataItem the data item
+    ObservationBuilder(const DataItemPtr dataItem);
+    ObservationBuilder(const ObservationBuilder &) = default;
+    ~ObservationBuilder() = default;
+
+    /// @brief check if observations can be created directly
+    /// @return `true` if the data item is a simple sample or event
+    bool isDirect() const { return m_kind != NONE; }
+    /// @brief get the kind of observation
+    Kind getKind() const { return m_kind; }
+
+    /// @brief create an observation from a value token
+    /// @param[in] dataItem the data item the builder was created for
+    /// @param[in] value the value token
+    /// @param[in] timestamp the timestamp
+    /// @return the observation or `nullptr` if the value cannot be converted
+    ObservationPtr make(const DataItemPtr dataItem, const std::string &value,
+                        const Timestamp &timestamp) const;
+    /// @brief create an unavailable observation
+    /// @param[in] dataItem the data item the builder was created for
+    /// @param[in] timestamp the timestamp
+    /// @return the observation
+    ObservationPtr makeUnavailable(const DataItemPtr dataItem, const Timestamp &timestamp) const;
+
+  protected:
+    ObservationPtr create(const DataItemPtr dataItem, const Timestamp &timestamp) const;
+
+  protected:
+    Kind m_kind {NONE};
+    std::string m_key;
+    entity::Properties m_properties;
+  };
+
   using ObservationComparer = bool (*)(ObservationPtr &, ObservationPtr &);
   inline bool ObservationCompare(ObservationPtr &aE1, ObservationPtr &aE2) { return *aE1 < *aE2; }
 }  // namespace mtconnect::observation
@@ -0,0 +1,232 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/printer/cbor_printer_helper.hpp"
+
+namespace mtconnect::parser {
+  /// @brief Minimal CBOR (RFC 8949) decoder reading from a buffer
+  ///
+  /// Pull style reader for the subset written by the `CborWriter`. Only definite length
+  /// collections are supported. Throws `std::runtime_error` if the data is malformed or the next
+  /// item is not of the requested type.
+  class AGENT_LIB_API CborReader
+  {
+  public:
+    using MajorType = printer::CborWriter::MajorType;
+
+    /// @brief Create a reader over a buffer
+    /// @param[in] buffer the encoded data, must outlive the reader
+    CborReader(std::string_view buffer) : m_buffer(buffer) {}
+
+    /// @brief check if all the data has been read
+    bool atEnd() const { return m_pos >= m_buffer.size(); }
+
+    /// @brief get the major type of the next item without consuming it
+    MajorType peekType() const { return MajorType(peek() >> 5); }
+    /// @brief check if the next item is a null
+    bool isNull() const { return peek() == 0xF6; }
+    /// @brief check if the next item is a boolean
+    bool isBool() const { return peek() == 0xF4 || peek() == 0xF5; }
+    /// @brief get the tag number of the next item without consuming it
+    /// @return the tag number
+    uint64_t peekTag()
+    {
+      auto pos = m_pos;
+      auto tag = head(printer::CborWriter::TAG);
+      m_pos = pos;
+      return tag;
+    }
+
+    /// @name Scalar methods
+    /// @{
+
+    /// @brief read an unsigned integer
+    uint64_t readUnsigned() { return head(printer::CborWriter::UNSIGNED); }
+    /// @brief read a signed integer
+    int64_t readInteger()
+    {
+      if (peekType() == printer::CborWriter::NEGATIVE)
+        return -1 - int64_t(head(printer::CborWriter::NEGATIVE));
+      else
+        return int64_t(head(printer::CborWriter::UNSIGNED));
+    }
+    /// @brief read a single or double precision float
+    double readDouble()
+    {
+      auto b = next();
+      if (b == 0xFA)
+      {
+        uint32_t bits = uint32_t(bigEndian(4));
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+      }
+      else if (b == 0xFB)
+      {
+        uint64_t bits = bigEndian(8);
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        return d;
+      }
+      throw std::runtime_error("CBOR: expected a float");
+    }
+    /// @brief read a boolean
+    bool readBool()
+    {
+      auto b = next();
+      if (b == 0xF5 || b == 0xF4)
+        return b == 0xF5;
+      throw std::runtime_error("CBOR: expected a boolean");
+    }
+    /// @brief consume a null if it is the next item
+    /// @return `true` if a null was read
+    bool readNull()
+    {
+      if (!isNull())
+        return false;
+      m_pos++;
+      return true;
+    }
+    /// @brief read a UTF-8 text string
+    std::string_view readString() { return take(head(printer::CborWriter::TEXT)); }
+    /// @brief read a byte string
+    std::string_view readBytes() { return take(head(printer::CborWriter::BYTES)); }
+    /// @brief read a tag number
+    uint64_t readTag() { return head(printer::CborWriter::TAG); }
+    /// @brief read a timestamp written as microseconds since the epoch
+    Timestamp readTimestamp()
+    {
+      return Timestamp(std::chrono::microseconds(readInteger()));
+    }
+    /// @brief read a packed typed float array
+    std::vector<double> readFloatArray()
+    {
+      auto tag = readTag();
+      if (tag != printer::CborWriter::FLOAT32_LE_ARRAY &&
+          tag != printer::CborWriter::FLOAT64_LE_ARRAY)
+        throw std::runtime_error("CBOR: expected a typed float array");
+      size_t width = tag == printer::CborWriter::FLOAT32_LE_ARRAY ? 4 : 8;
+      auto bytes = readBytes();
+      if (bytes.size() % width != 0)
+        throw std::runtime_error("CBOR: malformed typed float array");
+
+      std::vector<double> values;
+      values.reserve(bytes.size() / width);
+      for (size_t i = 0; i < bytes.size(); i += width)
+      {
+        uint64_t bits = 0;
+        for (size_t j = 0; j < width; j++)
+          bits |= uint64_t(uint8_t(bytes[i + j])) << (j * 8);
+        if (width == 4)
+        {
+          uint32_t b32 = uint32_t(bits);
+          float f;
+          std::memcpy(&f, &b32, sizeof(f));
+          values.push_back(f);
+        }
+        else
+        {
+          double d;
+          std::memcpy(&d, &bits, sizeof(d));
+          values.push_back(d);
+        }
+      }
+      return values;
+    }
+    /// @}
+
+    /// @name Collection methods
+    /// @{
+
+    /// @brief read the start of a definite length array
+    /// @return the number of items
+    size_t startArray() { return size_t(head(printer::CborWriter::ARRAY)); }
+    /// @brief read the start of a definite length map
+    /// @return the number of key/value pairs
+    size_t startMap() { return size_t(head(printer::CborWriter::MAP)); }
+    /// @}
+
+  protected:
+    uint8_t peek() const
+    {
+      if (atEnd())
+        throw std::runtime_error("CBOR: unexpected end of data");
+      return uint8_t(m_buffer[m_pos]);
+    }
+
+    uint8_t next()
+    {
+      auto b = peek();
+      m_pos++;
+      return b;
+    }
+
+    std::string_view take(uint64_t size)
+    {
+      if (size > m_buffer.size() - m_pos)
+        throw std::runtime_error("CBOR: unexpected end of data");
+      auto s = m_buffer.substr(m_pos, size_t(size));
+      m_pos += size_t(size);
+      return s;
+    }
+
+    uint64_t head(MajorType type)
+    {
+      auto b = next();
+      if (MajorType(b >> 5) != type)
+        throw std::runtime_error("CBOR: unexpected major type");
+
+      uint8_t info = b & 0x1F;
+      if (info < 24)
+        return info;
+      else if (info == 24)
+        return bigEndian(1);
+      else if (info == 25)
+        return bigEndian(2);
+      else if (info == 26)
+        return bigEndian(4);
+      else if (info == 27)
+        return bigEndian(8);
+
+      throw std::runtime_error("CBOR: indefinite lengths are not supported");
+    }
+
+    uint64_t bigEndian(int bytes)
+    {
+      auto s = take(bytes);
+      uint64_t v = 0;
+      for (auto c : s)
+        v = (v << 8) | uint8_t(c);
+      return v;
+    }
+
+  protected:
+    std::string_view m_buffer;
+    size_t m_pos {0};
+  };
+}  // namespace mtconnect::parser
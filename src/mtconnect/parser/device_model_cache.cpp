@@ -0,0 +1,392 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "device_model_cache.hpp"
+
+#include <boost/uuid/name_generator_sha1.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "mtconnect/logging.hpp"
+#include "mtconnect/parser/cbor_reader.hpp"
+#include "mtconnect/printer/cbor_printer_helper.hpp"
+#include "mtconnect/version.h"
+
+using namespace std;
+
+namespace mtconnect::parser {
+  using namespace entity;
+  using namespace device_model;
+  using namespace printer;
+  namespace fs = std::filesystem;
+
+  /// @brief Identifies the file and the layout of the cache, increment if the layout changes
+  static constexpr const char *CACHE_MAGIC = "MTConnectDeviceModel";
+  static constexpr uint64_t CACHE_FORMAT = 1;
+
+  /// @brief Private tags for entities and timestamps
+  static constexpr uint64_t ENTITY_TAG = 0x4D5443;
+  static constexpr uint64_t TIMESTAMP_TAG = 0x4D5454;
+
+  string DeviceModelCache::hashFile(const fs::path &file)
+  {
+    ifstream in(file, ios::binary);
+    if (!in)
+      return "";
+
+    boost::uuids::detail::sha1 sha1;
+    char buffer[8192];
+    while (in)
+    {
+      in.read(buffer, sizeof(buffer));
+      sha1.process_bytes(buffer, size_t(in.gcount()));
+    }
+
+    // Entities are rebuilt by this version of the agent, so the version is part of the key
+    stringstream version;
+    version << CACHE_FORMAT << ':' << AGENT_VERSION_MAJOR << '.' << AGENT_VERSION_MINOR << '.'
+            << AGENT_VERSION_PATCH << '.' << AGENT_VERSION_BUILD;
+    auto v = version.str();
+    sha1.process_bytes(v.c_str(), v.length());
+
+    boost::uuids::detail::sha1::digest_type digest;
+    sha1.get_digest(digest);
+
+    stringstream hex;
+    hex << std::hex << setfill('0');
+    for (auto d : digest)
+      hex << setw(8) << d;
+
+    return hex.str();
+  }
+
+  /// @brief Writes entities with all their properties, order, and attributes
+  class CacheEncoder
+  {
+  public:
+    CacheEncoder(CborWriter &writer) : m_writer(writer) {}
+
+    void entity(const EntityPtr &entity)
+    {
+      m_writer.addTag(ENTITY_TAG);
+      m_writer.startArray(4);
+      m_writer.addString(entity->getName());
+
+      const auto &props = entity->getProperties();
+      size_t count = 0;
+      for (auto &[key, value] : props)
+      {
+        if (value.index() != EMPTY)
+          count++;
+      }
+      m_writer.startMap(count);
+      for (auto &[key, value] : props)
+      {
+        if (value.index() != EMPTY)
+        {
+          m_writer.addString(key);
+          visit(*this, value);
+        }
+      }
+
+      if (auto order = entity->getOrder())
+      {
+        m_writer.startMap(order->size());
+        for (auto &[name, pos] : *order)
+        {
+          m_writer.addString(name);
+          m_writer.addInteger(pos);
+        }
+      }
+      else
+      {
+        m_writer.addNull();
+      }
+
+      const auto &attrs = entity->getAttributes();
+      if (!attrs.empty())
+      {
+        m_writer.startArray(attrs.size());
+        for (auto &a : attrs)
+          m_writer.addString(a);
+      }
+      else
+      {
+        m_writer.addNull();
+      }
+    }
+
+    void operator()(const std::monostate &) { m_writer.addNull(); }
+    void operator()(const std::nullptr_t &) { m_writer.addNull(); }
+    void operator()(const EntityPtr &e) { entity(e); }
+    void operator()(const EntityList &list)
+    {
+      m_writer.startArray(list.size());
+      for (auto &e : list)
+        entity(e);
+    }
+    void operator()(const std::string &s) { m_writer.addString(s); }
+    void operator()(const int64_t &i) { m_writer.addInteger(i); }
+    void operator()(const double &d) { m_writer.addDouble(d); }
+    void operator()(const bool &b) { m_writer.addBool(b); }
+    void operator()(const Vector &v) { m_writer.addFloatArray(v); }
+    void operator()(const Timestamp &ts)
+    {
+      m_writer.addTag(TIMESTAMP_TAG);
+      m_writer.addTimestamp(ts);
+    }
+    void operator()(const DataSet &)
+    {
+      throw runtime_error("data sets are not supported in the device model cache");
+    }
+
+  protected:
+    CborWriter &m_writer;
+  };
+
+  /// @brief Rebuilds entities through their factories
+  class CacheDecoder
+  {
+  public:
+    CacheDecoder(CborReader &reader, ErrorList &errors) : m_reader(reader), m_errors(errors) {}
+
+    EntityPtr entity(const FactoryPtr &factory)
+    {
+      if (m_reader.readTag() != ENTITY_TAG || m_reader.startArray() != 4)
+        throw runtime_error("malformed entity");
+
+      QName qname(string(m_reader.readString()));
+      auto ef = factory->factoryFor(qname);
+      if (!ef)
+        throw runtime_error("no factory for " + qname);
+
+      Properties props;
+      for (auto count = m_reader.startMap(); count > 0; count--)
+      {
+        PropertyKey key(string(m_reader.readString()));
+        props.insert({key, value(ef)});
+      }
+
+      OrderMapPtr order;
+      if (!m_reader.readNull())
+      {
+        order = make_shared<OrderMap>();
+        for (auto count = m_reader.startMap(); count > 0; count--)
+        {
+          string name(m_reader.readString());
+          order->emplace(name, int(m_reader.readInteger()));
+        }
+      }
+
+      AttributeSet attrs;
+      if (!m_reader.readNull())
+      {
+        for (auto count = m_reader.startArray(); count > 0; count--)
+          attrs.emplace(string(m_reader.readString()));
+      }
+
+      auto entity = ef->make(qname, props, m_errors);
+      if (!entity)
+        throw runtime_error("cannot create " + qname);
+      if (order)
+        entity->setOrder(order);
+      if (!attrs.empty())
+        entity->setAttributes(attrs);
+
+      return entity;
+    }
+
+    Value value(const FactoryPtr &factory)
+    {
+      switch (m_reader.peekType())
+      {
+        case CborWriter::TEXT:
+          return string(m_reader.readString());
+
+        case CborWriter::UNSIGNED:
+        case CborWriter::NEGATIVE:
+          return m_reader.readInteger();
+
+        case CborWriter::ARRAY:
+        {
+          EntityList list;
+          for (auto count = m_reader.startArray(); count > 0; count--)
+            list.emplace_back(entity(factory));
+          return list;
+        }
+
+        case CborWriter::TAG:
+        {
+          auto tag = m_reader.peekTag();
+          if (tag == ENTITY_TAG)
+            return entity(factory);
+          if (tag == TIMESTAMP_TAG)
+          {
+            m_reader.readTag();
+            return m_reader.readTimestamp();
+          }
+          return m_reader.readFloatArray();
+        }
+
+        case CborWriter::SIMPLE:
+          if (m_reader.readNull())
+            return nullptr;
+          if (m_reader.isBool())
+            return m_reader.readBool();
+          return m_reader.readDouble();
+
+        default:
+          throw runtime_error("unexpected value");
+      }
+    }
+
+  protected:
+    CborReader &m_reader;
+    ErrorList &m_errors;
+  };
+
+  optional<DeviceModelCache::Model> DeviceModelCache::load(const string &hash) const
+  {
+    NAMED_SCOPE("DeviceModelCache::load");
+
+    ifstream in(m_path, ios::binary);
+    if (!in)
+      return nullopt;
+
+    string buffer((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+
+    try
+    {
+      CborReader reader(buffer);
+      if (reader.startArray() != 5 || reader.readString() != CACHE_MAGIC)
+      {
+        LOG(warning) << "Device model cache " << m_path << " is not a device model cache";
+        return nullopt;
+      }
+
+      if (reader.readString() != hash)
+      {
+        LOG(info) << "Device model cache " << m_path << " is out of date";
+        return nullopt;
+      }
+
+      Model model;
+      if (!reader.readNull())
+        model.m_schemaVersion.emplace(reader.readString());
+
+      for (auto count = reader.startArray(); count > 0; count--)
+      {
+        if (reader.startArray() != 3)
+          throw runtime_error("malformed namespace");
+        XmlParser::Namespace ns;
+        ns.m_urn = reader.readString();
+        ns.m_location = reader.readString();
+        ns.m_prefix = reader.readString();
+        model.m_namespaces.emplace_back(ns);
+      }
+
+      ErrorList errors;
+      CacheDecoder decoder(reader, errors);
+      auto root = Device::getRoot();
+      for (auto count = reader.startArray(); count > 0; count--)
+      {
+        auto device = dynamic_pointer_cast<Device>(decoder.entity(root));
+        if (!device)
+          throw runtime_error("top level entity is not a device");
+        model.m_devices.emplace_back(device);
+      }
+
+      if (!errors.empty())
+      {
+        for (auto &e : errors)
+          LOG(warning) << "Device model cache " << m_path << ": " << e->what();
+        return nullopt;
+      }
+
+      return model;
+    }
+    catch (exception &e)
+    {
+      LOG(warning) << "Cannot load device model cache " << m_path << ": " << e.what();
+    }
+
+    return nullopt;
+  }
+
+  bool DeviceModelCache::save(const string &hash, const Model &model) const
+  {
+    NAMED_SCOPE("DeviceModelCache::save");
+
+    string buffer;
+    try
+    {
+      CborWriter writer(buffer);
+      writer.startArray(5);
+      writer.addString(CACHE_MAGIC);
+      writer.addString(hash);
+      if (model.m_schemaVersion)
+        writer.addString(*model.m_schemaVersion);
+      else
+        writer.addNull();
+
+      writer.startArray(model.m_namespaces.size());
+      for (auto &ns : model.m_namespaces)
+      {
+        writer.startArray(3);
+        writer.addString(ns.m_urn);
+        writer.addString(ns.m_location);
+        writer.addString(ns.m_prefix);
+      }
+
+      CacheEncoder encoder(writer);
+      writer.startArray(model.m_devices.size());
+      for (auto &device : model.m_devices)
+        encoder.entity(device);
+    }
+    catch (exception &e)
+    {
+      LOG(warning) << "Cannot cache the device model: " << e.what();
+      return false;
+    }
+
+    // Write to a temporary file and rename so a partial cache is never read
+    auto temp = m_path;
+    temp += ".tmp";
+    {
+      ofstream out(temp, ios::binary | ios::trunc);
+      out.write(buffer.data(), streamsize(buffer.size()));
+      if (!out)
+      {
+        LOG(warning) << "Cannot write device model cache " << temp;
+        return false;
+      }
+    }
+
+    error_code ec;
+    fs::rename(temp, m_path, ec);
+    if (ec)
+    {
+      LOG(warning) << "Cannot write device model cache " << m_path << ": " << ec.message();
+      fs::remove(temp, ec);
+      return false;
+    }
+
+    return true;
+  }
+}  // namespace mtconnect::parser
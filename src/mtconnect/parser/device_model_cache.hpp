@@ -0,0 +1,72 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <filesystem>
+#include <list>
+#include <optional>
+#include <string>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/device_model/device.hpp"
+#include "mtconnect/parser/xml_parser.hpp"
+
+namespace mtconnect::parser {
+  /// @brief Binary snapshot of the parsed device model
+  ///
+  /// The devices are saved as CBOR immediately after they are parsed, before the agent adds its
+  /// own data items or ids. The snapshot is keyed by a hash of the devices file and the agent
+  /// version, so any change to either invalidates it. Loading rebuilds the entities through the
+  /// same factories as the XML parser, which skips the XML parsing but keeps the validation.
+  class AGENT_LIB_API DeviceModelCache
+  {
+  public:
+    /// @brief The cached device model
+    struct Model
+    {
+      std::optional<std::string> m_schemaVersion;
+      std::list<XmlParser::Namespace> m_namespaces;
+      std::list<device_model::DevicePtr> m_devices;
+    };
+
+    /// @brief Create a cache stored in a file
+    /// @param[in] path the cache file
+    DeviceModelCache(const std::filesystem::path &path) : m_path(path) {}
+
+    /// @brief hash the contents of a devices file
+    /// @param[in] file the devices file
+    /// @return the hash or an empty string if the file cannot be read
+    static std::string hashFile(const std::filesystem::path &file);
+
+    /// @brief load the model if the cache matches the hash
+    /// @param[in] hash the hash of the devices file
+    /// @return the model if the cache is present, current, and valid
+    std::optional<Model> load(const std::string &hash) const;
+    /// @brief save the model to the cache file
+    /// @param[in] hash the hash of the devices file
+    /// @param[in] model the model to save
+    /// @return `true` if the model was saved
+    bool save(const std::string &hash, const Model &model) const;
+
+    /// @brief get the path of the cache file
+    const auto &getPath() const { return m_path; }
+
+  protected:
+    std::filesystem::path m_path;
+  };
+}  // namespace mtconnect::parser
@@ -26,7 +26,11 @@
 #include <boost/range/metafunctions.hpp>
 #include <boost/range/numeric.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include <libxml/parser.h>
 #include <libxml/xpath.h>
@@ -106,6 +110,7 @@ namespace mtconnect::parser {
       xmlFreeDoc(m_doc);
       m_doc = nullptr;
     }
+    m_namespaces.clear();
 
     xmlXPathContextPtr xpathCtx = nullptr;
     xmlXPathObjectPtr devices = nullptr;
@@ -163,6 +168,7 @@ namespace mtconnect::parser {
             prefix = (const char *)ns->prefix;
 
           aPrinter->addDevicesNamespace(locationUrn, uri, prefix);
+          m_namespaces.push_back({locationUrn, uri, prefix});
         }
       }
 
@@ -182,6 +188,7 @@ namespace mtconnect::parser {
             string urn = (const char *)ns->href;
             string prefix = (const char *)ns->prefix;
             aPrinter->addDevicesNamespace(urn, "", prefix);
+            m_namespaces.push_back({urn, "", prefix});
           }
 
           ns = ns->next;
@@ -197,20 +204,50 @@ namespace mtconnect::parser {
       else
       {
         xmlNodeSetPtr nodeset = devices->nodesetval;
+        size_t count = size_t(nodeset->nodeNr);
+
+        // Each device subtree is independent, so the devices are built concurrently from the
+        // read only document. The results are collected by index to keep the file order.
+        auto root = Device::getRoot();
+        vector<entity::EntityPtr> results(count);
+        vector<entity::ErrorList> errors(count);
+        vector<exception_ptr> failures(count);
+        atomic<size_t> next {0};
+        auto work = [&]() {
+          for (size_t i = next++; i < count; i = next++)
+          {
+            try
+            {
+              results[i] = entity::XmlParser::parseXmlNode(root, nodeset->nodeTab[i], errors[i]);
+            }
+            catch (...)
+            {
+              failures[i] = current_exception();
+            }
+          }
+        };
 
-        entity::ErrorList errors;
-        for (int i = 0; i != nodeset->nodeNr; ++i)
+        size_t workers = min<size_t>(count, max(1u, thread::hardware_concurrency()));
+        vector<thread> threads;
+        for (size_t i = 1; i < workers; i++)
+          threads.emplace_back(work);
+        work();
+        for (auto &t : threads)
+          t.join();
+
+        for (auto &f : failures)
         {
-          auto device =
-              entity::XmlParser::parseXmlNode(Device::getRoot(), nodeset->nodeTab[i], errors);
-          if (device)
-            deviceList.emplace_back(dynamic_pointer_cast<Device>(device));
+          if (f)
+            rethrow_exception(f);
+        }
 
-          if (!errors.empty())
-          {
-            for (auto &e : errors)
-              LOG(warning) << "Error parsing device: " << e->what();
-          }
+        for (size_t i = 0; i < count; i++)
+        {
+          if (results[i])
+            deviceList.emplace_back(dynamic_pointer_cast<Device>(results[i]));
+
+          for (auto &e : errors[i])
+            LOG(warning) << "Error parsing device: " << e->what();
         }
       }
 
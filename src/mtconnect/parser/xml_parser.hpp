@@ -41,12 +41,23 @@ namespace mtconnect::parser {
   class AGENT_LIB_API XmlParser
   {
   public:
+    /// @brief An additional namespace referenced by the devices file
+    struct Namespace
+    {
+      std::string m_urn;
+      std::string m_location;
+      std::string m_prefix;
+    };
+
     /// @brief Constructor to set the open the correct file
     XmlParser();
 
     virtual ~XmlParser();
 
     /// @brief Parses a file and returns a list of devices
+    ///
+    /// The devices are built from the document in parallel, one device per task.
+    ///
     /// @param[in] aPath to the file
     /// @param[in] aPrinter the printer to obtain and set namespaces
     /// @returns a list of device pointers
@@ -70,11 +81,15 @@ namespace mtconnect::parser {
     /// @brief get the schema version
     /// @return the version
     const auto &getSchemaVersion() const { return m_schemaVersion; }
+    /// @brief get the additional namespaces added to the printer by the last `parseFile()`
+    /// @return the list of namespaces
+    const auto &getNamespaces() const { return m_namespaces; }
 
   protected:
     // LibXML XML Doc
     xmlDocPtr m_doc = nullptr;
     std::optional<std::string> m_schemaVersion;
+    std::list<Namespace> m_namespaces;
     mutable std::shared_mutex m_mutex;
   };
 }  // namespace mtconnect::parser
@@ -22,6 +22,7 @@
 #include "mtconnect/config.hpp"
 #include "pipeline_context.hpp"
 #include "pipeline_contract.hpp"
+#include "pipeline_profiler.hpp"
 #include "transform.hpp"
 
 namespace mtconnect {
@@ -61,7 +62,12 @@ namespace mtconnect {
         : m_start(std::make_shared<Start>()), m_context(context), m_strand(st)
       {}
       /// @brief Destructor stops the pipeline
-      virtual ~Pipeline() { m_start->stop(); }
+      virtual ~Pipeline()
+      {
+        m_start->stop();
+        if (m_context && m_context->m_profiler)
+          m_context->m_profiler->detach(this);
+      }
       /// @brief Build the pipeline
       /// @param options A set of configuration options
       virtual void build(const ConfigOptions &options) = 0;
@@ -71,6 +77,9 @@ namespace mtconnect {
       /// @brief Get a reference to the strand
       /// @return the strand
       boost::asio::io_context::strand &getStrand() { return m_strand; }
+      /// @brief Get the identity of the pipeline for profiling
+      /// @return the identity
+      virtual std::string getIdentity() const { return "Pipeline"; }
 
       /// @brief Apply the splices after rebuilding
       void applySplices()
@@ -114,6 +123,8 @@ namespace mtconnect {
       {
         if (m_start)
         {
+          if (m_context && m_context->m_profiler)
+            m_context->m_profiler->attach(this, getIdentity(), m_start);
           m_start->start(m_strand);
           m_started = true;
         }
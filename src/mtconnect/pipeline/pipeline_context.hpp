@@ -43,6 +43,7 @@ namespace mtconnect::pipeline {
     virtual ~TransformState() {}
   };
   using TransformStatePtr = std::shared_ptr<TransformState>;
+  class PipelineProfiler;
 
   /// @brief Manages shared state across multiple pipelines
   ///
@@ -69,6 +70,9 @@ namespace mtconnect::pipeline {
     /// @brief A pipeline contract that can be used by the shared state.
     std::unique_ptr<PipelineContract> m_contract;
 
+    /// @brief Collects transform profiles when pipeline profiling is enabled, `nullptr` otherwise
+    std::shared_ptr<PipelineProfiler> m_profiler;
+
   protected:
     using SharedState = std::unordered_map<std::string, TransformStatePtr>;
     SharedState m_sharedState;
@@ -0,0 +1,160 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "pipeline_profiler.hpp"
+
+#include <set>
+
+#include "mtconnect/printer/json_printer_helper.hpp"
+
+using namespace std;
+
+namespace mtconnect::pipeline {
+  using namespace std::chrono;
+
+  namespace {
+    /// @brief time accounting for the transform currently running on this thread
+    struct ProfileFrame
+    {
+      nanoseconds m_children {0};
+      bool m_forwarded {false};
+    };
+    thread_local ProfileFrame s_frame;
+  }  // namespace
+
+  entity::EntityPtr Transform::profiled(entity::EntityPtr &&entity)
+  {
+    auto outer = s_frame;
+    s_frame = ProfileFrame();
+
+    auto start = steady_clock::now();
+    entity::EntityPtr res;
+    try
+    {
+      res = (*this)(std::move(entity));
+    }
+    catch (...)
+    {
+      auto elapsed = steady_clock::now() - start;
+      m_profile->record(elapsed - s_frame.m_children, true);
+      s_frame = ProfileFrame {outer.m_children + elapsed, true};
+      throw;
+    }
+
+    auto elapsed = steady_clock::now() - start;
+    m_profile->record(elapsed - s_frame.m_children, !res && !s_frame.m_forwarded);
+    s_frame = ProfileFrame {outer.m_children + elapsed, true};
+
+    return res;
+  }
+
+  nanoseconds TransformProfile::getPercentile(double p) const
+  {
+    auto calls = getCalls();
+    if (calls == 0)
+      return nanoseconds(0);
+
+    uint64_t target = uint64_t(calls * p / 100.0 + 0.5);
+    if (target == 0)
+      target = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; i++)
+    {
+      seen += m_buckets[i].load(std::memory_order_relaxed);
+      if (seen >= target)
+        return min(nanoseconds(uint64_t(1) << i), getMax());
+    }
+
+    return getMax();
+  }
+
+  static void profileTransforms(TransformPtr transform, set<Transform *> &seen,
+                                PipelineProfiler::TransformProfiles &profiles)
+  {
+    for (auto &t : transform->getNext())
+    {
+      if (seen.insert(t.get()).second)
+      {
+        if (!t->getProfile())
+          t->setProfile(make_shared<TransformProfile>());
+        profiles.emplace_back(t->getName(), t->getProfile());
+        profileTransforms(t, seen, profiles);
+      }
+    }
+  }
+
+  void PipelineProfiler::attach(const Pipeline *pipeline, const std::string &identity,
+                                TransformPtr start)
+  {
+    TransformProfiles profiles;
+    set<Transform *> seen;
+    profileTransforms(start, seen, profiles);
+
+    lock_guard<mutex> lock(m_mutex);
+    m_pipelines.insert_or_assign(pipeline, make_pair(identity, std::move(profiles)));
+  }
+
+  void PipelineProfiler::detach(const Pipeline *pipeline)
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_pipelines.erase(pipeline);
+  }
+
+  std::list<std::pair<std::string, PipelineProfiler::TransformProfiles>>
+  PipelineProfiler::getProfiles() const
+  {
+    lock_guard<mutex> lock(m_mutex);
+    std::list<std::pair<std::string, TransformProfiles>> res;
+    for (auto &[pipeline, profiles] : m_pipelines)
+      res.emplace_back(profiles);
+    res.sort([](const auto &a, const auto &b) { return a.first < b.first; });
+    return res;
+  }
+
+  std::string PipelineProfiler::toJson(bool pretty) const
+  {
+    using namespace printer;
+    auto pipelines = getProfiles();
+
+    auto micros = [](nanoseconds ns) { return duration<double, micro>(ns).count(); };
+
+    rapidjson::StringBuffer output;
+    RenderJson(output, pretty, [&](auto &writer) {
+      AutoJsonObject obj(writer);
+      AutoJsonArray ary(writer, "Pipelines");
+      for (auto &[identity, profiles] : pipelines)
+      {
+        AutoJsonObject pipe(writer);
+        pipe.AddPairs("identity", identity);
+        AutoJsonArray transforms(writer, "Transforms");
+        for (auto &[name, profile] : profiles)
+        {
+          AutoJsonObject t(writer);
+          auto calls = profile->getCalls();
+          t.AddPairs("name", name, "calls", calls, "dropped", profile->getDropped(), "totalUs",
+                     micros(profile->getTotal()), "meanUs",
+                     calls > 0 ? micros(profile->getTotal()) / double(calls) : 0.0, "p50Us",
+                     micros(profile->getPercentile(50.0)), "p99Us",
+                     micros(profile->getPercentile(99.0)), "maxUs", micros(profile->getMax()));
+        }
+      }
+    });
+
+    return string(output.GetString(), output.GetLength());
+  }
+}  // namespace mtconnect::pipeline
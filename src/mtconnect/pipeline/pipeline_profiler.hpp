@@ -0,0 +1,137 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <map>
+#include <mutex>
+
+#include "mtconnect/config.hpp"
+#include "transform.hpp"
+
+namespace mtconnect::pipeline {
+  class Pipeline;
+
+  /// @brief Call counts and a latency histogram for one transform
+  ///
+  /// Only the time spent in the transform itself is recorded, the time spent in the transforms
+  /// it forwards to is subtracted. The histogram has power of two nanosecond buckets, so
+  /// percentiles are accurate to within a factor of two.
+  class AGENT_LIB_API TransformProfile
+  {
+  public:
+    /// @brief number of histogram buckets, the last covers everything over 2^38ns (~4.5 min)
+    static constexpr size_t BUCKETS = 40;
+
+    /// @brief record one call of the transform
+    /// @param[in] time the time spent in the transform
+    /// @param[in] dropped `true` if the transform did not forward the entity
+    void record(std::chrono::nanoseconds time, bool dropped)
+    {
+      uint64_t ns = time.count() > 0 ? uint64_t(time.count()) : 0;
+      m_calls.fetch_add(1, std::memory_order_relaxed);
+      if (dropped)
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+      m_total.fetch_add(ns, std::memory_order_relaxed);
+      m_buckets[bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+
+      auto max = m_max.load(std::memory_order_relaxed);
+      while (ns > max && !m_max.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+        ;
+    }
+
+    /// @brief get the number of calls
+    uint64_t getCalls() const { return m_calls.load(std::memory_order_relaxed); }
+    /// @brief get the number of entities the transform did not forward
+    uint64_t getDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    /// @brief get the total time spent in the transform
+    std::chrono::nanoseconds getTotal() const
+    {
+      return std::chrono::nanoseconds(m_total.load(std::memory_order_relaxed));
+    }
+    /// @brief get the longest call
+    std::chrono::nanoseconds getMax() const
+    {
+      return std::chrono::nanoseconds(m_max.load(std::memory_order_relaxed));
+    }
+    /// @brief get an upper bound for a percentile of the call times
+    /// @param[in] p the percentile from 0 to 100
+    /// @return the upper bound of the bucket containing the percentile
+    std::chrono::nanoseconds getPercentile(double p) const;
+
+    /// @brief get the histogram bucket for a time
+    /// @param[in] ns time in nanoseconds
+    /// @return the bucket index, bucket `i` holds times less than 2^i ns
+    static size_t bucket(uint64_t ns)
+    {
+      size_t b = 0;
+      while (ns > 0 && b < BUCKETS - 1)
+      {
+        ns >>= 1;
+        b++;
+      }
+      return b;
+    }
+
+  protected:
+    std::atomic<uint64_t> m_calls {0};
+    std::atomic<uint64_t> m_dropped {0};
+    std::atomic<uint64_t> m_total {0};
+    std::atomic<uint64_t> m_max {0};
+    std::array<std::atomic<uint64_t>, BUCKETS> m_buckets {};
+  };
+
+  /// @brief Collects the transform profiles for all the pipelines sharing a pipeline context
+  ///
+  /// Profiling is enabled by setting the `m_profiler` of the `PipelineContext`. When a pipeline
+  /// starts, every transform gets a profile and `Transform::next()` times the calls. Without a
+  /// profiler the only cost is a null check per transform.
+  class AGENT_LIB_API PipelineProfiler
+  {
+  public:
+    using TransformProfiles = std::list<std::pair<std::string, TransformProfilePtr>>;
+
+    /// @brief add profiles to all transforms of a pipeline
+    ///
+    /// Replaces the profiles of the pipeline if it was rebuilt.
+    ///
+    /// @param[in] pipeline the pipeline
+    /// @param[in] identity the name reported for the pipeline
+    /// @param[in] start the first transform of the pipeline
+    void attach(const Pipeline *pipeline, const std::string &identity, TransformPtr start);
+    /// @brief remove a pipeline
+    /// @param[in] pipeline the pipeline
+    void detach(const Pipeline *pipeline);
+
+    /// @brief get the profiles of all the pipelines
+    /// @return the profiles of the transforms in pipeline order by pipeline identity
+    std::list<std::pair<std::string, TransformProfiles>> getProfiles() const;
+
+    /// @brief create a json document of the profiles
+    /// @param[in] pretty `true` to pretty print the json
+    /// @return the json text
+    std::string toJson(bool pretty = false) const;
+
+  protected:
+    mutable std::mutex m_mutex;
+    std::map<const Pipeline *, std::pair<std::string, TransformProfiles>> m_pipelines;
+  };
+}  // namespace mtconnect::pipeline
@@ -0,0 +1,554 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "rule_transform.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "mtconnect/device_model/device.hpp"
+#include "mtconnect/logging.hpp"
+#include "mtconnect/utilities.hpp"
+
+using namespace std;
+
+namespace mtconnect::pipeline {
+  using namespace observation;
+  using Result = RuleExpression::Result;
+  using NodePtr = RuleExpression::NodePtr;
+
+  bool RuleExpression::truthy(const Result &result)
+  {
+    if (auto b = get_if<bool>(&result))
+      return *b;
+    if (auto d = get_if<double>(&result))
+      return *d != 0.0;
+    if (auto s = get_if<string>(&result))
+      return !s->empty();
+    return false;
+  }
+
+  bool RuleExpression::toNumber(const Result &result, double &value)
+  {
+    if (auto d = get_if<double>(&result))
+    {
+      value = *d;
+      return true;
+    }
+    if (auto s = get_if<string>(&result); s && !s->empty())
+    {
+      auto last = s->data() + s->size();
+      return parseDouble(s->data(), last, value) == last;
+    }
+    return false;
+  }
+
+  string RuleExpression::toString(const Result &result)
+  {
+    if (auto s = get_if<string>(&result))
+      return *s;
+    if (auto d = get_if<double>(&result))
+      return format(*d);
+    if (auto b = get_if<bool>(&result))
+      return *b ? "true" : "false";
+    return "";
+  }
+
+  namespace {
+    struct Constant : RuleExpression::Node
+    {
+      Constant(Result value) : m_value(std::move(value)) {}
+      Result evaluate(const Observation &) const override { return m_value; }
+      Result m_value;
+    };
+
+    struct Property : RuleExpression::Node
+    {
+      Property(string name) : m_name(std::move(name)) {}
+      Result evaluate(const Observation &obs) const override
+      {
+        auto &value = obs.getProperty(m_name);
+        if (auto s = get_if<string>(&value))
+          return *s;
+        if (auto d = get_if<double>(&value))
+          return *d;
+        if (auto i = get_if<int64_t>(&value))
+          return double(*i);
+        if (auto b = get_if<bool>(&value))
+          return *b;
+        return monostate();
+      }
+      string m_name;
+    };
+
+    struct Not : RuleExpression::Node
+    {
+      Not(NodePtr &&operand) : m_operand(std::move(operand)) {}
+      Result evaluate(const Observation &obs) const override
+      {
+        return !RuleExpression::truthy(m_operand->evaluate(obs));
+      }
+      NodePtr m_operand;
+    };
+
+    struct Negate : RuleExpression::Node
+    {
+      Negate(NodePtr &&operand) : m_operand(std::move(operand)) {}
+      Result evaluate(const Observation &obs) const override
+      {
+        double v;
+        if (RuleExpression::toNumber(m_operand->evaluate(obs), v))
+          return -v;
+        return monostate();
+      }
+      NodePtr m_operand;
+    };
+
+    enum class Op
+    {
+      AND,
+      OR,
+      EQ,
+      NE,
+      LT,
+      LE,
+      GT,
+      GE,
+      ADD,
+      SUB,
+      MUL,
+      DIV
+    };
+
+    struct Binary : RuleExpression::Node
+    {
+      Binary(Op op, NodePtr &&left, NodePtr &&right)
+        : m_op(op), m_left(std::move(left)), m_right(std::move(right))
+      {}
+
+      static bool equal(const Result &l, const Result &r)
+      {
+        double ln, rn;
+        if (RuleExpression::toNumber(l, ln) && RuleExpression::toNumber(r, rn))
+          return ln == rn;
+        if (holds_alternative<string>(l) || holds_alternative<string>(r))
+          return (holds_alternative<monostate>(l) || holds_alternative<monostate>(r))
+                     ? false
+                     : RuleExpression::toString(l) == RuleExpression::toString(r);
+        return l == r;
+      }
+
+      static optional<int> compare(const Result &l, const Result &r)
+      {
+        double ln, rn;
+        if (RuleExpression::toNumber(l, ln) && RuleExpression::toNumber(r, rn))
+          return ln < rn ? -1 : (ln > rn ? 1 : 0);
+        auto ls = get_if<string>(&l), rs = get_if<string>(&r);
+        if (ls && rs)
+          return ls->compare(*rs);
+        return nullopt;
+      }
+
+      Result evaluate(const Observation &obs) const override
+      {
+        // Short circuit the logical operators
+        if (m_op == Op::AND)
+          return RuleExpression::truthy(m_left->evaluate(obs)) &&
+                 RuleExpression::truthy(m_right->evaluate(obs));
+        if (m_op == Op::OR)
+          return RuleExpression::truthy(m_left->evaluate(obs)) ||
+                 RuleExpression::truthy(m_right->evaluate(obs));
+
+        auto l = m_left->evaluate(obs);
+        auto r = m_right->evaluate(obs);
+        switch (m_op)
+        {
+          case Op::EQ:
+            return equal(l, r);
+
+          case Op::NE:
+            return !equal(l, r);
+
+          case Op::LT:
+          case Op::LE:
+          case Op::GT:
+          case Op::GE:
+          {
+            auto c = compare(l, r);
+            if (!c)
+              return false;
+            switch (m_op)
+            {
+              case Op::LT:
+                return *c < 0;
+              case Op::LE:
+                return *c <= 0;
+              case Op::GT:
+                return *c > 0;
+              default:
+                return *c >= 0;
+            }
+          }
+
+          default:
+            break;
+        }
+
+        double ln, rn;
+        if (!RuleExpression::toNumber(l, ln) || !RuleExpression::toNumber(r, rn))
+        {
+          // Concatenate if either side is not a number
+          if (m_op == Op::ADD && !holds_alternative<monostate>(l) &&
+              !holds_alternative<monostate>(r))
+            return RuleExpression::toString(l) + RuleExpression::toString(r);
+          return monostate();
+        }
+
+        switch (m_op)
+        {
+          case Op::ADD:
+            return ln + rn;
+          case Op::SUB:
+            return ln - rn;
+          case Op::MUL:
+            return ln * rn;
+          case Op::DIV:
+            if (rn == 0.0)
+              return monostate();
+            return ln / rn;
+          default:
+            return monostate();
+        }
+      }
+
+      Op m_op;
+      NodePtr m_left;
+      NodePtr m_right;
+    };
+
+    /// @brief Recursive descent parser for rule expressions
+    class Parser
+    {
+    public:
+      Parser(const string &text) : m_text(text) {}
+
+      NodePtr parse()
+      {
+        auto node = parseOr();
+        skipSpace();
+        if (m_pos != m_text.size())
+          error("unexpected text");
+        return node;
+      }
+
+    protected:
+      [[noreturn]] void error(const string &message)
+      {
+        throw invalid_argument(message + " at position " + to_string(m_pos) + " in: " + m_text);
+      }
+
+      void skipSpace()
+      {
+        while (m_pos < m_text.size() && isspace((unsigned char)m_text[m_pos]))
+          m_pos++;
+      }
+
+      bool match(const char *token)
+      {
+        skipSpace();
+        auto len = strlen(token);
+        if (m_text.compare(m_pos, len, token) != 0)
+          return false;
+
+        // Keywords must not be followed by an identifier character
+        if (isalpha((unsigned char)token[0]) && m_pos + len < m_text.size() &&
+            (isalnum((unsigned char)m_text[m_pos + len]) || m_text[m_pos + len] == '_'))
+          return false;
+
+        m_pos += len;
+        return true;
+      }
+
+      NodePtr parseOr()
+      {
+        auto left = parseAnd();
+        while (match("||") || match("or"))
+          left = make_unique<Binary>(Op::OR, std::move(left), parseAnd());
+        return left;
+      }
+
+      NodePtr parseAnd()
+      {
+        auto left = parseComparison();
+        while (match("&&") || match("and"))
+          left = make_unique<Binary>(Op::AND, std::move(left), parseComparison());
+        return left;
+      }
+
+      NodePtr parseComparison()
+      {
+        auto left = parseSum();
+        static const pair<const char *, Op> ops[] = {{"==", Op::EQ}, {"!=", Op::NE},
+                                                     {"<=", Op::LE}, {">=", Op::GE},
+                                                     {"<", Op::LT},  {">", Op::GT}};
+        for (auto &[token, op] : ops)
+        {
+          if (match(token))
+            return make_unique<Binary>(op, std::move(left), parseSum());
+        }
+        return left;
+      }
+
+      NodePtr parseSum()
+      {
+        auto left = parseProduct();
+        while (true)
+        {
+          if (match("+"))
+            left = make_unique<Binary>(Op::ADD, std::move(left), parseProduct());
+          else if (match("-"))
+            left = make_unique<Binary>(Op::SUB, std::move(left), parseProduct());
+          else
+            return left;
+        }
+      }
+
+      NodePtr parseProduct()
+      {
+        auto left = parseUnary();
+        while (true)
+        {
+          if (match("*"))
+            left = make_unique<Binary>(Op::MUL, std::move(left), parseUnary());
+          else if (match("/"))
+            left = make_unique<Binary>(Op::DIV, std::move(left), parseUnary());
+          else
+            return left;
+        }
+      }
+
+      NodePtr parseUnary()
+      {
+        if (match("!") || match("not"))
+          return make_unique<Not>(parseUnary());
+        if (match("-"))
+          return make_unique<Negate>(parseUnary());
+        return parsePrimary();
+      }
+
+      NodePtr parsePrimary()
+      {
+        skipSpace();
+        if (m_pos >= m_text.size())
+          error("unexpected end of expression");
+
+        char c = m_text[m_pos];
+        if (c == '(')
+        {
+          m_pos++;
+          auto node = parseOr();
+          if (!match(")"))
+            error("expected )");
+          return node;
+        }
+
+        if (c == '"' || c == '\'')
+        {
+          auto end = m_text.find(c, m_pos + 1);
+          if (end == string::npos)
+            error("unterminated string");
+          string value = m_text.substr(m_pos + 1, end - m_pos - 1);
+          m_pos = end + 1;
+          return make_unique<Constant>(value);
+        }
+
+        if (isdigit((unsigned char)c) || c == '.')
+        {
+          double value;
+          auto first = m_text.c_str() + m_pos;
+          char *end = nullptr;
+          value = strtod(first, &end);
+          if (end == first)
+            error("invalid number");
+          m_pos += end - first;
+          return make_unique<Constant>(value);
+        }
+
+        if (isalpha((unsigned char)c) || c == '_')
+        {
+          auto start = m_pos;
+          while (m_pos < m_text.size() &&
+                 (isalnum((unsigned char)m_text[m_pos]) || m_text[m_pos] == '_'))
+            m_pos++;
+          auto name = m_text.substr(start, m_pos - start);
+          if (name == "true")
+            return make_unique<Constant>(true);
+          if (name == "false")
+            return make_unique<Constant>(false);
+          if (name == "value")
+            return make_unique<Property>("VALUE");
+
+          // Upper case words are controlled vocabulary values like READY or UNAVAILABLE,
+          // property names are camel case
+          if (all_of(name.begin(), name.end(), [](char c) {
+                return isupper((unsigned char)c) || isdigit((unsigned char)c) || c == '_';
+              }))
+            return make_unique<Constant>(name);
+          return make_unique<Property>(name);
+        }
+
+        error("unexpected character");
+      }
+
+    protected:
+      const string &m_text;
+      size_t m_pos {0};
+    };
+
+    inline bool matches(const Rule &rule, const device_model::data_item::DataItem &di)
+    {
+      if (rule.m_dataItem && di.getId() != *rule.m_dataItem &&
+          (!di.getName() || *di.getName() != *rule.m_dataItem))
+        return false;
+      if (rule.m_type && di.get<string>("type") != *rule.m_type)
+        return false;
+      return true;
+    }
+
+    /// @brief get the value of the observation as a map key
+    inline string valueKey(const Observation &obs)
+    {
+      const auto &value = obs.getValue();
+      if (auto s = get_if<string>(&value))
+        return *s;
+      if (auto d = get_if<double>(&value))
+        return format(*d);
+      if (auto i = get_if<int64_t>(&value))
+        return to_string(*i);
+      return "";
+    }
+
+    /// @brief set a new value keeping the value type of the observation
+    inline void assign(Observation &obs, const Result &result)
+    {
+      if (holds_alternative<monostate>(result))
+        return;
+
+      if (auto s = get_if<string>(&result); s && *s == "UNAVAILABLE")
+      {
+        obs.makeUnavailable();
+        return;
+      }
+
+      double number;
+      const auto &current = obs.getValue();
+      if (holds_alternative<double>(current))
+      {
+        if (RuleExpression::toNumber(result, number))
+          obs.setValue(number);
+      }
+      else if (holds_alternative<int64_t>(current))
+      {
+        if (RuleExpression::toNumber(result, number))
+          obs.setValue(int64_t(llround(number)));
+      }
+      else if (holds_alternative<string>(current))
+      {
+        obs.setValue(RuleExpression::toString(result));
+      }
+    }
+  }  // namespace
+
+  std::shared_ptr<RuleExpression> RuleExpression::compile(const std::string &text)
+  {
+    auto expression = make_shared<RuleExpression>();
+    expression->m_text = text;
+    expression->m_root = Parser(expression->m_text).parse();
+    return expression;
+  }
+
+  entity::EntityPtr RuleTransform::operator()(entity::EntityPtr &&entity)
+  {
+    auto obs = std::dynamic_pointer_cast<Observation>(entity);
+    if (!obs || obs->isOrphan())
+      return next(std::move(entity));
+
+    auto di = obs->getDataItem();
+    bool copied = false;
+    for (auto &rule : m_rules)
+    {
+      if (!matches(*rule, *di) || (rule->m_when && !rule->m_when->test(*obs)))
+        continue;
+
+      if (rule->m_drop)
+        return entity::EntityPtr();
+
+      // Observations may be shared, so change a copy
+      if (!copied)
+      {
+        obs = obs->copy();
+        copied = true;
+      }
+
+      if (!obs->isUnavailable())
+      {
+        if (!rule->m_map.empty())
+        {
+          auto mapped = rule->m_map.find(valueKey(*obs));
+          if (mapped != rule->m_map.end())
+            assign(*obs, mapped->second);
+        }
+
+        if (rule->m_value)
+          assign(*obs, rule->m_value->evaluate(*obs));
+      }
+
+      if (rule->m_rename)
+      {
+        auto device = di->getComponent() ? di->getComponent()->getDevice() : nullptr;
+        auto target = m_contract->findDataItem(
+            device && device->getUuid() ? *device->getUuid() : "", *rule->m_rename);
+        if (!target)
+        {
+          LOG(warning) << "Rule " << rule->m_name << ": cannot find data item "
+                       << *rule->m_rename;
+        }
+        else if (target->getCategory() != di->getCategory())
+        {
+          LOG(warning) << "Rule " << rule->m_name << ": " << *rule->m_rename
+                       << " has a different category than " << di->getId();
+        }
+        else
+        {
+          for (auto &prop : di->getObservationProperties())
+            obs->erase(prop.first);
+          obs->setDataItem(target);
+          obs->setEntityName();
+          di = target;
+        }
+      }
+    }
+
+    if (copied)
+      return next(obs);
+    else
+      return next(std::move(entity));
+  }
+}  // namespace mtconnect::pipeline
@@ -0,0 +1,137 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/observation/observation.hpp"
+#include "transform.hpp"
+
+namespace mtconnect::pipeline {
+  /// @brief An expression evaluated against the properties of an observation
+  ///
+  /// Supports property references (`value` is the observation value), numbers, quoted strings,
+  /// upper case words like `READY` as strings, `true` and `false`, the arithmetic operators
+  /// `+ - * /`, the comparisons `== != < <= > >=`, the logical operators `&& || !` (or `and`,
+  /// `or`, `not`) and parentheses. Strings that contain a number compare and compute as numbers.
+  /// A word of only upper case letters, digits and underscores is a string, any other word is a
+  /// property, so other strings must be quoted. The text is compiled once into an expression tree.
+  class AGENT_LIB_API RuleExpression
+  {
+  public:
+    /// @brief the result of an evaluation, `std::monostate` if the expression has no value
+    using Result = std::variant<std::monostate, bool, double, std::string>;
+
+    /// @brief an expression tree node
+    struct Node
+    {
+      virtual ~Node() = default;
+      virtual Result evaluate(const observation::Observation &obs) const = 0;
+    };
+    using NodePtr = std::unique_ptr<Node>;
+
+    /// @brief compile an expression
+    /// @param[in] text the expression
+    /// @return the compiled expression
+    /// @throws std::invalid_argument if the expression cannot be parsed
+    static std::shared_ptr<RuleExpression> compile(const std::string &text);
+
+    /// @brief evaluate the expression
+    /// @param[in] obs the observation
+    /// @return the result
+    Result evaluate(const observation::Observation &obs) const { return m_root->evaluate(obs); }
+    /// @brief evaluate the expression as a predicate
+    /// @param[in] obs the observation
+    /// @return `true` if the result is true, a non-zero number, or a non-empty string
+    bool test(const observation::Observation &obs) const { return truthy(evaluate(obs)); }
+    /// @brief get the source text of the expression
+    const auto &getText() const { return m_text; }
+
+    /// @brief convert a result to a boolean
+    static bool truthy(const Result &result);
+    /// @brief convert a result to a number
+    /// @param[in] result the result
+    /// @param[out] value the number
+    /// @return `true` if the result is a number or a string containing a number
+    static bool toNumber(const Result &result, double &value);
+    /// @brief convert a result to a string
+    static std::string toString(const Result &result);
+
+  protected:
+    std::string m_text;
+    NodePtr m_root;
+  };
+
+  using RuleExpressionPtr = std::shared_ptr<RuleExpression>;
+
+  /// @brief A rule from the `Rules` configuration block
+  ///
+  /// The rule applies to observations of the data item and type, when given, for which the `When`
+  /// expression is true. It then either drops the observation or maps the value, computes a new
+  /// value, and remaps the observation to another data item, in that order.
+  struct Rule
+  {
+    std::string m_name;
+    std::optional<std::string> m_dataItem;  ///< id or name of the data item
+    std::optional<std::string> m_type;      ///< data item type
+    RuleExpressionPtr m_when;
+    bool m_drop {false};
+    std::unordered_map<std::string, std::string> m_map;
+    RuleExpressionPtr m_value;
+    std::optional<std::string> m_rename;  ///< id or name of the data item to remap to
+  };
+
+  using RulePtr = std::shared_ptr<const Rule>;
+  using RuleList = std::vector<RulePtr>;
+
+  /// @brief Apply configured rules to observations in native code
+  ///
+  /// Covers the simple cases that would otherwise need a Ruby or Python transform: dropping,
+  /// mapping, scaling and renaming values. The rules are shared by all pipelines and are
+  /// immutable once compiled.
+  class AGENT_LIB_API RuleTransform : public Transform
+  {
+  public:
+    RuleTransform(const RuleTransform &) = default;
+    /// @brief Construct a rule transform
+    /// @param[in] context the pipeline context, used to find data items to rename to
+    /// @param[in] rules the rules applied in order
+    RuleTransform(PipelineContextPtr context, const RuleList &rules)
+      : Transform("RuleTransform"), m_contract(context->m_contract.get()), m_rules(rules)
+    {
+      using namespace observation;
+      m_guard = TypeGuard<Observation>(RUN) || GuardCls(SKIP);
+    }
+    ~RuleTransform() override = default;
+
+    entity::EntityPtr operator()(entity::EntityPtr &&entity) override;
+
+    /// @brief get the rules
+    const auto &getRules() const { return m_rules; }
+
+  protected:
+    PipelineContract *m_contract;
+    RuleList m_rules;
+  };
+}  // namespace mtconnect::pipeline
@@ -187,7 +187,8 @@ namespace mtconnect {
       auto key = *token++;
       DataItemPtr dataItem;
       auto dataItemIt = m_dataItemMap.find(key);
-      if (dataItemIt == m_dataItemMap.end() || !(dataItem = dataItemIt->second.lock()))
+      if (dataItemIt == m_dataItemMap.end() ||
+          !(dataItem = dataItemIt->second.m_dataItem.lock()))
       {
         auto dataItemKey = splitKey(key);
         string device = dataItemKey.second.value_or(m_defaultDevice.value_or(""));
@@ -211,13 +212,29 @@ namespace mtconnect {
           return nullptr;
         }
 
-        m_dataItemMap[key] = dataItem;
+        MappedDataItem mapped {dataItem, ObservationBuilder(dataItem)};
+        dataItemIt = m_dataItemMap.insert_or_assign(key, std::move(mapped)).first;
       }
       //      else
       //      {
       //        LOG(trace) << "Mapped " << key;
       //      }
 
+      // Simple samples and events are created directly from the value token
+      const auto &builder = dataItemIt->second.m_builder;
+      if (builder.isDirect() && token != end)
+      {
+        auto obs = unavailable(*token) ? builder.makeUnavailable(dataItem, timestamp)
+                                       : builder.make(dataItem, *token, timestamp);
+        if (obs)
+        {
+          token++;
+          if (source)
+            dataItem->setDataSource(*source);
+          return obs;
+        }
+      }
+
       entity::Requirements *reqs {nullptr};
 
       // Extract the remaining tokens
@@ -74,11 +74,18 @@ namespace mtconnect::pipeline {
                                const TokenList::const_iterator &end, ErrorList &errors);
 
   protected:
+    /// @brief a resolved data item and its precompiled observation builder
+    struct MappedDataItem
+    {
+      WeakDataItemPtr m_dataItem;
+      observation::ObservationBuilder m_builder;
+    };
+
     // Logging Context
     std::set<std::string> m_logOnce;
     PipelineContract *m_contract;
     std::optional<std::string> m_defaultDevice;
-    std::unordered_map<std::string, WeakDataItemPtr> m_dataItemMap;
+    std::unordered_map<std::string, MappedDataItem> m_dataItemMap;
     int m_shdrVersion {1};
   };
 }  // namespace mtconnect::pipeline
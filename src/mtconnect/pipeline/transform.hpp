@@ -42,6 +42,8 @@ namespace mtconnect {
     class Transform;
     using TransformPtr = std::shared_ptr<Transform>;
     using TransformList = std::list<TransformPtr>;
+    class TransformProfile;
+    using TransformProfilePtr = std::shared_ptr<TransformProfile>;
 
     using ApplyDataItem = std::function<void(const DataItemPtr di)>;
     using EachDataItem = std::function<void(ApplyDataItem)>;
@@ -113,6 +115,8 @@ namespace mtconnect {
           switch (t->check(entity.get()))
           {
             case RUN:
+              if (t->m_profile)
+                return t->profiled(std::move(entity));
               return (*t)(std::move(entity));
 
             case SKIP:
@@ -149,6 +153,13 @@ namespace mtconnect {
           return m_guard(entity);
       }
 
+      /// @brief get the profile if the pipeline is being profiled
+      /// @return the profile or `nullptr`
+      const TransformProfilePtr &getProfile() const { return m_profile; }
+      /// @brief set the profile to record the calls to this transform
+      /// @param[in] profile the profile or `nullptr` to stop profiling
+      void setProfile(TransformProfilePtr profile) { m_profile = profile; }
+
       /// @brief Get a reference to the guard
       /// @return the guard
       const Guard &getGuard() const { return m_guard; }
@@ -260,10 +271,15 @@ namespace mtconnect {
         }
       }
 
+    protected:
+      /// @brief call the transform and record the time in the profile
+      entity::EntityPtr profiled(entity::EntityPtr &&entity);
+
     protected:
       std::string m_name;
       TransformList m_next;
       Guard m_guard;
+      TransformProfilePtr m_profile;
     };
 
     /// @brief A transform that just returns the entity. It does not call next.
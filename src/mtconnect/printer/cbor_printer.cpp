@@ -0,0 +1,387 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "cbor_printer.hpp"
+
+#include <boost/asio/ip/host_name.hpp>
+
+#include <cstdlib>
+#include <unordered_map>
+
+#include "mtconnect/device_model/device.hpp"
+#include "mtconnect/logging.hpp"
+#include "mtconnect/printer/cbor_printer_helper.hpp"
+#include "mtconnect/version.h"
+
+using namespace std;
+
+namespace mtconnect::printer {
+  using namespace observation;
+  using namespace device_model;
+  using namespace entity;
+
+  CborPrinter::CborPrinter(bool pretty) : Printer(pretty)
+  {
+    NAMED_SCOPE("CborPrinter::CborPrinter");
+    char appVersion[32] = {0};
+    std::sprintf(appVersion, "%d.%d.%d.%d", AGENT_VERSION_MAJOR, AGENT_VERSION_MINOR,
+                 AGENT_VERSION_PATCH, AGENT_VERSION_BUILD);
+    m_version = appVersion;
+  }
+
+  const string &CborPrinter::hostname() const
+  {
+    if (m_hostname.empty())
+    {
+      string name;
+      boost::system::error_code ec;
+      name = boost::asio::ip::host_name(ec);
+      if (ec)
+        name = "localhost";
+      // Breaking the rules, this is a one off
+      const_cast<CborPrinter *>(this)->m_hostname = name;
+    }
+
+    return m_hostname;
+  }
+
+  /// @brief Serializes entities and their property values as CBOR
+  class CborEntityPrinter
+  {
+  public:
+    CborEntityPrinter(CborWriter &writer, bool includeHidden = false)
+      : m_writer(writer), m_includeHidden(includeHidden)
+    {}
+
+    /// @brief print an entity as a single pair map of the entity name to its properties
+    void print(const EntityPtr &entity)
+    {
+      m_writer.startMap(1);
+      m_writer.addString(entity->getName());
+      printEntity(entity);
+    }
+
+    /// @brief print the properties of an entity
+    void printEntity(const EntityPtr &entity)
+    {
+      if (entity->isSimpleList())
+      {
+        printValue(entity->getProperty("LIST"));
+        return;
+      }
+
+      m_writer.startMap();
+      for (auto &[key, value] : entity->getProperties())
+      {
+        if (value.index() == EMPTY || (!m_includeHidden && entity->isHidden(key)))
+          continue;
+
+        if (key == "VALUE" || key == "RAW")
+          m_writer.addString("value");
+        else if (key == "LIST")
+          m_writer.addString("list");
+        else
+          m_writer.addString(key);
+        printValue(value);
+      }
+      m_writer.end();
+    }
+
+    /// @brief print a list of entities as an array
+    template <typename T>
+    void printEntityList(const T &list)
+    {
+      m_writer.startArray(list.size());
+      for (auto &e : list)
+        print(e);
+    }
+
+    void printValue(const Value &value) { visit(*this, value); }
+
+    void operator()(const std::monostate &) { m_writer.addNull(); }
+    void operator()(const std::nullptr_t &) { m_writer.addNull(); }
+    void operator()(const EntityPtr &entity) { printEntity(entity); }
+    void operator()(const EntityList &list) { printEntityList(list); }
+    void operator()(const std::string &s) { m_writer.addString(s); }
+    void operator()(const int64_t &i) { m_writer.addInteger(i); }
+    void operator()(const double &d) { m_writer.addDouble(d); }
+    void operator()(const bool &b) { m_writer.addBool(b); }
+    void operator()(const Vector &v) { m_writer.addFloatArray(v); }
+    void operator()(const Timestamp &ts) { m_writer.addTimestamp(ts); }
+    void operator()(const DataSet &set)
+    {
+      m_writer.startMap(set.size());
+      for (auto &e : set)
+      {
+        m_writer.addString(e.m_key);
+        if (e.m_removed)
+          m_writer.addUndefined();
+        else
+          visit([this](const auto &v) { printDataSetValue(v); }, e.m_value);
+      }
+    }
+
+  protected:
+    void printDataSetValue(const std::monostate &) { m_writer.addNull(); }
+    void printDataSetValue(const DataSet &set) { (*this)(set); }
+    void printDataSetValue(const std::string &s) { m_writer.addString(s); }
+    void printDataSetValue(const int64_t &i) { m_writer.addInteger(i); }
+    void printDataSetValue(const double &d) { m_writer.addDouble(d); }
+
+  protected:
+    CborWriter &m_writer;
+    bool m_includeHidden;
+  };
+
+  inline void header(CborWriter &writer, const string &version, const string &hostname,
+                     const uint64_t instanceId, const unsigned int bufferSize,
+                     const string &schemaVersion, const string &modelChangeTime)
+  {
+    writer.addString("version");
+    writer.addString(version);
+    writer.addString("creationTime");
+    writer.addTimestamp(chrono::system_clock::now());
+    writer.addString("testIndicator");
+    writer.addBool(false);
+    writer.addString("instanceId");
+    writer.addUnsigned(instanceId);
+    writer.addString("sender");
+    writer.addString(hostname);
+    writer.addString("schemaVersion");
+    writer.addString(schemaVersion);
+
+    if (schemaVersion >= "1.7")
+    {
+      writer.addString("deviceModelChangeTime");
+      writer.addString(modelChangeTime);
+    }
+    if (bufferSize > 0)
+    {
+      writer.addString("bufferSize");
+      writer.addUnsigned(bufferSize);
+    }
+  }
+
+  std::string CborPrinter::printErrors(const uint64_t instanceId, const unsigned int bufferSize,
+                                       const uint64_t nextSeq, const ProtoErrorList &list,
+                                       bool pretty) const
+  {
+    defaultSchemaVersion();
+
+    string output;
+    CborWriter writer(output);
+    writer.startMap(1);
+    writer.addString("MTConnectError");
+    writer.startMap(2);
+    {
+      writer.addString("Header");
+      writer.startMap();
+      header(writer, m_version, hostname(), instanceId, bufferSize, *m_schemaVersion,
+             m_modelChangeTime);
+      writer.end();
+    }
+    {
+      writer.addString("Errors");
+      writer.startArray(list.size());
+      for (auto &e : list)
+      {
+        string s(e.second);
+        writer.startMap(2);
+        writer.addString("errorCode");
+        writer.addString(e.first);
+        writer.addString("value");
+        writer.addString(trim(s));
+      }
+    }
+
+    return output;
+  }
+
+  std::string CborPrinter::printProbe(const uint64_t instanceId, const unsigned int bufferSize,
+                                      const uint64_t nextSeq, const unsigned int assetBufferSize,
+                                      const unsigned int assetCount,
+                                      const std::list<DevicePtr> &devices,
+                                      const std::map<std::string, size_t> *count,
+                                      bool includeHidden, bool pretty) const
+  {
+    defaultSchemaVersion();
+
+    string output;
+    CborWriter writer(output);
+    CborEntityPrinter printer(writer, includeHidden);
+
+    writer.startMap(1);
+    writer.addString("MTConnectDevices");
+    writer.startMap(2);
+    {
+      writer.addString("Header");
+      writer.startMap();
+      header(writer, m_version, hostname(), instanceId, bufferSize, *m_schemaVersion,
+             m_modelChangeTime);
+      writer.addString("assetBufferSize");
+      writer.addUnsigned(assetBufferSize);
+      writer.addString("assetCount");
+      writer.addUnsigned(assetCount);
+      if (count && !count->empty())
+      {
+        writer.addString("AssetCounts");
+        writer.startMap(count->size());
+        for (auto &[type, c] : *count)
+        {
+          writer.addString(type);
+          writer.addUnsigned(c);
+        }
+      }
+      writer.end();
+    }
+    {
+      writer.addString("Devices");
+      printer.printEntityList(devices);
+    }
+
+    return output;
+  }
+
+  std::string CborPrinter::printAssets(const uint64_t instanceId, const unsigned int bufferSize,
+                                       const unsigned int assetCount, const asset::AssetList &asset,
+                                       bool pretty) const
+  {
+    defaultSchemaVersion();
+
+    string output;
+    CborWriter writer(output);
+    CborEntityPrinter printer(writer);
+
+    writer.startMap(1);
+    writer.addString("MTConnectAssets");
+    writer.startMap(2);
+    {
+      writer.addString("Header");
+      writer.startMap();
+      header(writer, m_version, hostname(), instanceId, 0, *m_schemaVersion, m_modelChangeTime);
+      writer.addString("assetBufferSize");
+      writer.addUnsigned(bufferSize);
+      writer.addString("assetCount");
+      writer.addUnsigned(assetCount);
+      writer.end();
+    }
+    {
+      writer.addString("Assets");
+      printer.printEntityList(asset);
+    }
+
+    return output;
+  }
+
+  std::string CborPrinter::printSample(const uint64_t instanceId, const unsigned int bufferSize,
+                                       const uint64_t nextSeq, const uint64_t firstSeq,
+                                       const uint64_t lastSeq, ObservationList &observations,
+                                       bool pretty) const
+  {
+    defaultSchemaVersion();
+
+    // Intern the data item ids so each id is only sent once per document
+    vector<pair<ObservationPtr, DataItemPtr>> refs;
+    vector<string_view> ids;
+    unordered_map<string_view, size_t> index;
+    refs.reserve(observations.size());
+    for (const auto &o : observations)
+    {
+      if (o->isOrphan())
+        continue;
+
+      auto di = o->getDataItem();
+      if (index.try_emplace(di->getId(), ids.size()).second)
+        ids.emplace_back(di->getId());
+      refs.emplace_back(o, di);
+    }
+
+    string output;
+    output.reserve(256 + ids.size() * 16 + refs.size() * 24);
+    CborWriter writer(output);
+    CborEntityPrinter printer(writer);
+
+    writer.startMap(1);
+    writer.addString("MTConnectStreams");
+    writer.startMap(3);
+    {
+      writer.addString("Header");
+      writer.startMap();
+      header(writer, m_version, hostname(), instanceId, bufferSize, *m_schemaVersion,
+             m_modelChangeTime);
+      writer.addString("nextSequence");
+      writer.addUnsigned(nextSeq);
+      writer.addString("lastSequence");
+      writer.addUnsigned(lastSeq);
+      writer.addString("firstSequence");
+      writer.addUnsigned(firstSeq);
+      writer.end();
+    }
+    {
+      writer.addString("DataItems");
+      writer.startArray(ids.size());
+      for (auto &id : ids)
+        writer.addString(id);
+    }
+    {
+      writer.addString("Observations");
+      writer.startArray(refs.size());
+      for (auto &[obs, di] : refs)
+      {
+        // Properties carried by the data item or the fixed fields are not repeated
+        const auto &diProps = di->getObservationProperties();
+        size_t extra = 0;
+        for (auto &[key, value] : obs->getProperties())
+        {
+          if (key != "timestamp" && key != "sequence" && key != "VALUE" &&
+              diProps.count(key) == 0 && value.index() != EMPTY)
+            extra++;
+        }
+        auto cond = dynamic_pointer_cast<Condition>(obs);
+        if (cond)
+          extra++;
+
+        writer.startArray(extra > 0 ? 5 : 4);
+        writer.addUnsigned(index[di->getId()]);
+        writer.addUnsigned(obs->getSequence());
+        writer.addTimestamp(obs->getTimestamp());
+        printer.printValue(obs->getValue());
+
+        if (extra > 0)
+        {
+          writer.startMap(extra);
+          if (cond)
+          {
+            writer.addString("level");
+            writer.addString(cond->getName());
+          }
+          for (auto &[key, value] : obs->getProperties())
+          {
+            if (key != "timestamp" && key != "sequence" && key != "VALUE" &&
+                diProps.count(key) == 0 && value.index() != EMPTY)
+            {
+              writer.addString(key);
+              printer.printValue(value);
+            }
+          }
+        }
+      }
+    }
+
+    return output;
+  }
+}  // namespace mtconnect::printer
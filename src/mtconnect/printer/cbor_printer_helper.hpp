@@ -0,0 +1,237 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/utilities.hpp"
+
+namespace mtconnect::printer {
+  /// @brief Minimal CBOR (RFC 8949) encoder appending to a string buffer
+  ///
+  /// Only the subset needed by the `CborPrinter` is supported: integers, floats, strings, byte
+  /// strings, tags, definite and indefinite length arrays and maps, and typed float arrays
+  /// (RFC 8746).
+  class AGENT_LIB_API CborWriter
+  {
+  public:
+    /// @brief CBOR major types
+    enum MajorType : uint8_t
+    {
+      UNSIGNED = 0,
+      NEGATIVE = 1,
+      BYTES = 2,
+      TEXT = 3,
+      ARRAY = 4,
+      MAP = 5,
+      TAG = 6,
+      SIMPLE = 7
+    };
+
+    /// @brief RFC 8746 tag for an array of little endian 32 bit floats
+    static constexpr uint64_t FLOAT32_LE_ARRAY = 85;
+    /// @brief RFC 8746 tag for an array of little endian 64 bit floats
+    static constexpr uint64_t FLOAT64_LE_ARRAY = 86;
+
+    /// @brief Create a writer appending to the buffer
+    /// @param[in,out] buffer the output buffer
+    CborWriter(std::string &buffer) : m_buffer(buffer) {}
+
+    /// @name Scalar methods
+    /// @{
+
+    /// @brief Add an unsigned integer
+    /// @param[in] v the value
+    void addUnsigned(uint64_t v) { head(UNSIGNED, v); }
+    /// @brief Add a signed integer
+    /// @param[in] v the value
+    void addInteger(int64_t v)
+    {
+      if (v >= 0)
+        head(UNSIGNED, uint64_t(v));
+      else
+        head(NEGATIVE, uint64_t(-1 - v));
+    }
+    /// @brief Add a double, narrowed to a single precision float if it is lossless
+    /// @param[in] v the value
+    void addDouble(double v)
+    {
+      float f = float(v);
+      if (double(f) == v)
+      {
+        uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        m_buffer.push_back(char(0xFA));
+        bigEndian(bits, 4);
+      }
+      else
+      {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        m_buffer.push_back(char(0xFB));
+        bigEndian(bits, 8);
+      }
+    }
+    /// @brief Add a boolean
+    /// @param[in] v the value
+    void addBool(bool v) { m_buffer.push_back(v ? char(0xF5) : char(0xF4)); }
+    /// @brief Add a null
+    void addNull() { m_buffer.push_back(char(0xF6)); }
+    /// @brief Add an undefined value
+    void addUndefined() { m_buffer.push_back(char(0xF7)); }
+    /// @brief Add a UTF-8 text string
+    /// @param[in] s the string
+    void addString(const std::string_view &s)
+    {
+      head(TEXT, s.size());
+      m_buffer.append(s.data(), s.size());
+    }
+    /// @brief Add a byte string
+    /// @param[in] data pointer to the bytes
+    /// @param[in] size the number of bytes
+    void addBytes(const void *data, size_t size)
+    {
+      head(BYTES, size);
+      m_buffer.append(static_cast<const char *>(data), size);
+    }
+    /// @brief Add a tag for the next item
+    /// @param[in] tag the tag number
+    void addTag(uint64_t tag) { head(TAG, tag); }
+    /// @brief Add a timestamp as microseconds since the epoch
+    /// @param[in] ts the timestamp
+    void addTimestamp(const Timestamp &ts)
+    {
+      using namespace std::chrono;
+      addInteger(duration_cast<microseconds>(ts.time_since_epoch()).count());
+    }
+    /// @brief Add a vector of doubles as a packed typed array
+    ///
+    /// Uses 32 bit floats if every value can be narrowed without loss, otherwise 64 bit floats.
+    ///
+    /// @param[in] values the values
+    void addFloatArray(const std::vector<double> &values)
+    {
+      bool narrow = true;
+      for (auto v : values)
+      {
+        if (double(float(v)) != v)
+        {
+          narrow = false;
+          break;
+        }
+      }
+
+      if (narrow)
+      {
+        addTag(FLOAT32_LE_ARRAY);
+        head(BYTES, values.size() * 4);
+        for (auto v : values)
+        {
+          float f = float(v);
+          uint32_t bits;
+          std::memcpy(&bits, &f, sizeof(bits));
+          littleEndian(bits, 4);
+        }
+      }
+      else
+      {
+        addTag(FLOAT64_LE_ARRAY);
+        head(BYTES, values.size() * 8);
+        for (auto v : values)
+        {
+          uint64_t bits;
+          std::memcpy(&bits, &v, sizeof(bits));
+          littleEndian(bits, 8);
+        }
+      }
+    }
+    /// @}
+
+    /// @name Collection methods
+    /// @{
+
+    /// @brief Start an array with a known number of items
+    /// @param[in] size the number of items
+    void startArray(size_t size) { head(ARRAY, size); }
+    /// @brief Start an indefinite length array, must be closed with `end()`
+    void startArray() { m_buffer.push_back(char(0x9F)); }
+    /// @brief Start a map with a known number of key/value pairs
+    /// @param[in] size the number of pairs
+    void startMap(size_t size) { head(MAP, size); }
+    /// @brief Start an indefinite length map, must be closed with `end()`
+    void startMap() { m_buffer.push_back(char(0xBF)); }
+    /// @brief End an indefinite length array or map
+    void end() { m_buffer.push_back(char(0xFF)); }
+    /// @}
+
+    /// @brief get the output buffer
+    /// @return the buffer
+    const std::string &getBuffer() const { return m_buffer; }
+
+  protected:
+    void head(MajorType type, uint64_t v)
+    {
+      uint8_t major = uint8_t(type) << 5;
+      if (v < 24)
+      {
+        m_buffer.push_back(char(major | uint8_t(v)));
+      }
+      else if (v <= 0xFF)
+      {
+        m_buffer.push_back(char(major | 24));
+        m_buffer.push_back(char(v));
+      }
+      else if (v <= 0xFFFF)
+      {
+        m_buffer.push_back(char(major | 25));
+        bigEndian(v, 2);
+      }
+      else if (v <= 0xFFFFFFFF)
+      {
+        m_buffer.push_back(char(major | 26));
+        bigEndian(v, 4);
+      }
+      else
+      {
+        m_buffer.push_back(char(major | 27));
+        bigEndian(v, 8);
+      }
+    }
+
+    void bigEndian(uint64_t v, int bytes)
+    {
+      for (int i = bytes - 1; i >= 0; i--)
+        m_buffer.push_back(char((v >> (i * 8)) & 0xFF));
+    }
+
+    void littleEndian(uint64_t v, int bytes)
+    {
+      for (int i = 0; i < bytes; i++)
+        m_buffer.push_back(char((v >> (i * 8)) & 0xFF));
+    }
+
+  protected:
+    std::string &m_buffer;
+  };
+}  // namespace mtconnect::printer
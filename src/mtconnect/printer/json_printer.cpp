@@ -129,7 +129,7 @@ namespace mtconnect::printer {
   {
     defaultSchemaVersion();
 
-    StringBuffer output;
+    StringOutput output;
     RenderJson(output, m_pretty || pretty, [&](auto &writer) {
       AutoJsonObject obj(writer);
       {
@@ -174,7 +174,7 @@ namespace mtconnect::printer {
       }
     });
 
-    return string(output.GetString(), output.GetLength());
+    return output.getContent();
   }
 
   std::string JsonPrinter::printProbe(const uint64_t instanceId, const unsigned int bufferSize,
@@ -186,7 +186,7 @@ namespace mtconnect::printer {
   {
     defaultSchemaVersion();
 
-    StringBuffer output;
+    StringOutput output;
     RenderJson(output, m_pretty || pretty, [&](auto &writer) {
       entity::JsonPrinter printer(writer, m_jsonVersion, includeHidden);
 
@@ -204,7 +204,7 @@ namespace mtconnect::printer {
       }
     });
 
-    return string(output.GetString(), output.GetLength());
+    return output.getContent();
   }
 
   std::string JsonPrinter::printAssets(const uint64_t instanceId, const unsigned int bufferSize,
@@ -213,7 +213,7 @@ namespace mtconnect::printer {
   {
     defaultSchemaVersion();
 
-    StringBuffer output;
+    StringOutput output;
     RenderJson(output, m_pretty || pretty, [&](auto &writer) {
       entity::JsonPrinter printer(writer, m_jsonVersion);
 
@@ -230,7 +230,7 @@ namespace mtconnect::printer {
         printer.printEntityList(asset);
       }
     });
-    return string(output.GetString(), output.GetLength());
+    return output.getContent();
   }
 
   using namespace boost;
@@ -413,7 +413,7 @@ namespace mtconnect::printer {
   {
     defaultSchemaVersion();
 
-    StringBuffer output;
+    StringOutput output;
     RenderJson(output, m_pretty || pretty, [&](auto &writer) {
       AutoJsonObject top(writer);
       AutoJsonObject obj(writer, "MTConnectStreams");
@@ -447,6 +447,6 @@ namespace mtconnect::printer {
       }
     });
 
-    return string(output.GetString(), output.GetLength());
+    return output.getContent();
   }
 }  // namespace mtconnect::printer
@@ -21,8 +21,34 @@
 #include <rapidjson/prettywriter.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
+#include <string>
 
 namespace mtconnect::printer {
+  /// @brief rapidjson output stream that writes into a string
+  ///
+  /// Unlike a `rapidjson::StringBuffer`, the document can be moved out of the stream without
+  /// copying it.
+  class StringOutput
+  {
+  public:
+    using Ch = char;
+
+    /// @brief Create an output stream
+    /// @param[in] capacity the initial capacity of the string
+    StringOutput(size_t capacity = 4096) { m_buffer.reserve(capacity); }
+
+    /// @brief rapidjson output stream method to write a character
+    void Put(Ch c) { m_buffer.push_back(c); }
+    /// @brief rapidjson output stream method, does nothing
+    void Flush() {}
+
+    /// @brief Get the document. The stream is empty afterwards.
+    /// @return the document
+    std::string getContent() { return std::move(m_buffer); }
+
+  protected:
+    std::string m_buffer;
+  };
 
   /// @brief Abstract helper wrapping the rapidjson writer and providing some helper methods
   /// serializing types.
@@ -321,7 +347,7 @@ namespace mtconnect::printer {
   /// Calls func with the writer allowing the correct templates to be instantiated depending on
   /// pretty printing.
   ///
-  /// @param[in] output the rapidjson output object, like `StringBuffer`
+  /// @param[in] output the rapidjson output object, like `StringBuffer` or `StringOutput`
   /// @param[in] pretty `true` creates a `rapidjson::PrettyWriter` and `false` creates a
   /// `rapidjson::Writer`
   /// @param[in] func the lambda to callback with the writer
@@ -332,13 +358,13 @@ namespace mtconnect::printer {
   {
     if (pretty)
     {
-      rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(output);
+      rapidjson::PrettyWriter<T> writer(output);
       writer.SetIndent(' ', 2);
       func(writer);
     }
     else
     {
-      rapidjson::Writer<rapidjson::StringBuffer> writer(output);
+      rapidjson::Writer<T> writer(output);
       func(writer);
     }
   }
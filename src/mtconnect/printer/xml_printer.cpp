@@ -24,8 +24,6 @@
 #include <typeinfo>
 #include <utility>
 
-#include <libxml/xmlwriter.h>
-
 #include "mtconnect/asset/asset.hpp"
 #include "mtconnect/asset/cutting_tool.hpp"
 #include "mtconnect/device_model/composition.hpp"
@@ -34,18 +32,7 @@
 #include "mtconnect/logging.hpp"
 #include "mtconnect/version.h"
 #include "xml_printer.hpp"
-
-#define strfy(line) #line
-#define THROW_IF_XML2_ERROR(expr)                                           \
-  if ((expr) < 0)                                                           \
-  {                                                                         \
-    throw string("XML Error at " __FILE__ "(" strfy(__LINE__) "): " #expr); \
-  }
-#define THROW_IF_XML2_NULL(expr)                                            \
-  if (!(expr))                                                              \
-  {                                                                         \
-    throw string("XML Error at " __FILE__ "(" strfy(__LINE__) "): " #expr); \
-  }
+#include "xml_printer_helper.hpp"
 
 using namespace std;
 
@@ -54,52 +41,6 @@ namespace mtconnect::printer {
   using namespace asset;
   using namespace device_model::configuration;
 
-  class AGENT_LIB_API XmlWriter
-  {
-  public:
-    XmlWriter(bool pretty) : m_writer(nullptr), m_buf(nullptr)
-    {
-      THROW_IF_XML2_NULL(m_buf = xmlBufferCreate());
-      THROW_IF_XML2_NULL(m_writer = xmlNewTextWriterMemory(m_buf, 0));
-      if (pretty)
-      {
-        THROW_IF_XML2_ERROR(xmlTextWriterSetIndent(m_writer, 1));
-        THROW_IF_XML2_ERROR(xmlTextWriterSetIndentString(m_writer, BAD_CAST "  "));
-      }
-    }
-
-    ~XmlWriter()
-    {
-      if (m_writer != nullptr)
-      {
-        xmlFreeTextWriter(m_writer);
-        m_writer = nullptr;
-      }
-      if (m_buf != nullptr)
-      {
-        xmlBufferFree(m_buf);
-        m_buf = nullptr;
-      }
-    }
-
-    operator xmlTextWriterPtr() { return m_writer; }
-
-    string getContent()
-    {
-      if (m_writer != nullptr)
-      {
-        THROW_IF_XML2_ERROR(xmlTextWriterEndDocument(m_writer));
-        xmlFreeTextWriter(m_writer);
-        m_writer = nullptr;
-      }
-      return string((char *)m_buf->content, m_buf->use);
-    }
-
-  protected:
-    xmlTextWriterPtr m_writer;
-    xmlBufferPtr m_buf;
-  };
-
   XmlPrinter::XmlPrinter(bool pretty) : Printer(pretty) { NAMED_SCOPE("xml.printer"); }
 
   void XmlPrinter::addDevicesNamespace(const std::string &urn, const std::string &location,
@@ -242,83 +183,22 @@ namespace mtconnect::printer {
 
   void XmlPrinter::setAssetsStyle(const std::string &style) { m_assetStyle = style; }
 
-  static inline void addAttribute(xmlTextWriterPtr writer, const char *key,
-                                  const std::string &value)
+  static inline void addAttribute(XmlWriter &writer, const char *key, const std::string &value)
   {
     if (!value.empty())
-      THROW_IF_XML2_ERROR(
-          xmlTextWriterWriteAttribute(writer, BAD_CAST key, BAD_CAST value.c_str()));
+      writer.writeAttribute(key, value);
   }
 
-  void addAttributes(xmlTextWriterPtr writer, const std::map<string, string> &attributes)
+  void addAttributes(XmlWriter &writer, const std::map<string, string> &attributes)
   {
     for (const auto &attr : attributes)
     {
       if (!attr.second.empty())
-      {
-        THROW_IF_XML2_ERROR(xmlTextWriterWriteAttribute(writer, BAD_CAST attr.first.c_str(),
-                                                        BAD_CAST attr.second.c_str()));
-      }
+        writer.writeAttribute(attr.first, attr.second);
     }
   }
 
-  static inline void openElement(xmlTextWriterPtr writer, const char *name)
-  {
-    THROW_IF_XML2_ERROR(xmlTextWriterStartElement(writer, BAD_CAST name));
-  }
-
-  static inline void closeElement(xmlTextWriterPtr writer)
-  {
-    THROW_IF_XML2_ERROR(xmlTextWriterEndElement(writer));
-  }
-
-  class AGENT_LIB_API AutoElement
-  {
-  public:
-    AutoElement(xmlTextWriterPtr writer) : m_writer(writer) {}
-    AutoElement(xmlTextWriterPtr writer, const char *name, string key = "")
-      : m_writer(writer), m_name(name), m_key(std::move(key))
-    {
-      openElement(writer, name);
-    }
-    AutoElement(xmlTextWriterPtr writer, const string &name, string key = "")
-      : m_writer(writer), m_name(name), m_key(std::move(key))
-    {
-      openElement(writer, name.c_str());
-    }
-    bool reset(const string &name, const string &key = "")
-    {
-      if (name != m_name || m_key != key)
-      {
-        if (!m_name.empty())
-          closeElement(m_writer);
-        if (!name.empty())
-          openElement(m_writer, name.c_str());
-        m_name = name;
-        m_key = key;
-        return true;
-      }
-      else
-      {
-        return false;
-      }
-    }
-    ~AutoElement()
-    {
-      if (!m_name.empty())
-        xmlTextWriterEndElement(m_writer);
-    }
-
-    const string &key() const { return m_key; }
-    const string &name() const { return m_name; }
-
-  protected:
-    xmlTextWriterPtr m_writer;
-    string m_name;
-    string m_key;
-  };
-
-  void addSimpleElement(xmlTextWriterPtr writer, const string &element, const string &body,
+  void addSimpleElement(XmlWriter &writer, const string &element, const string &body,
                         const map<string, string> &attributes = {}, bool raw = false)
   {
     AutoElement ele(writer, element);
@@ -328,14 +208,10 @@ namespace mtconnect::printer {
 
     if (!body.empty())
     {
-      xmlChar *text = nullptr;
       if (!raw)
-        text = xmlEncodeEntitiesReentrant(nullptr, BAD_CAST body.c_str());
+        writer.writeEntities(body);
       else
-        text = BAD_CAST body.c_str();
-      THROW_IF_XML2_ERROR(xmlTextWriterWriteRaw(writer, text));
-      if (!raw)
-        xmlFree(text);
+        writer.writeRaw(body);
     }
   }
 
@@ -528,19 +404,19 @@ namespace mtconnect::printer {
     return ret;
   }
 
-  void XmlPrinter::addObservation(xmlTextWriterPtr writer, ObservationPtr result) const
+  void XmlPrinter::addObservation(XmlWriter &writer, ObservationPtr result) const
   {
     entity::XmlPrinter printer;
     printer.print(writer, result, m_streamsNsSet);
   }
 
-  void XmlPrinter::initXmlDoc(xmlTextWriterPtr writer, EDocumentType aType,
+  void XmlPrinter::initXmlDoc(XmlWriter &writer, EDocumentType aType,
                               const uint64_t instanceId, const unsigned int bufferSize,
                               const unsigned int assetBufferSize, const unsigned int assetCount,
                               const uint64_t nextSeq, const uint64_t firstSeq,
                               const uint64_t lastSeq, const map<string, size_t> *count) const
   {
-    THROW_IF_XML2_ERROR(xmlTextWriterStartDocument(writer, nullptr, "UTF-8", nullptr));
+    writer.startDocument();
 
     // TODO: Cache the locations and header attributes.
     // Write the root element
@@ -577,8 +453,7 @@ namespace mtconnect::printer {
     if (!style.empty())
     {
       string pi = R"(xml-stylesheet type="text/xsl" href=")" + style + '"';
-      THROW_IF_XML2_ERROR(xmlTextWriterStartPI(writer, BAD_CAST pi.c_str()));
-      THROW_IF_XML2_ERROR(xmlTextWriterEndPI(writer));
+      writer.writeProcessingInstruction(pi);
     }
 
     string rootName = "MTConnect" + xmlType;
@@ -587,7 +462,7 @@ namespace mtconnect::printer {
     string xmlns = "urn:mtconnect.org:" + rootName + ":" + *m_schemaVersion;
     string location;
 
-    openElement(writer, rootName.c_str());
+    openElement(writer, rootName);
 
     // Always make the default namespace and the m: namespace MTConnect default.
     addAttribute(writer, "xmlns:m", xmlns);
@@ -24,12 +24,6 @@
 #include "mtconnect/printer/printer.hpp"
 #include "mtconnect/utilities.hpp"
 
-extern "C"
-{
-  using xmlTextWriter = struct _xmlTextWriter;
-  using xmlTextWriterPtr = xmlTextWriter *;
-}
-
 namespace mtconnect {
   class SensorConfiguration;
 
@@ -163,17 +157,17 @@ namespace mtconnect {
       };
 
       // Initiate all documents
-      void initXmlDoc(xmlTextWriterPtr writer, EDocumentType docType, const uint64_t instanceId,
+      void initXmlDoc(XmlWriter &writer, EDocumentType docType, const uint64_t instanceId,
                       const unsigned int bufferSize, const unsigned int assetBufferSize,
                       const unsigned int assetCount, const uint64_t nextSeq,
                       const uint64_t firstSeq = 0, const uint64_t lastSeq = 0,
                       const std::map<std::string, size_t> *counts = nullptr) const;
 
       // Helper to print individual components and details
-      void printProbeHelper(xmlTextWriterPtr writer, device_model::ComponentPtr component,
+      void printProbeHelper(XmlWriter &writer, device_model::ComponentPtr component,
                             const char *name) const;
-      void printDataItem(xmlTextWriterPtr writer, DataItemPtr dataItem) const;
-      void addObservation(xmlTextWriterPtr writer, observation::ObservationPtr result) const;
+      void printDataItem(XmlWriter &writer, DataItemPtr dataItem) const;
+      void addObservation(XmlWriter &writer, observation::ObservationPtr result) const;
 
     protected:
       std::map<std::string, SchemaNamespace> m_devicesNamespaces;
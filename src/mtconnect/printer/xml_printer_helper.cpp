@@ -0,0 +1,257 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "xml_printer_helper.hpp"
+
+#include <array>
+#include <cstdio>
+
+using namespace std;
+
+namespace mtconnect::printer {
+  namespace {
+    enum Escape : uint8_t
+    {
+      TEXT = 0x1,       ///< escaped in text
+      ENTITIES = 0x2,   ///< escaped or dropped when encoding entities
+      ATTRIBUTE = 0x4,  ///< escaped in attributes
+    };
+
+    /// @brief the characters that need attention for each kind of escaping
+    constexpr array<uint8_t, 256> makeEscapes()
+    {
+      array<uint8_t, 256> escapes {};
+      for (int c = 0; c < 0x20; c++)
+      {
+        if (c != '\t' && c != '\n')
+          escapes[c] |= ENTITIES;
+      }
+      for (int c = 0x80; c < 0x100; c++)
+        escapes[c] |= ENTITIES | ATTRIBUTE;
+      for (auto c : {'<', '>', '&'})
+        escapes[uint8_t(c)] |= TEXT | ENTITIES | ATTRIBUTE;
+      escapes['"'] |= TEXT | ATTRIBUTE;
+      escapes['\r'] |= TEXT | ATTRIBUTE;
+      escapes['\n'] |= ATTRIBUTE;
+      escapes['\t'] |= ATTRIBUTE;
+      return escapes;
+    }
+    constexpr auto s_escapes = makeEscapes();
+
+    /// @brief find the next character that needs escaping
+    inline size_t scan(string_view text, size_t pos, uint8_t kind)
+    {
+      // Stop at an embedded nul like the C string based writer
+      for (; pos < text.size(); pos++)
+      {
+        auto c = uint8_t(text[pos]);
+        if ((s_escapes[c] & kind) != 0 || c == 0)
+          break;
+      }
+      return pos;
+    }
+
+    inline bool isXmlChar(uint32_t c)
+    {
+      return c == 0x9 || c == 0xA || c == 0xD || (c >= 0x20 && c <= 0xD7FF) ||
+             (c >= 0xE000 && c <= 0xFFFD) || (c >= 0x10000 && c <= 0x10FFFF);
+    }
+
+    /// @brief decode a UTF-8 character
+    /// @param[in] text the text
+    /// @param[in] pos the position of the lead byte
+    /// @param[out] len the number of bytes, 1 if it is not a valid lead byte
+    /// @return the code point
+    inline uint32_t decode(string_view text, size_t pos, size_t &len)
+    {
+      auto at = [&text](size_t i) -> uint32_t { return i < text.size() ? uint8_t(text[i]) : 0; };
+      uint32_t c = at(pos);
+      if (c < 0xC0)
+      {
+        len = 1;
+        return c;
+      }
+      else if (c < 0xE0)
+      {
+        len = 2;
+        return ((c & 0x1F) << 6) | (at(pos + 1) & 0x3F);
+      }
+      else if (c < 0xF0)
+      {
+        len = 3;
+        return ((c & 0x0F) << 12) | ((at(pos + 1) & 0x3F) << 6) | (at(pos + 2) & 0x3F);
+      }
+      else if (c < 0xF8)
+      {
+        len = 4;
+        return ((c & 0x07) << 18) | ((at(pos + 1) & 0x3F) << 12) | ((at(pos + 2) & 0x3F) << 6) |
+               (at(pos + 3) & 0x3F);
+      }
+
+      len = 1;
+      return c;
+    }
+
+    inline void appendReference(string &buffer, const char *format, uint32_t c)
+    {
+      char ref[16];
+      auto n = snprintf(ref, sizeof(ref), format, c);
+      buffer.append(ref, n);
+    }
+  }  // namespace
+
+  void XmlWriter::escapeText(string_view text)
+  {
+    size_t start = 0;
+    for (auto pos = scan(text, 0, TEXT); pos < text.size(); pos = scan(text, start, TEXT))
+    {
+      m_buffer.append(text, start, pos - start);
+      switch (text[pos])
+      {
+        case '<':
+          m_buffer.append("&lt;");
+          break;
+        case '>':
+          m_buffer.append("&gt;");
+          break;
+        case '&':
+          m_buffer.append("&amp;");
+          break;
+        case '"':
+          m_buffer.append("&quot;");
+          break;
+        case '\r':
+          m_buffer.append("&#13;");
+          break;
+        default:
+          return;
+      }
+      start = pos + 1;
+    }
+    m_buffer.append(text, start, text.size() - start);
+  }
+
+  void XmlWriter::escapeEntities(string_view text)
+  {
+    size_t start = 0;
+    for (auto pos = scan(text, 0, ENTITIES); pos < text.size(); pos = scan(text, start, ENTITIES))
+    {
+      m_buffer.append(text, start, pos - start);
+      auto c = uint8_t(text[pos]);
+      start = pos + 1;
+      switch (c)
+      {
+        case 0:
+          return;
+        case '<':
+          m_buffer.append("&lt;");
+          break;
+        case '>':
+          m_buffer.append("&gt;");
+          break;
+        case '&':
+          m_buffer.append("&amp;");
+          break;
+        case '\r':
+          m_buffer.append("&#13;");
+          break;
+        default:
+          if (c >= 0x80)
+          {
+            // Characters outside of ASCII become character references, invalid bytes are
+            // written as decimal references of the byte.
+            size_t len;
+            auto code = decode(text, pos, len);
+            if (len == 1 || !isXmlChar(code))
+            {
+              appendReference(m_buffer, "&#%u;", c);
+            }
+            else
+            {
+              appendReference(m_buffer, "&#x%X;", code);
+              start = pos + len;
+            }
+          }
+          // Other control characters are dropped
+          break;
+      }
+    }
+    m_buffer.append(text, start, text.size() - start);
+  }
+
+  void XmlWriter::escapeAttribute(string_view text)
+  {
+    size_t start = 0;
+    for (auto pos = scan(text, 0, ATTRIBUTE); pos < text.size();
+         pos = scan(text, start, ATTRIBUTE))
+    {
+      m_buffer.append(text, start, pos - start);
+      auto c = uint8_t(text[pos]);
+      start = pos + 1;
+      switch (c)
+      {
+        case 0:
+          return;
+        case '\n':
+          m_buffer.append("&#10;");
+          break;
+        case '\r':
+          m_buffer.append("&#13;");
+          break;
+        case '\t':
+          m_buffer.append("&#9;");
+          break;
+        case '"':
+          m_buffer.append("&quot;");
+          break;
+        case '<':
+          m_buffer.append("&lt;");
+          break;
+        case '>':
+          m_buffer.append("&gt;");
+          break;
+        case '&':
+          m_buffer.append("&amp;");
+          break;
+        default:
+        {
+          // Without an encoding declaration characters outside of ASCII become character
+          // references. A trailing byte is copied as is.
+          if (m_document || start >= text.size() || text[start] == 0)
+          {
+            m_buffer.push_back(char(c));
+            break;
+          }
+
+          size_t len;
+          auto code = decode(text, pos, len);
+          if (len == 1 || !isXmlChar(code))
+          {
+            appendReference(m_buffer, "&#x%X;", c);
+          }
+          else
+          {
+            appendReference(m_buffer, "&#x%X;", code);
+            start = pos + len;
+          }
+          break;
+        }
+      }
+    }
+    m_buffer.append(text, start, text.size() - start);
+  }
+}  // namespace mtconnect::printer
@@ -17,78 +17,192 @@
 
 #pragma once
 
-#include <libxml/xmlwriter.h>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "mtconnect/config.hpp"
 #include "mtconnect/printer/xml_helper.hpp"
 
 namespace mtconnect::printer {
-  /// @brief Helper class for XML document generation. Wraps some common libxml2 functions
+  /// @brief Streaming XML writer for document generation
+  ///
+  /// Writes directly into a growable string buffer with the same output as the libxml2
+  /// `xmlTextWriter` it replaces, including the pretty printing and escaping rules. Text that
+  /// needs no escaping is appended without copying it into a temporary.
   class AGENT_LIB_API XmlWriter
   {
   public:
     /// @brief Construct an XmlWriter creating setting up the buffer for writing.
     /// @param pretty `true` if output is formatted with indentation
-    XmlWriter(bool pretty) : m_writer(nullptr), m_buf(nullptr)
+    XmlWriter(bool pretty) : m_pretty(pretty) { m_buffer.reserve(4096); }
+
+    /// @brief write the XML declaration
+    void startDocument()
     {
-      THROW_IF_XML2_NULL(m_buf = xmlBufferCreate());
-      THROW_IF_XML2_NULL(m_writer = xmlNewTextWriterMemory(m_buf, 0));
-      if (pretty)
-      {
-        THROW_IF_XML2_ERROR(xmlTextWriterSetIndent(m_writer, 1));
-        THROW_IF_XML2_ERROR(xmlTextWriterSetIndentString(m_writer, BAD_CAST "  "));
-      }
+      m_buffer.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+      m_document = true;
+    }
+    /// @brief write a processing instruction
+    /// @param pi the target and content of the instruction
+    void writeProcessingInstruction(std::string_view pi)
+    {
+      closeStartTag(m_pretty);
+      m_buffer.append("<?").append(pi).append("?>");
+      if (m_pretty)
+        m_buffer.push_back('\n');
     }
 
-    ~XmlWriter()
+    /// @brief open an element
+    /// @param name the element name
+    void startElement(std::string_view name)
     {
-      if (m_writer != nullptr)
+      closeStartTag(m_pretty);
+      m_open.emplace_back(Open {m_names.size(), name.size(), true});
+      m_names.append(name);
+      if (m_pretty)
+        indent();
+      m_buffer.push_back('<');
+      m_buffer.append(name);
+    }
+
+    /// @brief close the last open element
+    /// @return `false` if there is no open element
+    bool endElement()
+    {
+      if (m_open.empty())
+        return false;
+
+      auto &open = m_open.back();
+      if (open.m_startTag)
       {
-        xmlFreeTextWriter(m_writer);
-        m_writer = nullptr;
+        if (m_pretty)
+          m_doIndent = true;
+        m_buffer.append("/>");
       }
-      if (m_buf != nullptr)
+      else
       {
-        xmlBufferFree(m_buf);
-        m_buf = nullptr;
+        if (m_pretty && m_doIndent)
+          indent();
+        m_doIndent = true;
+        m_buffer.append("</").append(m_names, open.m_offset, open.m_length).push_back('>');
       }
+      if (m_pretty)
+        m_buffer.push_back('\n');
+
+      m_names.resize(open.m_offset);
+      m_open.pop_back();
+      return true;
+    }
+
+    /// @brief add an attribute to the element that was just opened
+    /// @param key the attribute name
+    /// @param value the attribute value, escaped for an attribute
+    void writeAttribute(std::string_view key, std::string_view value)
+    {
+      if (m_open.empty() || !m_open.back().m_startTag)
+        throw XmlError("XML Error: attribute " + std::string(key) + " outside of a start tag");
+
+      m_buffer.push_back(' ');
+      m_buffer.append(key).append("=\"");
+      escapeAttribute(value);
+      m_buffer.push_back('"');
+    }
+
+    /// @brief write text content escaping markup characters, quotes and carriage returns
+    /// @param text the text
+    void writeString(std::string_view text)
+    {
+      startText();
+      escapeText(text);
     }
 
-    /// @brief cast this object as a xmlTextWriterPtr
-    /// @return the xmlTextWriterPtr
-    operator xmlTextWriterPtr() { return m_writer; }
+    /// @brief write text content escaping markup characters and carriage returns, other
+    ///        characters outside of ASCII are written as character references
+    /// @param text the text
+    void writeEntities(std::string_view text)
+    {
+      startText();
+      escapeEntities(text);
+    }
 
-    /// @brief Get the content of the buffer as a string. Free the writer if it is allocated.
+    /// @brief write text content as is
+    /// @param text the text
+    void writeRaw(std::string_view text)
+    {
+      startText();
+      m_buffer.append(text);
+    }
+
+    /// @brief Get the content of the buffer as a string closing all open elements. The writer is
+    ///        empty afterwards.
     /// @return content as a string
     std::string getContent()
     {
-      if (m_writer != nullptr)
+      while (!m_open.empty())
+        endElement();
+      if (!m_pretty)
+        m_buffer.push_back('\n');
+      return std::move(m_buffer);
+    }
+
+  protected:
+    struct Open
+    {
+      size_t m_offset;
+      size_t m_length;
+      bool m_startTag;
+    };
+
+    void closeStartTag(bool newline)
+    {
+      if (!m_open.empty() && m_open.back().m_startTag)
       {
-        THROW_IF_XML2_ERROR(xmlTextWriterEndDocument(m_writer));
-        xmlFreeTextWriter(m_writer);
-        m_writer = nullptr;
+        m_buffer.push_back('>');
+        if (newline)
+          m_buffer.push_back('\n');
+        m_open.back().m_startTag = false;
       }
-      return std::string((char *)m_buf->content, m_buf->use);
+    }
+    void startText()
+    {
+      closeStartTag(false);
+      if (m_pretty)
+        m_doIndent = false;
+    }
+    void indent()
+    {
+      for (size_t i = 1; i < m_open.size(); i++)
+        m_buffer.append("  ");
     }
 
+    void escapeText(std::string_view text);
+    void escapeEntities(std::string_view text);
+    void escapeAttribute(std::string_view text);
+
   protected:
-    xmlTextWriterPtr m_writer;
-    xmlBufferPtr m_buf;
+    std::string m_buffer;
+    std::string m_names;
+    std::vector<Open> m_open;
+    bool m_pretty;
+    bool m_doIndent {false};
+    bool m_document {false};
   };
 
   /// @brief Wrapper to create an XML open element
   /// @param writer the writer
   /// @param name the name of the element
-  static inline void openElement(xmlTextWriterPtr writer, const char *name)
+  static inline void openElement(XmlWriter &writer, std::string_view name)
   {
-    THROW_IF_XML2_ERROR(xmlTextWriterStartElement(writer, BAD_CAST name));
+    writer.startElement(name);
   }
 
   /// @brief Close the last open element
   /// @param writer the writer
-  static inline void closeElement(xmlTextWriterPtr writer)
+  static inline void closeElement(XmlWriter &writer)
   {
-    THROW_IF_XML2_ERROR(xmlTextWriterEndElement(writer));
+    if (!writer.endElement())
+      throw XmlError("XML Error: no element to close");
   }
 
   /// @brief Helper class to automatically close an element when the object goes out of scope
@@ -97,12 +211,12 @@ namespace mtconnect::printer {
   public:
     /// @brief Constructor where the element name will be filled in later
     /// @param writer the writer
-    AutoElement(xmlTextWriterPtr writer) : m_writer(writer) {}
+    AutoElement(XmlWriter &writer) : m_writer(writer) {}
     /// @brief Constor where the element is opened
     /// @param writer the writer
     /// @param name name of the element
     /// @param key optional key if the for closing an element and reopening another element
-    AutoElement(xmlTextWriterPtr writer, const char *name, std::string key = "")
+    AutoElement(XmlWriter &writer, const char *name, std::string key = "")
       : m_writer(writer), m_name(name), m_key(std::move(key))
     {
       openElement(writer, name);
@@ -111,10 +225,10 @@ namespace mtconnect::printer {
     /// @param writer the writer
     /// @param name name of the element
     /// @param key optional key if the for closing an element and reopening another element
-    AutoElement(xmlTextWriterPtr writer, const std::string &name, std::string key = "")
+    AutoElement(XmlWriter &writer, const std::string &name, std::string key = "")
       : m_writer(writer), m_name(name), m_key(std::move(key))
     {
-      openElement(writer, name.c_str());
+      openElement(writer, name);
     }
     /// @brief close the currently open element if the name or the key don't match
     /// @param name of the element
@@ -127,7 +241,7 @@ namespace mtconnect::printer {
         if (!m_name.empty())
           closeElement(m_writer);
         if (!name.empty())
-          openElement(m_writer, name.c_str());
+          openElement(m_writer, name);
         m_name = name;
         m_key = key;
         return true;
@@ -141,7 +255,7 @@ namespace mtconnect::printer {
     ~AutoElement()
     {
       if (!m_name.empty())
-        xmlTextWriterEndElement(m_writer);
+        m_writer.endElement();
     }
 
     /// @brief get the key
@@ -152,7 +266,7 @@ namespace mtconnect::printer {
     const std::string &name() const { return m_name; }
 
   protected:
-    xmlTextWriterPtr m_writer;
+    XmlWriter &m_writer;
     std::string m_name;
     std::string m_key;
   };
@@ -21,7 +21,9 @@
 
 #include <date/date.h>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <optional>
 #include <string>
 
 #include "mtconnect/agent.hpp"
@@ -42,6 +44,7 @@
 #include <mruby/data.h>
 #include <mruby/dump.h>
 #include <mruby/error.h>
+#include <mruby/irep.h>
 #include <mruby/numeric.h>
 #include <mruby/presym.h>
 #include <mruby/proc.h>
@@ -64,11 +67,6 @@ namespace mtconnect::ruby {
   using namespace date::literals;
   using namespace observation;
 
-  RClass *RubyObservation::m_eventClass;
-  RClass *RubyObservation::m_sampleClass;
-  RClass *RubyObservation::m_conditionClass;
-
-  std::recursive_mutex RubyVM::m_mutex;
   RubyVM *RubyVM::m_vm = nullptr;
 
   static mrb_value LoadModule(mrb_state *mrb, mrb_value &filename)
@@ -112,6 +110,111 @@ namespace mtconnect::ruby {
     }
   }
 
+  /// @brief compile a module to bytecode
+  ///
+  /// Files ending in `.mrb` are assumed to have been compiled with `mrbc` and are read as is.
+  ///
+  /// @param[in] file the module
+  /// @param[out] bytecode the bytecode
+  /// @return `true` if successful
+  static bool CompileModule(const std::filesystem::path &file, std::string &bytecode)
+  {
+    if (file.extension() == ".mrb")
+    {
+      std::ifstream in(file, std::ios::binary);
+      bytecode.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+      if (bytecode.empty())
+        LOG(error) << "Cannot read bytecode from " << file;
+      return !bytecode.empty();
+    }
+
+    auto fp = fopen(file.string().c_str(), "r");
+    if (fp == NULL)
+    {
+      LOG(error) << "Cannot open file " << file << " for read";
+      return false;
+    }
+
+    // Compile in a scratch state, the bytecode does not depend on the classes in the VM
+    auto mrb = mrb_open();
+    auto mrbc_ctx = mrbc_context_new(mrb);
+    mrbc_filename(mrb, mrbc_ctx, file.string().c_str());
+    auto parser = mrb_parse_file(mrb, fp, mrbc_ctx);
+    fclose(fp);
+
+    bool success = false;
+    if (parser == nullptr)
+    {
+      LOG(error) << "Cannot parse module: " << file;
+    }
+    else if (parser->nerr > 0)
+    {
+      LOG(error) << "Syntax error in " << file << ":" << parser->error_buffer[0].lineno << ": "
+                 << parser->error_buffer[0].message;
+    }
+    else if (auto proc = mrb_generate_code(mrb, parser); proc != nullptr)
+    {
+      uint8_t *bin = nullptr;
+      size_t size = 0;
+      if (mrb_dump_irep(mrb, proc->body.irep, MRB_DUMP_DEBUG_INFO, &bin, &size) == MRB_DUMP_OK)
+      {
+        bytecode.assign(reinterpret_cast<const char *>(bin), size);
+        success = true;
+      }
+      mrb_free(mrb, bin);
+    }
+
+    if (parser != nullptr)
+      mrb_parser_free(parser);
+    mrbc_context_free(mrb, mrbc_ctx);
+    mrb_close(mrb);
+
+    if (!success)
+      LOG(error) << "Failed to compile module: " << file;
+    return success;
+  }
+
+  /// @brief load the module bytecode into a VM, exits if the module raises an exception
+  static void LoadBytecode(RubyVM &vm, const std::string &bytecode,
+                           const std::filesystem::path &file)
+  {
+    lock_guard guard(vm);
+    auto mrb = vm.state();
+
+    int save = mrb_gc_arena_save(mrb);
+    mrb_load_irep_buf(mrb, bytecode.data(), bytecode.size());
+    mrb_gc_arena_restore(mrb, save);
+    if (mrb->exc)
+    {
+      LOG(fatal) << "Error loading file " << file << ": "
+                 << mrb_str_to_cstr(mrb, mrb_inspect(mrb, mrb_obj_value(mrb->exc)));
+      exit(1);
+    }
+
+    LOG(debug) << "Loaded ruby module: " << file;
+  }
+
+  std::shared_ptr<RubyVM> Embedded::createVM(source::SourcePtr source)
+  {
+    auto vm = make_shared<RubyVM>();
+
+    lock_guard guard(*vm);
+
+    auto mrb = vm->state();
+
+    RubyAgent::initialize(mrb, vm->mtconnect(), m_agent);
+    RubyPipeline::initialize(mrb, vm->mtconnect());
+    RubyEntity::initialize(mrb, vm->mtconnect());
+    RubyObservation::initialize(mrb, vm->mtconnect());
+    RubyTransform::initialize(mrb, vm->mtconnect());
+
+    if (source)
+      RubyAgent::setSource(mrb, vm->mtconnect(), source);
+
+    m_rubyVMs.push_back(vm);
+    return vm;
+  }
+
   Embedded::Embedded(Agent *agent, const ConfigOptions &options)
     : m_agent(agent), m_options(options)
   {
@@ -128,69 +231,132 @@ namespace mtconnect::ruby {
     if (!initialization)
       initialization = GetOption<string>(m_options, "initialization");
 
-    if (!m_rubyVM)
+    if (module)
     {
-      m_rubyVM = make_unique<RubyVM>();
+      LOG(info) << "Finding module: " << *module;
 
-      lock_guard guard(*m_rubyVM);
-
-      auto mrb = m_rubyVM->state();
+      std::error_code ec;
+      m_file = canonical(path(*module), ec);
+      if (ec)
+      {
+        LOG(error) << "Cannot open file: " << ec.message();
+        m_file.reset();
+      }
+      else
+      {
+        LOG(info) << "Found module: " << *m_file;
+      }
+    }
 
-      RubyAgent::initialize(mrb, m_rubyVM->mtconnect(), agent);
-      RubyPipeline::initialize(mrb, m_rubyVM->mtconnect());
-      RubyEntity::initialize(mrb, m_rubyVM->mtconnect());
-      RubyObservation::initialize(mrb, m_rubyVM->mtconnect());
-      RubyTransform::initialize(mrb, m_rubyVM->mtconnect());
+    m_perPipeline = IsOptionSet(m_options, "PerPipeline");
+    if (m_perPipeline)
+    {
+      // Compile once and keep the bytecode for the sources added when the adapters are reloaded
+      if (m_file && !CompileModule(*m_file, m_bytecode))
+      {
+        LOG(fatal) << "Failed to load module: " << *m_file;
+        exit(1);
+      }
 
-      if (module)
+      for (auto &source : m_agent->getSources())
       {
-        LOG(info) << "Finding module: " << *module;
+        if (source->getPipeline() == nullptr)
+          continue;
 
-        path mod(*module);
-        std::error_code ec;
-        path file = canonical(mod, ec);
-        if (ec)
+        auto vm = createVM(source);
+        m_sourceVMs[source->getIdentity()] = vm;
+        loadModule(*vm);
+      }
+
+      LOG(info) << "Created " << m_rubyVMs.size() << " ruby VMs, one for each pipeline";
+    }
+    else
+    {
+      auto vm = createVM();
+
+      if (m_file && m_file->extension() == ".mrb")
+      {
+        std::string bytecode;
+        if (!CompileModule(*m_file, bytecode))
         {
-          LOG(error) << "Cannot open file: " << ec.message();
+          LOG(fatal) << "Failed to load module: " << *m_file;
+          exit(1);
         }
-        else
+        LoadBytecode(*vm, bytecode, *m_file);
+      }
+      else if (m_file)
+      {
+        path mod(*module);
+        lock_guard guard(*vm);
+        auto mrb = vm->state();
+
+        try
         {
-          LOG(info) << "Found module: " << file;
-          FILE *fp = nullptr;
-          try
+          int save = mrb_gc_arena_save(mrb);
+          mrb_value filename = mrb_str_new_cstr(mrb, mod.string().c_str());
+          mrb_bool state = false;
+          mrb_value res = mrb_protect(
+              mrb, [](mrb_state *mrb, mrb_value filename) { return LoadModule(mrb, filename); },
+              filename, &state);
+          mrb_gc_arena_restore(mrb, save);
+          if (state)
           {
-            int save = mrb_gc_arena_save(mrb);
-            mrb_value file = mrb_str_new_cstr(mrb, mod.string().c_str());
-            mrb_bool state = false;
-            mrb_value res = mrb_protect(
-                mrb, [](mrb_state *mrb, mrb_value filename) { return LoadModule(mrb, filename); },
-                file, &state);
-            mrb_gc_arena_restore(mrb, save);
-            if (state)
-            {
-              LOG(fatal) << "Error loading file " << mod << ": "
-                         << mrb_str_to_cstr(mrb, mrb_inspect(mrb, res));
-              exit(1);
-            }
-          }
-          catch (std::exception ex)
-          {
-            LOG(fatal) << "Failed to load module: " << mod << ": " << ex.what();
+            LOG(fatal) << "Error loading file " << mod << ": "
+                       << mrb_str_to_cstr(mrb, mrb_inspect(mrb, res));
             exit(1);
           }
-          catch (...)
-          {
-            LOG(fatal) << "Failed to load module: " << mod;
-            exit(1);
-          }
-          if (fp != nullptr)
-          {
-            fclose(fp);
-          }
+        }
+        catch (std::exception ex)
+        {
+          LOG(fatal) << "Failed to load module: " << mod << ": " << ex.what();
+          exit(1);
+        }
+        catch (...)
+        {
+          LOG(fatal) << "Failed to load module: " << mod;
+          exit(1);
         }
       }
     }
   }
 
-  Embedded::~Embedded() { m_rubyVM.reset(); }
+  void Embedded::loadModule(RubyVM &vm)
+  {
+    if (m_file)
+      LoadBytecode(vm, m_bytecode, *m_file);
+  }
+
+  void Embedded::addSource(source::SourcePtr source)
+  {
+    NAMED_SCOPE("Ruby::Embedded::addSource");
+
+    if (source->getPipeline() == nullptr)
+      return;
+
+    if (m_perPipeline)
+    {
+      removeSource(source);
+      auto vm = createVM(source);
+      m_sourceVMs[source->getIdentity()] = vm;
+      loadModule(*vm);
+    }
+    else if (m_file)
+    {
+      // Running the module again would repeat its top level side effects in the shared VM
+      LOG(warning) << "The ruby module is not loaded for the reloaded adapter "
+                   << source->getName() << ", set PerPipeline to reload it with the adapters";
+    }
+  }
+
+  void Embedded::removeSource(source::SourcePtr source)
+  {
+    auto it = m_sourceVMs.find(source->getIdentity());
+    if (it != m_sourceVMs.end())
+    {
+      m_rubyVMs.remove(it->second);
+      m_sourceVMs.erase(it);
+    }
+  }
+
+  Embedded::~Embedded() { m_rubyVMs.clear(); }
 }  // namespace mtconnect::ruby
@@ -19,17 +19,29 @@
 
 #include <boost/asio.hpp>
 
+#include <filesystem>
+#include <list>
+#include <map>
 #include <memory>
+#include <optional>
 
 #include "mtconnect/config.hpp"
 #include "mtconnect/utilities.hpp"
 
 namespace mtconnect {
   class Agent;
+  namespace source {
+    class Source;
+    using SourcePtr = std::shared_ptr<Source>;
+  }  // namespace source
   /// @brief Embedded MRuby namespace
   namespace ruby {
     class RubyVM;
     /// @brief Static wrapper classes that add types to the Ruby instance
+    ///
+    /// By default all pipelines share one VM. When `PerPipeline` is set, each source gets its own
+    /// VM so the transforms of different pipelines do not serialize on one lock. The module is
+    /// compiled once and the bytecode is loaded into every VM.
     class AGENT_LIB_API Embedded
     {
     public:
@@ -37,11 +49,32 @@ namespace mtconnect {
       Embedded(Agent *agent, const ConfigOptions &options);
       ~Embedded();
 
+      /// @brief get the number of ruby VMs
+      size_t getVMCount() const { return m_rubyVMs.size(); }
+
+      /// @brief load the module for a source added after the agent started
+      ///
+      /// With `PerPipeline` a VM is created for the source and the module is loaded into it.
+      /// The shared VM does not load the module again, so the source has no ruby transforms.
+      /// @param[in] source the new source
+      void addSource(source::SourcePtr source);
+      /// @brief release the VM created for a source that was removed
+      /// @param[in] source the removed source
+      void removeSource(source::SourcePtr source);
+
+    protected:
+      std::shared_ptr<RubyVM> createVM(source::SourcePtr source = nullptr);
+      void loadModule(RubyVM &vm);
+
     protected:
       Agent *m_agent;
       ConfigOptions m_options;
       boost::asio::io_context *m_context = nullptr;
-      std::unique_ptr<RubyVM> m_rubyVM;
+      std::list<std::shared_ptr<RubyVM>> m_rubyVMs;
+      std::map<std::string, std::shared_ptr<RubyVM>> m_sourceVMs;
+      std::optional<std::filesystem::path> m_file;
+      std::string m_bytecode;
+      bool m_perPipeline = false;
     };
   }  // namespace ruby
 }  // namespace mtconnect
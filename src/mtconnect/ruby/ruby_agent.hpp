@@ -181,6 +181,39 @@ namespace mtconnect::ruby {
           },
           MRB_ARGS_REQ(1));
     }
+
+    /// @brief associate a VM with the source it runs the transforms for
+    ///
+    /// Used when each pipeline has its own VM. Defines `MTConnect.source` and
+    /// `MTConnect.pipeline` so the module can find the pipeline to modify.
+    ///
+    /// @param[in] mrb The ruby state
+    /// @param[in] module The MTConnect module
+    /// @param[in] source The source
+    static void setSource(mrb_state *mrb, RClass *module, source::SourcePtr source)
+    {
+      mrb_value sourceValue = MRubySharedPtr<source::Source>::wrap(mrb, "Source", source);
+      auto ivar = mrb_intern_cstr(mrb, "@source");
+      auto mod = mrb_obj_value(module);
+      mrb_iv_set(mrb, mod, ivar, sourceValue);
+
+      mrb_define_class_method(
+          mrb, module, "source",
+          [](mrb_state *mrb, mrb_value self) {
+            auto ivar = mrb_intern_cstr(mrb, "@source");
+            return mrb_iv_get(mrb, self, ivar);
+          },
+          MRB_ARGS_NONE());
+
+      mrb_define_class_method(
+          mrb, module, "pipeline",
+          [](mrb_state *mrb, mrb_value self) {
+            auto ivar = mrb_intern_cstr(mrb, "@source");
+            auto source = MRubySharedPtr<source::Source>::unwrap(mrb, mrb_iv_get(mrb, self, ivar));
+            return MRubyPtr<pipeline::Pipeline>::wrap(mrb, "Pipeline", source->getPipeline());
+          },
+          MRB_ARGS_NONE());
+    }
   };
 
   /// @struct RubyAgent
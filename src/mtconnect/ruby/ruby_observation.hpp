@@ -28,24 +28,20 @@ namespace mtconnect::ruby {
 
   struct RubyObservation
   {
-    static RClass *m_eventClass;
-    static RClass *m_sampleClass;
-    static RClass *m_conditionClass;
-
     static void initialize(mrb_state *mrb, RClass *module)
     {
       auto entityClass = mrb_class_get_under(mrb, module, "Entity");
       auto observationClass = mrb_define_class_under(mrb, module, "Observation", entityClass);
       MRB_SET_INSTANCE_TT(observationClass, MRB_TT_DATA);
 
-      m_eventClass = mrb_define_class_under(mrb, module, "Event", observationClass);
-      MRB_SET_INSTANCE_TT(m_eventClass, MRB_TT_DATA);
+      auto eventClass = mrb_define_class_under(mrb, module, "Event", observationClass);
+      MRB_SET_INSTANCE_TT(eventClass, MRB_TT_DATA);
 
-      m_sampleClass = mrb_define_class_under(mrb, module, "Sample", observationClass);
-      MRB_SET_INSTANCE_TT(m_sampleClass, MRB_TT_DATA);
+      auto sampleClass = mrb_define_class_under(mrb, module, "Sample", observationClass);
+      MRB_SET_INSTANCE_TT(sampleClass, MRB_TT_DATA);
 
-      m_conditionClass = mrb_define_class_under(mrb, module, "Condition", observationClass);
-      MRB_SET_INSTANCE_TT(m_conditionClass, MRB_TT_DATA);
+      auto conditionClass = mrb_define_class_under(mrb, module, "Condition", observationClass);
+      MRB_SET_INSTANCE_TT(conditionClass, MRB_TT_DATA);
 
       mrb_define_class_method(
           mrb, observationClass, "make",
@@ -65,19 +61,22 @@ namespace mtconnect::ruby {
               ts = toRuby(mrb, time);
             }
 
+            // Classes are looked up in the state making the call since there may be more than
+            // one VM
+            auto mod = mrb_module_get(mrb, "MTConnect");
             struct RClass *klass;
             switch (dataItem->getCategory())
             {
               case DataItem::SAMPLE:
-                klass = m_sampleClass;
+                klass = mrb_class_get_under(mrb, mod, "Sample");
                 break;
 
               case DataItem::EVENT:
-                klass = m_eventClass;
+                klass = mrb_class_get_under(mrb, mod, "Event");
                 break;
 
               case DataItem::CONDITION:
-                klass = m_conditionClass;
+                klass = mrb_class_get_under(mrb, mod, "Condition");
                 break;
             }
 
@@ -162,7 +161,7 @@ namespace mtconnect::ruby {
           MRB_ARGS_NONE());
 
       mrb_define_method(
-          mrb, m_conditionClass, "level",
+          mrb, conditionClass, "level",
           [](mrb_state *mrb, mrb_value self) {
             ObservationPtr obs = MRubySharedPtr<Entity>::unwrap<Observation>(mrb, self);
             auto cond = std::dynamic_pointer_cast<Condition>(obs);
@@ -191,7 +190,7 @@ namespace mtconnect::ruby {
           MRB_ARGS_NONE());
 
       mrb_define_method(
-          mrb, m_conditionClass, "level=",
+          mrb, conditionClass, "level=",
           [](mrb_state *mrb, mrb_value self) {
             ObservationPtr obs = MRubySharedPtr<Entity>::unwrap<Observation>(mrb, self);
             auto cond = std::dynamic_pointer_cast<Condition>(obs);
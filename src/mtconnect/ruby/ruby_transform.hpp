@@ -153,6 +153,7 @@ namespace mtconnect::ruby {
 
     RubyTransform(mrb_state *mrb, mrb_value self, const std::string &name, const string &guard)
       : Transform(name),
+        m_vm(RubyVM::of(mrb).weak_from_this()),
         m_self(self),
         m_method(mrb_intern_lit(mrb, "transform")),
         m_block(mrb_nil_value()),
@@ -164,10 +165,11 @@ namespace mtconnect::ruby {
 
     ~RubyTransform()
     {
-      std::lock_guard guard(RubyVM::rubyVM());
-      if (RubyVM::hasVM())
+      // The VM is already gone if it is being closed
+      if (auto vm = m_vm.lock())
       {
-        auto mrb = RubyVM::rubyVM().state();
+        std::lock_guard guard(*vm);
+        auto mrb = vm->state();
 
         mrb_gc_unregister(mrb, m_self);
         m_self = mrb_nil_value();
@@ -189,9 +191,12 @@ namespace mtconnect::ruby {
         m_guard = [this, old = m_guard](const entity::Entity *entity) -> GuardAction {
           using namespace entity;
           using namespace observation;
-          std::lock_guard guard(RubyVM::rubyVM());
+          auto vm = m_vm.lock();
+          if (!vm)
+            return old(entity);
+          std::lock_guard guard(*vm);
 
-          auto mrb = RubyVM::rubyVM().state();
+          auto mrb = vm->state();
           int save = mrb_gc_arena_save(mrb);
 
           entity::EntityPtr ptr = entity->getptr();
@@ -260,8 +265,11 @@ namespace mtconnect::ruby {
 
       EntityPtr res;
 
-      std::lock_guard guard(RubyVM::rubyVM());
-      auto mrb = RubyVM::rubyVM().state();
+      auto vm = m_vm.lock();
+      if (!vm)
+        return res;
+      std::lock_guard guard(*vm);
+      auto mrb = vm->state();
       int save = mrb_gc_arena_save(mrb);
 
       try
@@ -345,11 +353,15 @@ namespace mtconnect::ruby {
       return res;
     }
 
+    /// @brief get the VM the transform runs in
+    std::shared_ptr<RubyVM> getVM() const { return m_vm.lock(); }
+
     auto &object() { return m_self; }
     void setObject(mrb_value obj) { m_self = obj; }
 
   protected:
     PipelineContract *m_contract;
+    std::weak_ptr<RubyVM> m_vm;
     mrb_value m_self;
     mrb_sym m_method;
     mrb_value m_block;
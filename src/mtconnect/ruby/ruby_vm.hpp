@@ -20,7 +20,12 @@
 #include "mtconnect/config.hpp"
 
 namespace mtconnect::ruby {
-  class AGENT_LIB_API RubyVM
+  /// @brief An mruby interpreter with the MTConnect module
+  ///
+  /// Each VM has its own lock, so pipelines running in different VMs do not contend with each
+  /// other. Transforms find their VM through the `ud` pointer of the `mrb_state` and hold a
+  /// weak reference to it, so VMs must be owned by a `std::shared_ptr`.
+  class AGENT_LIB_API RubyVM : public std::enable_shared_from_this<RubyVM>
   {
   public:
     RubyVM()
@@ -32,15 +37,18 @@ namespace mtconnect::ruby {
         throw std::runtime_error("Cannot start mrb");
       }
 
+      m_mrb->ud = this;
       createModule();
       defineLogger();
 
-      m_vm = this;
+      if (m_vm == nullptr)
+        m_vm = this;
     }
 
     ~RubyVM()
     {
-      m_vm = nullptr;
+      if (m_vm == this)
+        m_vm = nullptr;
       std::lock_guard guard(m_mutex);
       if (m_mrb)
       {
@@ -53,8 +61,14 @@ namespace mtconnect::ruby {
 
     void lock() { m_mutex.lock(); }
     void unlock() { m_mutex.unlock(); }
-    void try_lock() { m_mutex.try_lock(); }
+    bool try_lock() { return m_mutex.try_lock(); }
 
+    /// @brief get the VM that owns a ruby state
+    /// @param[in] mrb the ruby state
+    /// @return the VM
+    static RubyVM &of(mrb_state *mrb) { return *static_cast<RubyVM *>(mrb->ud); }
+
+    /// @brief get the first VM created, the shared VM unless there is one VM per pipeline
     static auto &rubyVM() { return *m_vm; }
     static bool hasVM() { return m_vm != nullptr; }
 
@@ -123,7 +137,7 @@ namespace mtconnect::ruby {
     Agent *m_agent;
     RClass *m_module = nullptr;
     mrb_state *m_mrb = nullptr;
-    static std::recursive_mutex m_mutex;
+    std::recursive_mutex m_mutex;
     static RubyVM *m_vm;
   };
 }  // namespace mtconnect::ruby
@@ -17,6 +17,8 @@
 
 #include "mqtt_service.hpp"
 
+#include <algorithm>
+
 #include "mtconnect/configuration/config_options.hpp"
 #include "mtconnect/entity/entity.hpp"
 #include "mtconnect/entity/factory.hpp"
@@ -41,9 +43,17 @@ namespace mtconnect {
 
       MqttService::MqttService(boost::asio::io_context &context, sink::SinkContractPtr &&contract,
                                const ConfigOptions &options, const ptree &config)
-        : Sink("MqttService", std::move(contract)), m_context(context), m_options(options)
+        : Sink("MqttService", std::move(contract)),
+          m_context(context),
+          m_strand(context),
+          m_flushTimer(context),
+          m_options(options),
+          m_sampleTimer(context),
+          m_currentTimer(context)
       {
         auto jsonPrinter = dynamic_cast<printer::JsonPrinter *>(m_sinkContract->getPrinter("json"));
+        m_printer = jsonPrinter;
+        m_instanceId = getCurrentTimeInSec();
         m_jsonPrinter = make_unique<entity::JsonEntityPrinter>(jsonPrinter->getJsonVersion());
 
         GetOptions(config, m_options, options);
@@ -57,39 +67,33 @@ namespace mtconnect {
                              {configuration::DeviceTopic, "MTConnect/Device/"s},
                              {configuration::AssetTopic, "MTConnect/Asset/"s},
                              {configuration::ObservationTopic, "MTConnect/Observation/"s},
+                             {configuration::SampleTopic, "MTConnect/Sample/"s},
+                             {configuration::CurrentTopic, "MTConnect/Current/"s},
                              {configuration::MqttPort, 1883},
-                             {configuration::MqttTls, false}});
+                             {configuration::MqttTls, false},
+                             {configuration::MqttFlushInterval, 0ms},
+                             {configuration::MqttDeviceBatch, false},
+                             {configuration::MqttMaxInFlight, 0},
+                             {configuration::MqttSampleInterval, 0ms},
+                             {configuration::MqttSampleCount, 1000},
+                             {configuration::MqttCurrentInterval, 0ms}});
 
         auto clientHandler = make_unique<ClientHandler>();
         clientHandler->m_connected = [this](shared_ptr<MqttClient> client) {
-          // Publish latest devices, assets, and observations
-          auto &circ = m_sinkContract->getCircularBuffer();
-          std::lock_guard<buffer::CircularBuffer> lock(circ);
           client->connectComplete();
-
-          for (auto &dev : m_sinkContract->getDevices())
-          {
-            publish(dev);
-          }
-
-          auto obsList {circ.getLatest().getObservations()};
-          for (auto &obs : obsList)
-          {
-            observation::ObservationPtr p {obs.second};
-            publish(p);
-          }
-
-          AssetList list;
-          m_sinkContract->getAssetStorage()->getAssets(list, 100000);
-          for (auto &asset : list)
-          {
-            publish(asset);
-          }
+          startReplay(client);
         };
 
         m_devicePrefix = get<string>(m_options[configuration::DeviceTopic]);
         m_assetPrefix = get<string>(m_options[configuration::AssetTopic]);
         m_observationPrefix = get<string>(m_options[configuration::ObservationTopic]);
+        m_flushInterval = *GetOption<Milliseconds>(m_options, configuration::MqttFlushInterval);
+        m_deviceBatch = IsOptionSet(m_options, configuration::MqttDeviceBatch);
+        m_samplePrefix = get<string>(m_options[configuration::SampleTopic]);
+        m_currentPrefix = get<string>(m_options[configuration::CurrentTopic]);
+        m_sampleInterval = *GetOption<Milliseconds>(m_options, configuration::MqttSampleInterval);
+        m_sampleCount = *GetOption<int>(m_options, configuration::MqttSampleCount);
+        m_currentInterval = *GetOption<Milliseconds>(m_options, configuration::MqttCurrentInterval);
 
         if (IsOptionSet(m_options, configuration::MqttTls))
         {
@@ -108,10 +112,19 @@ namespace mtconnect {
           return;
 
         m_client->start();
+
+        if (m_sampleInterval.count() > 0)
+          schedule(m_sampleTimer, m_sampleInterval, &MqttService::publishSamples);
+        if (m_currentInterval.count() > 0)
+          schedule(m_currentTimer, m_currentInterval, &MqttService::publishCurrent);
       }
 
       void MqttService::stop()
       {
+        m_flushTimer.cancel();
+        m_sampleTimer.cancel();
+        m_currentTimer.cancel();
+
         // stop client side
         if (m_client)
           m_client->stop();
@@ -119,28 +132,315 @@ namespace mtconnect {
 
       std::shared_ptr<MqttClient> MqttService::getClient() { return m_client; }
 
-      bool MqttService::publish(observation::ObservationPtr &observation)
+      std::string MqttService::observationTopic(const DataItemPtr &dataItem)
       {
-        // get the data item from observation
-        if (observation->isOrphan())
-          return false;
+        std::lock_guard<std::mutex> lock(m_topicMutex);
+        auto it = m_observationTopics.find(dataItem->getId());
+        if (it == m_observationTopics.end())
+          it = m_observationTopics
+                   .emplace(dataItem->getId(), m_observationPrefix + dataItem->getTopic())
+                   .first;
+        return it->second;
+      }
+
+      void MqttService::startReplay(std::shared_ptr<MqttClient> client)
+      {
+        NAMED_SCOPE("MqttService::startReplay");
 
-        DataItemPtr dataItem = observation->getDataItem();
+        auto replay = make_shared<Replay>();
 
-        auto topic = m_observationPrefix + dataItem->getTopic();  // client asyn topic
-        auto content = dataItem->getTopicName();                  // client asyn content
+        // Only copy the pointers while holding the buffer lock so ingestion is not blocked
+        // while the snapshot is published.
+        {
+          auto &circ = m_sinkContract->getCircularBuffer();
+          std::lock_guard<buffer::CircularBuffer> lock(circ);
+          const auto &latest = circ.getLatest().getObservations();
+          replay->m_observations.reserve(latest.size());
+          for (auto &obs : latest)
+            replay->m_observations.emplace_back(obs.second);
+
+          // Any observation published after this point is newer than the snapshot
+          std::lock_guard<std::mutex> replayLock(m_replayMutex);
+          m_replay = replay;
+        }
+
+        AssetList list;
+        m_sinkContract->getAssetStorage()->getAssets(list, 100000);
+        replay->m_assetIds.reserve(list.size());
+        for (auto &asset : list)
+          replay->m_assetIds.emplace_back(asset->getAssetId());
+
+        sort(replay->m_observations.begin(), replay->m_observations.end(),
+             [](const auto &a, const auto &b) { return a->getSequence() < b->getSequence(); });
+
+        LOG(debug) << "Replaying " << replay->m_observations.size() << " observations and "
+                   << replay->m_assetIds.size() << " assets";
+
+        // The devices are small and are needed by consumers before the observations
+        for (auto &dev : m_sinkContract->getDevices())
+        {
+          publish(dev);
+        }
+
+        asio::post(m_strand, [this, ptr = getptr(), replay]() { this->replay(replay); });
+      }
+
+      void MqttService::replay(std::shared_ptr<Replay> replay)
+      {
+        NAMED_SCOPE("MqttService::replay");
+
+        if (!m_client || !m_client->isConnected())
+          return;
+
+        size_t count = 0;
+        while (count < REPLAY_BATCH_SIZE &&
+               replay->m_nextObservation < replay->m_observations.size())
+        {
+          auto &obs = replay->m_observations[replay->m_nextObservation++];
+
+          // Skip data items that already have a newer value published. The lock is held
+          // while publishing so a newer value cannot be published between the check and
+          // the publish and then be overwritten by the older value.
+          std::lock_guard<std::mutex> lock(m_replayMutex);
+          if (m_replay != replay)
+            return;
+          if (obs->isOrphan() || replay->m_published.count(obs->getDataItem()->getId()) > 0)
+            continue;
+          publishObservation(obs);
+          count++;
+        }
+
+        // Assets are fetched when they are published so the current version is sent
+        auto storage = m_sinkContract->getAssetStorage();
+        while (count < REPLAY_BATCH_SIZE && replay->m_nextAsset < replay->m_assetIds.size())
+        {
+          auto asset = storage->getAsset(replay->m_assetIds[replay->m_nextAsset++]);
+          if (asset)
+          {
+            publish(asset);
+            count++;
+          }
+        }
+
+        std::lock_guard<std::mutex> lock(m_replayMutex);
+        if (m_replay != replay)
+          return;
+
+        if (replay->m_nextObservation < replay->m_observations.size() ||
+            replay->m_nextAsset < replay->m_assetIds.size())
+        {
+          // Yield to the other work on the context between batches
+          asio::post(m_strand, [this, ptr = getptr(), replay]() { this->replay(replay); });
+        }
+        else
+        {
+          LOG(debug) << "Replay complete";
+          m_replay.reset();
+        }
+      }
+
+      void MqttService::publishObservation(const observation::ObservationPtr &observation)
+      {
+        auto topic = observationTopic(observation->getDataItem());
 
         // We may want to use the observation from the checkpoint.
         auto doc = m_jsonPrinter->printEntity(observation);
 
         if (m_client)
           m_client->publish(topic, doc);
+      }
+
+      bool MqttService::publish(observation::ObservationPtr &observation)
+      {
+        // get the data item from observation
+        if (observation->isOrphan())
+          return false;
+
+        {
+          std::lock_guard<std::mutex> lock(m_replayMutex);
+          if (m_replay)
+            m_replay->m_published.insert(observation->getDataItem()->getId());
+        }
+
+        if (m_flushInterval.count() == 0)
+        {
+          publishObservation(observation);
+          return true;
+        }
+
+        // Coalesce repeated updates of a data item to the latest value in the window
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        auto res = m_pendingIndex.try_emplace(observation->getDataItem()->getId(), m_pending.size());
+        if (res.second)
+          m_pending.emplace_back(observation);
+        else
+          m_pending[res.first->second] = observation;
+
+        if (!m_flushScheduled)
+        {
+          m_flushScheduled = true;
+          m_flushTimer.expires_after(m_flushInterval);
+          m_flushTimer.async_wait(boost::asio::bind_executor(
+              m_strand, [this, ptr = getptr()](boost::system::error_code ec) {
+                if (!ec)
+                  flush();
+              }));
+        }
 
         return true;
       }
 
+      void MqttService::flush()
+      {
+        NAMED_SCOPE("MqttService::flush");
+
+        std::vector<observation::ObservationPtr> pending;
+        {
+          std::lock_guard<std::mutex> lock(m_pendingMutex);
+          pending.swap(m_pending);
+          m_pendingIndex.clear();
+          m_flushScheduled = false;
+        }
+
+        if (!m_client)
+          return;
+
+        if (m_deviceBatch)
+        {
+          // One array of observations per device, in arrival order
+          std::map<std::string, std::string> batches;
+          for (auto &obs : pending)
+          {
+            auto dataItem = obs->getDataItem();
+            if (!dataItem)
+              continue;
+            auto device = dataItem->getComponent()->getDevice();
+            auto &batch = batches[*device->getUuid()];
+            batch.append(batch.empty() ? "[" : ",");
+            batch.append(m_jsonPrinter->print(obs));
+          }
+
+          for (auto &[uuid, batch] : batches)
+          {
+            batch.append("]");
+            m_client->publish(m_observationPrefix + uuid, batch);
+          }
+        }
+        else
+        {
+          for (auto &obs : pending)
+          {
+            auto dataItem = obs->getDataItem();
+            if (dataItem)
+              m_client->publish(observationTopic(dataItem), m_jsonPrinter->printEntity(obs));
+          }
+        }
+      }
+
+      void MqttService::schedule(boost::asio::steady_timer &timer,
+                                 std::chrono::milliseconds interval, void (MqttService::*publish)())
+      {
+        timer.expires_after(interval);
+        timer.async_wait(asio::bind_executor(
+            m_strand, [this, ptr = getptr(), &timer, interval, publish](boost::system::error_code ec) {
+              if (ec)
+                return;
+
+              if (m_client && m_client->isConnected())
+                (this->*publish)();
+              schedule(timer, interval, publish);
+            }));
+      }
+
+      std::map<std::string, MqttService::DeviceWindow> &MqttService::deviceWindows()
+      {
+        // Filters are dropped when a device is published, rebuild on the strand
+        for (auto &dev : m_sinkContract->getDevices())
+        {
+          auto &window = m_deviceWindows[*dev->getUuid()];
+          if (window.m_filter.empty())
+            m_sinkContract->getDataItemsForPath(dev, nullopt, window.m_filter);
+        }
+
+        return m_deviceWindows;
+      }
+
+      void MqttService::publishSamples()
+      {
+        NAMED_SCOPE("MqttService::publishSamples");
+
+        auto &circ = m_sinkContract->getCircularBuffer();
+        for (auto &[uuid, window] : deviceWindows())
+        {
+          std::unique_ptr<observation::ObservationList> observations;
+          SequenceNumber_t end, firstSeq, lastSeq;
+          bool endOfBuffer;
+          {
+            std::lock_guard<buffer::CircularBuffer> lock(circ);
+            lastSeq = circ.getSequence() - 1;
+            if (window.m_next == 0)
+              window.m_next = circ.getSequence();
+
+            // If the window fell out of the buffer, the first sequence tells the consumer
+            // about the gap.
+            auto from = std::max(window.m_next, circ.getFirstSequence());
+            observations = circ.getObservations(m_sampleCount, window.m_filter, from, nullopt, end,
+                                                firstSeq, endOfBuffer);
+          }
+
+          window.m_next = end;
+          if (observations->empty())
+            continue;
+
+          auto doc = m_printer->printSample(m_instanceId, circ.getBufferSize(), end, firstSeq,
+                                            lastSeq, *observations);
+          m_client->publish(m_samplePrefix + uuid, doc);
+        }
+      }
+
+      void MqttService::publishCurrent()
+      {
+        NAMED_SCOPE("MqttService::publishCurrent");
+
+        auto &circ = m_sinkContract->getCircularBuffer();
+        {
+          // Nothing to publish if no observations have arrived since the last period
+          std::lock_guard<buffer::CircularBuffer> lock(circ);
+          if (circ.getSequence() == m_lastCurrent)
+            return;
+          m_lastCurrent = circ.getSequence();
+        }
+
+        for (auto &[uuid, window] : deviceWindows())
+        {
+          observation::ObservationList observations;
+          SequenceNumber_t firstSeq, seq;
+          {
+            std::lock_guard<buffer::CircularBuffer> lock(circ);
+            firstSeq = circ.getFirstSequence();
+            seq = circ.getSequence();
+            circ.getLatest().getObservations(observations, window.m_filter);
+          }
+
+          auto doc = m_printer->printSample(m_instanceId, circ.getBufferSize(), seq, firstSeq,
+                                            seq - 1, observations);
+          m_client->publish(m_currentPrefix + uuid, doc);
+        }
+      }
+
       bool MqttService::publish(device_model::DevicePtr device)
       {
+        // The device model may have changed, recompute the topics and filters
+        {
+          std::lock_guard<std::mutex> lock(m_topicMutex);
+          m_observationTopics.clear();
+        }
+        asio::post(m_strand, [this, ptr = getptr(), uuid = *device->getUuid()]() {
+          auto window = m_deviceWindows.find(uuid);
+          if (window != m_deviceWindows.end())
+            window->second.m_filter.clear();
+        });
+
         auto topic = m_devicePrefix + *device->getUuid();
         auto doc = m_jsonPrinter->print(device);
 
@@ -18,8 +18,15 @@
 #pragma once
 
 #include "boost/asio/io_context.hpp"
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/io_context_strand.hpp>
 #include <boost/dll/alias.hpp>
 
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "mtconnect/buffer/checkpoint.hpp"
 #include "mtconnect/config.hpp"
 #include "mtconnect/configuration/agent_config.hpp"
@@ -92,13 +99,106 @@ namespace mtconnect {
         /// @return `true` when the client was connected
         bool isConnected() { return m_client && m_client->isConnected(); }
 
+      protected:
+        /// @brief get the interned observation topic for a data item
+        /// @param dataItem the data item
+        /// @return the topic with the observation prefix
+        std::string observationTopic(const DataItemPtr &dataItem);
+
+        /// @brief publish the observations coalesced during the flush window
+        void flush();
+
+        /// @brief Snapshot of the agent state to publish after a connect
+        struct Replay
+        {
+          std::vector<observation::ObservationPtr> m_observations;
+          std::vector<std::string> m_assetIds;
+          size_t m_nextObservation {0};
+          size_t m_nextAsset {0};
+          /// @brief data items published by the agent while the replay is running
+          std::unordered_set<std::string> m_published;
+        };
+
+        /// @brief take a snapshot of the latest observations and assets and publish it
+        ///        asynchronously
+        /// @param client the connected client
+        void startReplay(std::shared_ptr<MqttClient> client);
+
+        /// @brief publish the next batch of the replay and schedule the following batch
+        /// @param replay the replay state
+        void replay(std::shared_ptr<Replay> replay);
+
+        /// @brief publish an observation to its data item topic
+        /// @param observation the observation
+        void publishObservation(const observation::ObservationPtr &observation);
+
+        /// @brief Filter and position of the periodic documents for a device
+        struct DeviceWindow
+        {
+          FilterSet m_filter;
+          SequenceNumber_t m_next {0};
+        };
+
+        /// @brief get the windows for all devices, building any missing filters
+        /// @return the device windows by uuid
+        std::map<std::string, DeviceWindow> &deviceWindows();
+
+        /// @brief schedule a periodic document timer
+        /// @param timer the timer
+        /// @param interval the period
+        /// @param publish the function publishing the documents
+        void schedule(boost::asio::steady_timer &timer, std::chrono::milliseconds interval,
+                      void (MqttService::*publish)());
+
+        /// @brief publish the observations since the last sample document for every device
+        void publishSamples();
+
+        /// @brief publish a current document for every device
+        void publishCurrent();
+
+        /// @brief number of observations or assets published per replay batch
+        static constexpr size_t REPLAY_BATCH_SIZE = 500;
+
       protected:
         std::string m_devicePrefix;
         std::string m_assetPrefix;
         std::string m_observationPrefix;
 
         boost::asio::io_context &m_context;
+        boost::asio::io_context::strand m_strand;
+        boost::asio::steady_timer m_flushTimer;
         ConfigOptions m_options;
+
+        // Topic strings by data item id
+        std::mutex m_topicMutex;
+        std::unordered_map<std::string, std::string> m_observationTopics;
+
+        // Latest observation of each data item waiting for the flush timer
+        std::chrono::milliseconds m_flushInterval {0};
+        bool m_deviceBatch {false};
+        std::mutex m_pendingMutex;
+        std::vector<observation::ObservationPtr> m_pending;
+        std::unordered_map<std::string, size_t> m_pendingIndex;
+        bool m_flushScheduled {false};
+
+        // Periodic sample and current documents
+        std::string m_samplePrefix;
+        std::string m_currentPrefix;
+        uint64_t m_instanceId;
+        const printer::Printer *m_printer {nullptr};
+        std::chrono::milliseconds m_sampleInterval {0};
+        int m_sampleCount {0};
+        std::chrono::milliseconds m_currentInterval {0};
+        boost::asio::steady_timer m_sampleTimer;
+        boost::asio::steady_timer m_currentTimer;
+        std::map<std::string, DeviceWindow> m_deviceWindows;
+        SequenceNumber_t m_lastCurrent {0};
+
+        // Snapshot being published after a connect. The mutex is held while the replay
+        // checks and publishes an observation.
+        std::mutex m_replayMutex;
+        std::shared_ptr<Replay> m_replay;
+
         std::unique_ptr<JsonEntityPrinter> m_jsonPrinter;
         std::shared_ptr<MqttClient> m_client;
       };
@@ -57,16 +57,17 @@ namespace mtconnect::sink::rest_sink {
   /// The request can be a simple reply response or streaming request
   struct Request
   {
-    boost::beast::http::verb m_verb;  ///< GET, PUT, POST, or DELETE
-    std::string m_body;               ///< The body of the request
-    std::string m_accepts;            ///< The accepts header
-    std::string m_acceptsEncoding;    ///< Encodings that can be returned
-    std::string m_contentType;        ///< The content type for the body
-    std::string m_path;               ///< The URI for the request
-    std::string m_foreignIp;          ///< The requestors IP Address
-    uint16_t m_foreignPort;           ///< The requestors Port
-    QueryMap m_query;                 ///< The parsed query parameters
-    ParameterMap m_parameters;        ///< The parsed path parameters
+    boost::beast::http::verb m_verb;           ///< GET, PUT, POST, or DELETE
+    std::string m_body;                        ///< The body of the request
+    std::string m_accepts;                     ///< The accepts header
+    std::string m_acceptsEncoding;             ///< Encodings that can be returned
+    std::string m_contentType;                 ///< The content type for the body
+    std::string m_path;                        ///< The URI for the request
+    std::optional<std::string> m_lastEventId;  ///< The server-sent events `Last-Event-ID`
+    std::string m_foreignIp;                   ///< The requestors IP Address
+    uint16_t m_foreignPort;                    ///< The requestors Port
+    QueryMap m_query;                          ///< The parsed query parameters
+    ParameterMap m_parameters;                 ///< The parsed path parameters
 
     /// @brief Find a parameter by type
     /// @tparam T the type of the parameter
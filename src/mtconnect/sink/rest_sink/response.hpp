@@ -21,6 +21,7 @@
 #include <boost/beast/http/status.hpp>
 
 #include <filesystem>
+#include <list>
 #include <unordered_map>
 
 #include "cached_file.hpp"
@@ -42,9 +43,9 @@ namespace mtconnect {
       /// @param[in] status the status
       /// @param[in] body the body of the response
       /// @param[in] mimeType the mime type of the response
-      Response(status status = status::ok, const std::string &body = "",
+      Response(status status = status::ok, std::string body = "",
                const std::string &mimeType = "text/xml")
-        : m_status(status), m_body(body), m_mimeType(mimeType), m_expires(0)
+        : m_status(status), m_body(std::move(body)), m_mimeType(mimeType), m_expires(0)
       {}
       /// @brief Create a response with a status and a cached file
       /// @param[in] status the status of the response
@@ -61,6 +62,7 @@ namespace mtconnect {
       std::string m_body;                     ///< The body of the response
       std::string m_mimeType;                 ///< The mime type of the response
       std::optional<std::string> m_location;  ///< optional location
+      std::list<std::pair<std::string, std::string>> m_fields;  ///< additional header fields
       std::chrono::seconds
           m_expires;         ///< how long should this session should stay open before it is closed
       bool m_close {false};  ///< `true` if this session should closed after it responds
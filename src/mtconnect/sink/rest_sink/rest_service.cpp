@@ -19,6 +19,7 @@
 
 #include "mtconnect/configuration/config_options.hpp"
 #include "mtconnect/entity/xml_parser.hpp"
+#include "mtconnect/pipeline/pipeline_profiler.hpp"
 #include "mtconnect/pipeline/shdr_token_mapper.hpp"
 #include "mtconnect/pipeline/shdr_tokenizer.hpp"
 #include "mtconnect/pipeline/timestamp_extractor.hpp"
@@ -46,7 +47,9 @@ namespace mtconnect {
         m_strand(context),
         m_schemaVersion(GetOption<string>(options, config::SchemaVersion).value_or("x.y")),
         m_options(options),
-        m_logStreamData(GetOption<bool>(options, config::LogStreams).value_or(false))
+        m_logStreamData(GetOption<bool>(options, config::LogStreams).value_or(false)),
+        m_disconnectSlowClients(
+            GetOption<bool>(options, config::DisconnectSlowClients).value_or(false))
     {
       auto maxSize =
           ConvertFileSize(options, mtconnect::configuration::MaxCachedFileSize, 20 * 1024);
@@ -104,6 +107,7 @@ namespace mtconnect {
            {"at", QUERY, "Sequence number at which the observation snapshot is taken"},
            {"to", QUERY, "Sequence number at to stop reporting observations"},
            {"from", QUERY, "Sequence number at to start reporting observations"},
+           {"since", QUERY, "Only include assets with a timestamp at or after `since`"},
            {"interval", QUERY, "Time in ms between publishing data–starts streaming"},
            {"pretty", QUERY, "Instructs the result to be pretty printed"},
            {"heartbeat", QUERY,
@@ -114,6 +118,7 @@ namespace mtconnect {
       createSampleRoutings();
       createAssetRoutings();
       createPutObservationRoutings();
+      createProfileRoutings();
       createFileRoutings();
 
       makeLoopbackSource(m_sinkContract->m_pipelineContext);
@@ -445,7 +450,10 @@ namespace mtconnect {
         auto printer = printerForAccepts(request->m_accepts);
 
         respond(session, assetRequest(printer, count, removed, request->parameter<string>("type"),
-                                      request->parameter<string>("device")));
+                                      request->parameter<string>("device"),
+                                      *request->parameter<bool>("pretty"),
+                                      request->parameter<uint64_t>("from"),
+                                      request->parameter<string>("since")));
         return true;
       };
 
@@ -474,7 +482,8 @@ namespace mtconnect {
 
       string qp(
           "type={string}&removed={bool:false}&"
-          "count={integer:100}&device={string}&pretty={bool:false}");
+          "count={integer:100}&device={string}&pretty={bool:false}&"
+          "from={unsigned_integer}&since={string}");
       m_server->addRouting({boost::beast::http::verb::get, "/assets?" + qp, handler})
           .document("MTConnect assets request", "Returns up to `count` assets");
       m_server->addRouting({boost::beast::http::verb::get, "/asset?" + qp, handler})
@@ -494,6 +503,7 @@ namespace mtconnect {
 
       if (m_server->arePutsAllowed())
       {
+        auto bodyLimit = ConvertFileSize(m_options, config::MaxAssetBodySize, 64 * 1024 * 1024);
         auto putHandler = [&](SessionPtr session, RequestPtr request) -> bool {
           auto printer = printerForAccepts(request->m_accepts);
           respond(session,
@@ -533,15 +543,19 @@ namespace mtconnect {
             m_server
                 ->addRouting(
                     {t, "/" + asset + "/{assetId}?device={string}&type={string}", putHandler})
+                .bodyLimit(bodyLimit)
                 .document("Upload an asset by identified by `assetId`",
                           "Updates or adds an asset with the asset XML in the body");
             m_server->addRouting({t, "/" + asset + "?device={string}&type={string}", putHandler})
+                .bodyLimit(bodyLimit)
                 .document("Upload an asset by identified by `assetId`",
                           "Updates or adds an asset with the asset XML in the body");
             m_server->addRouting({t, "/{device}/" + asset + "/{assetId}?type={string}", putHandler})
+                .bodyLimit(bodyLimit)
                 .document("Upload an asset by identified by `assetId`",
                           "Updates or adds an asset with the asset XML in the body");
             m_server->addRouting({t, "/{device}/" + asset + "?type={string}", putHandler})
+                .bodyLimit(bodyLimit)
                 .document("Upload an asset by identified by `assetId`",
                           "Updates or adds an asset with the asset XML in the body");
           }
@@ -577,7 +591,8 @@ namespace mtconnect {
           streamCurrentRequest(session, printerForAccepts(request->m_accepts), *interval,
                                request->parameter<string>("device"),
                                request->parameter<string>("path"),
-                               *request->parameter<bool>("pretty"));
+                               *request->parameter<bool>("pretty"),
+                               streamFormatForAccepts(request->m_accepts));
         }
         else
         {
@@ -610,11 +625,29 @@ namespace mtconnect {
         auto interval = request->parameter<int32_t>("interval");
         if (interval)
         {
-          streamSampleRequest(
-              session, printerForAccepts(request->m_accepts), *interval,
-              *request->parameter<int32_t>("heartbeat"), *request->parameter<int32_t>("count"),
-              request->parameter<string>("device"), request->parameter<uint64_t>("from"),
-              request->parameter<string>("path"), *request->parameter<bool>("pretty"));
+          auto format = streamFormatForAccepts(request->m_accepts);
+          auto from = request->parameter<uint64_t>("from");
+
+          // An event source resumes from the id of the last event it received, the id is the
+          // next sequence of the last document sent.
+          if (format == StreamFormat::EVENT_STREAM && !from && request->m_lastEventId)
+          {
+            try
+            {
+              from = boost::lexical_cast<uint64_t>(*request->m_lastEventId);
+            }
+            catch (boost::bad_lexical_cast &e)
+            {
+              LOG(warning) << "Invalid Last-Event-ID: " << *request->m_lastEventId;
+            }
+          }
+
+          streamSampleRequest(session, printerForAccepts(request->m_accepts), *interval,
+                              *request->parameter<int32_t>("heartbeat"),
+                              *request->parameter<int32_t>("count"),
+                              request->parameter<string>("device"), from,
+                              request->parameter<string>("path"),
+                              *request->parameter<bool>("pretty"), format);
         }
         else
         {
@@ -645,6 +678,29 @@ namespace mtconnect {
                     "the first available observation known to the agent");
     }
 
+    void RestService::createProfileRoutings()
+    {
+      using namespace rest_sink;
+
+      if (!m_sinkContract->m_pipelineContext || !m_sinkContract->m_pipelineContext->m_profiler)
+        return;
+
+      auto profiler = m_sinkContract->m_pipelineContext->m_profiler;
+      auto handler = [profiler](SessionPtr session, const RequestPtr request) -> bool {
+        auto pretty = *request->parameter<bool>("pretty");
+        respond(session,
+                make_unique<Response>(status::ok, profiler->toJson(pretty), "application/json"));
+        return true;
+      };
+
+      m_server
+          ->addRouting(
+              {boost::beast::http::verb::get, "/pipelines/profile?pretty={bool:false}", handler})
+          .document("Pipeline transform profiles",
+                    "Call counts, dropped entities, and latency percentiles for each transform in "
+                    "every pipeline. Only available when `PipelineProfiling` is enabled.");
+    }
+
     void RestService::createPutObservationRoutings()
     {
       using namespace rest_sink;
@@ -804,13 +860,30 @@ namespace mtconnect {
       chrono::system_clock::time_point m_last;
       boost::asio::steady_timer m_timer;
       bool m_pretty {false};
+
+      // Backpressure state, the metrics are guarded by the service's stream mutex
+      int m_effectiveCount {0};
+      StreamMetrics m_metrics;
     };
 
+    std::list<StreamMetrics> RestService::getStreamMetrics() const
+    {
+      std::lock_guard<std::mutex> lock(m_streamMutex);
+      std::list<StreamMetrics> metrics;
+      for (auto &stream : m_sampleStreams)
+      {
+        if (auto response = stream.lock())
+          metrics.push_back(response->m_metrics);
+      }
+      return metrics;
+    }
+
     void RestService::streamSampleRequest(rest_sink::SessionPtr session, const Printer *printer,
                                           const int interval, const int heartbeatIn,
                                           const int count, const std::optional<std::string> &device,
                                           const std::optional<SequenceNumber_t> &from,
-                                          const std::optional<std::string> &path, bool pretty)
+                                          const std::optional<std::string> &path, bool pretty,
+                                          StreamFormat format)
     {
       NAMED_SCOPE("RestService::streamSampleRequest");
 
@@ -828,6 +901,7 @@ namespace mtconnect {
 
       auto asyncResponse = make_shared<AsyncSampleResponse>(session, m_strand);
       asyncResponse->m_count = count;
+      asyncResponse->m_effectiveCount = count;
       asyncResponse->m_printer = printer;
       asyncResponse->m_heartbeat = std::chrono::milliseconds(heartbeatIn);
       asyncResponse->m_service = getptr();
@@ -865,10 +939,17 @@ namespace mtconnect {
       asyncResponse->m_interval = chrono::milliseconds(interval);
       asyncResponse->m_logStreamData = m_logStreamData;
 
+      {
+        std::lock_guard<std::mutex> lock(m_streamMutex);
+        m_sampleStreams.remove_if([](auto &stream) { return stream.expired(); });
+        m_sampleStreams.emplace_back(asyncResponse);
+      }
+
       session->beginStreaming(
           printer->mimeType(),
           asio::bind_executor(
-              m_strand, boost::bind(&RestService::streamSampleWriteComplete, this, asyncResponse)));
+              m_strand, boost::bind(&RestService::streamSampleWriteComplete, this, asyncResponse)),
+          format);
     }
 
     void RestService::streamSampleWriteComplete(shared_ptr<AsyncSampleResponse> asyncResponse)
@@ -876,6 +957,12 @@ namespace mtconnect {
       NAMED_SCOPE("RestService::streamSampleWriteComplete");
 
       asyncResponse->m_last = chrono::system_clock::now();
+      {
+        std::lock_guard<std::mutex> lock(m_streamMutex);
+        auto &metrics = asyncResponse->m_metrics;
+        metrics.m_bytesSent += metrics.m_bytesQueued;
+        metrics.m_bytesQueued = 0;
+      }
       if (asyncResponse->m_endOfBuffer)
       {
         using boost::placeholders::_1;
@@ -970,24 +1057,63 @@ namespace mtconnect {
         string content;
         asyncResponse->m_endOfBuffer = true;
 
-        // Check if we're falling too far behind. If we are, generate an
-        // MTConnectError and return.
-        if (asyncResponse->m_sequence < m_sinkContract->getCircularBuffer().getFirstSequence())
+        auto &buffer = m_sinkContract->getCircularBuffer();
+        auto firstSeq = buffer.getFirstSequence();
+        auto seq = buffer.getSequence();
+        SequenceNumber_t lag =
+            seq > asyncResponse->m_sequence ? seq - asyncResponse->m_sequence : 0;
+        bool coalesced = false;
+
+        if (asyncResponse->m_sequence < firstSeq)
         {
-          LOG(warning) << "Client fell too far behind, disconnecting";
-          asyncResponse->m_session->fail(boost::beast::http::status::not_found,
-                                         "Client fell too far behind, disconnecting");
-          return;
+          // The client has fallen out of the buffer. Either disconnect or coalesce the
+          // missing history to the latest value of each data item and resume at the end
+          // of the buffer.
+          if (m_disconnectSlowClients)
+          {
+            LOG(warning) << "Client fell too far behind, disconnecting";
+            asyncResponse->m_session->fail(boost::beast::http::status::not_found,
+                                           "Client fell too far behind, disconnecting");
+            return;
+          }
+
+          LOG(warning) << "Client fell too far behind (lag " << lag
+                       << "), sending latest values from sequence " << seq;
+
+          ObservationList observations;
+          buffer.getLatest().getObservations(observations, asyncResponse->m_filter);
+          asyncResponse->m_observer.reset();
+          coalesced = true;
+          asyncResponse->m_effectiveCount = asyncResponse->m_count;
+          asyncResponse->m_sequence = seq;
+
+          end = seq;
+          content = asyncResponse->m_printer->printSample(m_instanceId, buffer.getBufferSize(),
+                                                          seq, firstSeq, seq - 1, observations,
+                                                          asyncResponse->m_pretty);
         }
+        else
+        {
+          // Grow the count while the client is more than two chunks behind so it catches up
+          // with fewer round trips. Restore the requested count once it reaches the end.
+          if (asyncResponse->m_count > 0)
+          {
+            if (lag > SequenceNumber_t(asyncResponse->m_effectiveCount) * 2)
+              asyncResponse->m_effectiveCount = std::min(asyncResponse->m_effectiveCount * 2,
+                                                         int(buffer.getBufferSize()));
+            else if (lag <= SequenceNumber_t(asyncResponse->m_count))
+              asyncResponse->m_effectiveCount = asyncResponse->m_count;
+          }
 
-        // end and endOfBuffer are set during the fetch sample data while the
-        // mutex is held. This removed the race to check if we are at the end of
-        // the bufffer and setting the next start to the last sequence number
-        // sent.
-        content = fetchSampleData(asyncResponse->m_printer, asyncResponse->m_filter,
-                                  asyncResponse->m_count, asyncResponse->m_sequence, nullopt, end,
-                                  asyncResponse->m_endOfBuffer, &asyncResponse->m_observer,
-                                  asyncResponse->m_pretty);
+          // end and endOfBuffer are set during the fetch sample data while the
+          // mutex is held. This removed the race to check if we are at the end of
+          // the bufffer and setting the next start to the last sequence number
+          // sent.
+          content = fetchSampleData(asyncResponse->m_printer, asyncResponse->m_filter,
+                                    asyncResponse->m_effectiveCount, asyncResponse->m_sequence,
+                                    nullopt, end, asyncResponse->m_endOfBuffer,
+                                    &asyncResponse->m_observer, asyncResponse->m_pretty);
+        }
 
         // Even if we are at the end of the buffer, or within range. If we are filtering,
         // we will need to make sure we are not spinning when there are no valid events
@@ -1003,10 +1129,26 @@ namespace mtconnect {
         if (m_logStreamData)
           asyncResponse->m_log << content << endl;
 
+        {
+          std::lock_guard<std::mutex> lock(m_streamMutex);
+          auto &metrics = asyncResponse->m_metrics;
+          metrics.m_lag = lag;
+          metrics.m_maxLag = std::max(metrics.m_maxLag, lag);
+          metrics.m_bytesQueued = content.size();
+          metrics.m_count = asyncResponse->m_effectiveCount;
+          if (coalesced)
+            metrics.m_coalesced++;
+
+          LOG(debug) << "Streaming chunk: lag " << metrics.m_lag << ", max lag "
+                     << metrics.m_maxLag << ", count " << metrics.m_count << ", bytes "
+                     << metrics.m_bytesQueued << ", coalesced " << metrics.m_coalesced;
+        }
+
         asyncResponse->m_session->writeChunk(
-            content,
+            std::move(content),
             asio::bind_executor(m_strand, boost::bind(&RestService::streamSampleWriteComplete, this,
-                                                      asyncResponse)));
+                                                      asyncResponse)),
+            end);
       }
     }
 
@@ -1028,7 +1170,8 @@ namespace mtconnect {
     void RestService::streamCurrentRequest(SessionPtr session, const Printer *printer,
                                            const int interval,
                                            const std::optional<std::string> &device,
-                                           const std::optional<std::string> &path, bool pretty)
+                                           const std::optional<std::string> &path, bool pretty,
+                                           StreamFormat format)
     {
       checkRange(printer, interval, 0, numeric_limits<int>().max(), "interval");
       DevicePtr dev {nullptr};
@@ -1049,9 +1192,13 @@ namespace mtconnect {
       asyncResponse->m_pretty = pretty;
 
       asyncResponse->m_session->beginStreaming(
-          printer->mimeType(), boost::asio::bind_executor(m_strand, [this, asyncResponse]() {
-            streamNextCurrent(asyncResponse, boost::system::error_code {});
-          }));
+          printer->mimeType(),
+          boost::asio::bind_executor(m_strand,
+                                     [this, asyncResponse]() {
+                                       streamNextCurrent(asyncResponse,
+                                                         boost::system::error_code {});
+                                     }),
+          format);
     }
 
     void RestService::streamNextCurrent(std::shared_ptr<AsyncCurrentResponse> asyncResponse,
@@ -1094,7 +1241,9 @@ namespace mtconnect {
     ResponsePtr RestService::assetRequest(const Printer *printer, const int32_t count,
                                           const bool removed,
                                           const std::optional<std::string> &type,
-                                          const std::optional<std::string> &device, bool pretty)
+                                          const std::optional<std::string> &device, bool pretty,
+                                          const std::optional<uint64_t> &from,
+                                          const std::optional<std::string> &since)
     {
       using namespace rest_sink;
 
@@ -1107,13 +1256,39 @@ namespace mtconnect {
           uuid = d->getUuid();
       }
 
-      m_sinkContract->getAssetStorage()->getAssets(list, count, !removed, uuid, type);
-      return make_unique<Response>(
+      auto storage = m_sinkContract->getAssetStorage();
+      optional<uint64_t> next;
+      if (from || since)
+      {
+        optional<Timestamp> ts;
+        if (since)
+        {
+          istringstream in(*since);
+          in >> std::setw(6) >> date::parse("%FT%T", ts.emplace());
+          if (in.fail())
+          {
+            string msg = "'since' must be a timestamp, given: " + *since;
+            throw RequestError(msg.c_str(), printError(printer, "INVALID_REQUEST", msg),
+                               printer->mimeType(), status::bad_request);
+          }
+        }
+
+        storage->getAssetChanges(list, next.emplace(), count, from.value_or(0), uuid, type, ts);
+      }
+      else
+      {
+        storage->getAssets(list, count, !removed, uuid, type);
+      }
+
+      auto response = make_unique<Response>(
           status::ok,
-          printer->printAssets(
-              m_instanceId, uint32_t(m_sinkContract->getAssetStorage()->getMaxAssets()),
-              uint32_t(m_sinkContract->getAssetStorage()->getCount()), list, pretty),
+          printer->printAssets(m_instanceId, uint32_t(storage->getMaxAssets()),
+                               uint32_t(storage->getCount()), list, pretty),
           printer->mimeType());
+      if (next)
+        response->m_fields.emplace_back("MTConnect-Next-Asset-Change", to_string(*next));
+
+      return response;
     }
 
     ResponsePtr RestService::assetIdsRequest(const Printer *printer,
@@ -1320,6 +1495,14 @@ namespace mtconnect {
       return "xml";
     }
 
+    StreamFormat RestService::streamFormatForAccepts(const std::string &accepts) const
+    {
+      if (accepts.find("text/event-stream") != string::npos)
+        return StreamFormat::EVENT_STREAM;
+      else
+        return StreamFormat::MULTIPART;
+    }
+
     const Printer *RestService::printerForAccepts(const std::string &accepts) const
     {
       return m_sinkContract->getPrinter(acceptFormat(accepts));
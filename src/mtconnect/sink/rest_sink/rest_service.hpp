@@ -19,6 +19,9 @@
 
 #include <boost/asio/io_context.hpp>
 
+#include <list>
+#include <mutex>
+
 #include "mtconnect/buffer/circular_buffer.hpp"
 #include "mtconnect/config.hpp"
 #include "mtconnect/sink/sink.hpp"
@@ -38,6 +41,23 @@ namespace mtconnect {
     struct AsyncSampleResponse;
     struct AsyncCurrentResponse;
 
+    /// @brief Backpressure metrics of a streaming sample session
+    struct StreamMetrics
+    {
+      /// @brief sequence numbers between the next one to send and the end of the buffer
+      SequenceNumber_t m_lag {0};
+      /// @brief the largest lag of the session
+      SequenceNumber_t m_maxLag {0};
+      /// @brief bytes of the chunk that is being written to the client
+      size_t m_bytesQueued {0};
+      /// @brief bytes of the chunks the client has been sent
+      uint64_t m_bytesSent {0};
+      /// @brief the count of the last chunk, it grows while the client is catching up
+      int m_count {0};
+      /// @brief the number of times the client was sent the latest values instead of history
+      unsigned m_coalesced {0};
+    };
+
     /// @brief Callback fundtion for setting namespaces
     using NamespaceFunction = void (printer::XmlPrinter::*)(const std::string &,
                                                             const std::string &,
@@ -86,6 +106,9 @@ namespace mtconnect {
       /// @brief Get the file cache
       /// @return pointer to the file cache
       auto getFileCache() { return &m_fileCache; }
+      /// @brief Get the backpressure metrics of the streaming sample sessions
+      /// @return the metrics of each active session
+      std::list<StreamMetrics> getStreamMetrics() const;
 
       /// @name MTConnect Request Handlers
       ///@{
@@ -137,12 +160,13 @@ namespace mtconnect {
       /// @param[in] from optional starting sequence number
       /// @param[in] path optional path for filtering
       /// @param[in] pretty `true` to ensure response is formatted
+      /// @param[in] format multipart or server-sent events framing of the stream
       void streamSampleRequest(SessionPtr session, const printer::Printer *p, const int interval,
                                const int heartbeat, const int count = 100,
                                const std::optional<std::string> &device = std::nullopt,
                                const std::optional<SequenceNumber_t> &from = std::nullopt,
                                const std::optional<std::string> &path = std::nullopt,
-                               bool pretty = false);
+                               bool pretty = false, StreamFormat format = StreamFormat::MULTIPART);
 
       /// @brief Handler for a streaming current
       /// @param[in] session session to stream data to
@@ -151,10 +175,12 @@ namespace mtconnect {
       /// @param[in] device optional device name or uuid
       /// @param[in] path optional path for filtering
       /// @param[in] pretty `true` to ensure response is formatted
+      /// @param[in] format multipart or server-sent events framing of the stream
       void streamCurrentRequest(SessionPtr session, const printer::Printer *p, const int interval,
                                 const std::optional<std::string> &device = std::nullopt,
                                 const std::optional<std::string> &path = std::nullopt,
-                                bool pretty = false);
+                                bool pretty = false,
+                                StreamFormat format = StreamFormat::MULTIPART);
       /// @brief Handler for put/post observation
       /// @param[in] p printer for response generation
       /// @param[in] device device
@@ -191,17 +217,26 @@ namespace mtconnect {
       ///@{
 
       /// @brief Asset request handler for assets by type or device
+      ///
+      /// If `from` or `since` are given, the assets are returned in the order they changed and
+      /// the `MTConnect-Next-Asset-Change` header has the `from` for the next request. Removed
+      /// assets are always included in the changes, so `removed` is ignored.
+      ///
       /// @param[in] p printer for the response document
       /// @param[in] count maximum number of assets to return
       /// @param[in] removed `true` if response should include removed assets
       /// @param[in] type optional type of asset to filter
       /// @param[in] device optional device name or uuid
       /// @param[in] pretty `true` to ensure response is formatted
+      /// @param[in] from optional change sequence of the first asset to return
+      /// @param[in] since optional time, only return assets with a later timestamp
       /// @return MTConnect Assets response document
       ResponsePtr assetRequest(const printer::Printer *p, const int32_t count, const bool removed,
                                const std::optional<std::string> &type = std::nullopt,
                                const std::optional<std::string> &device = std::nullopt,
-                               bool pretty = false);
+                               bool pretty = false,
+                               const std::optional<uint64_t> &from = std::nullopt,
+                               const std::optional<std::string> &since = std::nullopt);
 
       /// @brief Asset request handler using a list of asset ids
       /// @param[in] p printer for the response document
@@ -245,6 +280,10 @@ namespace mtconnect {
       /// @param accepts the accepts header
       /// @return printer key or `xml` if one is not found
       const std::string acceptFormat(const std::string &accepts) const;
+      /// @brief Check the accepts header for `text/event-stream`
+      /// @param accepts the accepts header
+      /// @return `EVENT_STREAM` if server-sent events are accepted, `MULTIPART` otherwise
+      StreamFormat streamFormatForAccepts(const std::string &accepts) const;
       /// @brief get a printer given a list of formats from the Accepts header
       /// @param accepts the accepts header
       /// @return pointer to a printer
@@ -293,6 +332,8 @@ namespace mtconnect {
 
       void createAssetRoutings();
 
+      void createProfileRoutings();
+
       // Current Data Collection
       std::string fetchCurrentData(const printer::Printer *printer, const FilterSetOpt &filterSet,
                                    const std::optional<SequenceNumber_t> &at, bool pretty = false);
@@ -335,6 +376,13 @@ namespace mtconnect {
       FileCache m_fileCache;
 
       bool m_logStreamData {false};
+
+      // Drop streaming clients that fall out of the buffer instead of coalescing
+      bool m_disconnectSlowClients {false};
+
+      // Active streaming sample sessions, the mutex also guards their metrics
+      mutable std::mutex m_streamMutex;
+      std::list<std::weak_ptr<AsyncSampleResponse>> m_sampleStreams;
     };
   }  // namespace sink::rest_sink
 }  // namespace mtconnect
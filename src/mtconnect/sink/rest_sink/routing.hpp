@@ -141,6 +141,16 @@ namespace mtconnect::sink::rest_sink {
       return *this;
     }
 
+    /// @brief Set the maximum size of the request body for this routing
+    /// @param[in] limit the limit in bytes
+    Routing &bodyLimit(uint64_t limit)
+    {
+      m_bodyLimit = limit;
+      return *this;
+    }
+    /// @brief Get the maximum size of the request body if set
+    const auto &getBodyLimit() const { return m_bodyLimit; }
+
     /// @brief Get the description of the REST call for Swagger
     /// @returns optional string if description is givem
     const auto &getDescription() const { return m_description; }
@@ -216,6 +226,15 @@ namespace mtconnect::sink::rest_sink {
       return false;
     }
 
+    /// @brief check if the verb and path match this routing without dispatching
+    /// @param[in] verb the request verb
+    /// @param[in] path the request path
+    /// @return `true` if the routing matches
+    bool matches(boost::beast::http::verb verb, const std::string &path) const
+    {
+      return m_verb == verb && std::regex_match(path, m_pattern);
+    }
+
     /// @brief check if this is related to a swagger API
     /// @returns `true` if related to swagger
     auto isSwagger() const { return m_swagger; }
@@ -364,6 +383,7 @@ namespace mtconnect::sink::rest_sink {
 
     std::optional<std::string> m_summary;
     std::optional<std::string> m_description;
+    std::optional<uint64_t> m_bodyLimit;
 
     bool m_swagger = false;
   };
@@ -194,11 +194,15 @@ namespace mtconnect::sink::rest_sink {
         dispatch(session, request);
         return true;
       };
+      auto bodyLimit = [this](boost::beast::http::verb verb, const std::string &path) {
+        return getBodyLimit(verb, path);
+      };
       if (m_tlsEnabled)
       {
         auto dectector =
             make_shared<TlsDector>(std::move(socket), m_sslContext, m_tlsOnly, m_allowPuts,
-                                   m_allowPutsFrom, m_fields, dispatcher, m_errorFunction);
+                                   m_allowPutsFrom, m_fields, dispatcher, m_errorFunction,
+                                   bodyLimit);
 
         dectector->run();
       }
@@ -213,6 +217,7 @@ namespace mtconnect::sink::rest_sink {
           session->allowPutsFrom(m_allowPutsFrom);
         else if (m_allowPuts)
           session->allowPuts();
+        session->setBodyLimit(bodyLimit);
 
         session->run();
       }
@@ -201,6 +201,20 @@ namespace mtconnect::sink::rest_sink {
       return false;
     }
 
+    /// @brief get the maximum size of the request body for a verb and path
+    /// @param[in] verb the request verb
+    /// @param[in] path the request path
+    /// @return the body limit of the first matching routing that has one
+    uint64_t getBodyLimit(boost::beast::http::verb verb, const std::string &path) const
+    {
+      for (const auto &r : m_routings)
+      {
+        if (r.matches(verb, path))
+          return r.getBodyLimit().value_or(DEFAULT_BODY_LIMIT);
+      }
+      return DEFAULT_BODY_LIMIT;
+    }
+
     /// @brief accept a connection from a client
     /// @param[in] ec an error code
     /// @param[in] soc the incoming connection socket
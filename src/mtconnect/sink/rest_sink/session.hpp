@@ -23,8 +23,10 @@
 
 #include <functional>
 #include <memory>
+#include <optional>
 
 #include "mtconnect/config.hpp"
+#include "mtconnect/utilities.hpp"
 #include "routing.hpp"
 
 namespace mtconnect::sink::rest_sink {
@@ -35,7 +37,18 @@ namespace mtconnect::sink::rest_sink {
   using ErrorFunction =
       std::function<void(SessionPtr, boost::beast::http::status status, const std::string &msg)>;
 
+  /// @brief The framing used for a streaming response
+  enum class StreamFormat
+  {
+    MULTIPART,    ///< `multipart/mixed` with a boundary between each document
+    EVENT_STREAM  ///< Server-Sent Events (`text/event-stream`), one event per document
+  };
+
   using Dispatch = std::function<bool(SessionPtr, RequestPtr)>;
+  /// @brief Function returning the maximum size of the request body for a verb and path
+  using BodyLimit = std::function<uint64_t(boost::beast::http::verb, const std::string &)>;
+  /// @brief The maximum size of a request body unless the routing allows more
+  inline constexpr uint64_t DEFAULT_BODY_LIMIT {100000};
   using Complete = std::function<void()>;
   using FieldList = std::list<std::pair<std::string, std::string>>;
 
@@ -61,14 +74,21 @@ namespace mtconnect::sink::rest_sink {
     /// @param response the response
     /// @param complete optional completion callback
     virtual void writeFailureResponse(ResponsePtr &&response, Complete complete = nullptr) = 0;
-    /// @brief begin streaming data to the client using x-multipart-replace
+    /// @brief begin streaming data to the client using x-multipart-replace or server-sent events
     /// @param mimeType the mime type of the response
     /// @param complete completion callback
-    virtual void beginStreaming(const std::string &mimeType, Complete complete) = 0;
+    /// @param format the framing of the documents in the stream
+    virtual void beginStreaming(const std::string &mimeType, Complete complete,
+                                StreamFormat format = StreamFormat::MULTIPART) = 0;
     /// @brief write a chunk for a streaming session
+    ///
+    /// The session takes ownership of the chunk and keeps it until the write completes.
+    ///
     /// @param chunk the chunk to write
     /// @param complete a completion callback
-    virtual void writeChunk(const std::string &chunk, Complete complete) = 0;
+    /// @param id optional event id, used as the `id:` field for server-sent events
+    virtual void writeChunk(std::string &&chunk, Complete complete,
+                            std::optional<SequenceNumber_t> id = std::nullopt) = 0;
     /// @brief close the session
     virtual void close() = 0;
     /// @brief close the stream
@@ -105,6 +125,9 @@ namespace mtconnect::sink::rest_sink {
       m_allowPuts = true;
       m_allowPutsFrom = hosts;
     }
+    /// @brief set the function that determines the body limit of a request from its header
+    /// @param limit the body limit function
+    void setBodyLimit(BodyLimit limit) { m_bodyLimit = limit; }
     /// @brief get the remote endpoint
     /// @return the asio tcp endpoint
     auto &getRemote() const { return m_remote; }
@@ -118,6 +141,7 @@ namespace mtconnect::sink::rest_sink {
 
   protected:
     Dispatch m_dispatch;
+    BodyLimit m_bodyLimit;
     ErrorFunction m_errorFunction;
 
     std::string m_message;
@@ -171,8 +171,43 @@ namespace mtconnect::sink::rest_sink {
   {
     NAMED_SCOPE("SessionImpl::read");
     reset();
-    m_parser->body_limit(100000);
+    // The Content-Length is checked against the limit of the routing once the header is read
+    m_parser->body_limit(boost::none);
     beast::get_lowest_layer(derived().stream()).expires_after(30s);
+    http::async_read_header(derived().stream(), m_buffer, *m_parser,
+                            beast::bind_front_handler(&SessionImpl::headerRead, shared_ptr()));
+  }
+
+  template <class Derived>
+  void SessionImpl<Derived>::headerRead(boost::system::error_code ec, size_t len)
+  {
+    NAMED_SCOPE("SessionImpl::headerRead");
+
+    if (ec || m_parser->is_done())
+    {
+      requested(ec, len);
+      return;
+    }
+
+    // The routing for the request decides how large the body can be
+    auto &msg = m_parser->get();
+    uint64_t limit = DEFAULT_BODY_LIMIT;
+    if (m_bodyLimit)
+    {
+      QueryMap query;
+      limit = m_bodyLimit(msg.method(), parseUrl(string(msg.target()), query));
+    }
+
+    // The body is not read, so the connection is closed after the response
+    if (auto length = m_parser->content_length(); length && *length > limit)
+    {
+      m_version = msg.version();
+      m_close = true;
+      fail(status::payload_too_large, "Request body is too large");
+      return;
+    }
+    m_parser->body_limit(limit);
+
     http::async_read(derived().stream(), m_buffer, *m_parser,
                      beast::bind_front_handler(&SessionImpl::requested, shared_ptr()));
   }
@@ -182,6 +217,22 @@ namespace mtconnect::sink::rest_sink {
   {
     NAMED_SCOPE("SessionImpl::requested");
 
+    // The client closed a persistent connection between requests
+    if (ec == http::error::end_of_stream)
+    {
+      LOG(debug) << "Client closed the connection";
+      close();
+      return;
+    }
+
+    // A chunked body exceeded the limit, the rest of it is not read
+    if (ec == http::error::body_limit)
+    {
+      m_close = true;
+      fail(status::payload_too_large, "Request body is too large");
+      return;
+    }
+
     if (ec)
     {
       fail(status::internal_server_error, "Could not read request", ec);
@@ -226,7 +277,9 @@ namespace mtconnect::sink::rest_sink {
       m_request->m_contentType = string(a->value());
     if (auto a = msg.find(http::field::accept_encoding); a != msg.end())
       m_request->m_acceptsEncoding = string(a->value());
-    m_request->m_body = msg.body();
+    if (auto a = msg.find("Last-Event-ID"); a != msg.end())
+      m_request->m_lastEventId = string(a->value());
+    m_request->m_body = std::move(msg.body());
 
     if (auto f = msg.find(http::field::content_type);
         f != msg.end() && f->value() == "application/x-www-form-urlencoded" &&
@@ -237,8 +290,12 @@ namespace mtconnect::sink::rest_sink {
 
     m_request->m_foreignIp = remote.address().to_string();
     m_request->m_foreignPort = remote.port();
-    if (auto a = msg.find(http::field::connection); a != msg.end())
-      m_close = a->value() == "close";
+
+    // Honor the HTTP/1.0 and HTTP/1.1 persistent connection rules. Requests are handled one at a
+    // time, the next request (possibly already pipelined in m_buffer) is read after the response
+    // has been sent, so responses are always returned in the order the requests were received.
+    m_version = msg.version();
+    m_close = !msg.keep_alive();
 
     LOG(info) << "ReST Request: From [" << m_request->m_foreignIp << ':' << remote.port()
               << "]: " << msg.method() << " " << msg.target();
@@ -279,7 +336,8 @@ namespace mtconnect::sink::rest_sink {
   }
 
   template <class Derived>
-  void SessionImpl<Derived>::beginStreaming(const std::string &mimeType, Complete complete)
+  void SessionImpl<Derived>::beginStreaming(const std::string &mimeType, Complete complete,
+                                            StreamFormat format)
   {
     NAMED_SCOPE("SessionImpl::beginStreaming");
 
@@ -291,6 +349,7 @@ namespace mtconnect::sink::rest_sink {
     m_boundary = to_string(gen());
     m_complete = complete;
     m_mimeType = mimeType;
+    m_streamFormat = format;
     m_streaming = true;
 
     auto res = make_shared<http::response<empty_body>>(status::ok, 11);
@@ -298,7 +357,10 @@ namespace mtconnect::sink::rest_sink {
     res->chunked(true);
     res->set(field::server, "MTConnectAgent");
     res->set(field::connection, "close");
-    res->set(field::content_type, "multipart/mixed;boundary=" + m_boundary);
+    if (m_streamFormat == StreamFormat::EVENT_STREAM)
+      res->set(field::content_type, "text/event-stream");
+    else
+      res->set(field::content_type, "multipart/mixed;boundary=" + m_boundary);
     res->set(field::expires, "-1");
     res->set(field::cache_control, "no-cache, no-store, max-age=0");
     for (const auto &f : m_fields)
@@ -313,24 +375,74 @@ namespace mtconnect::sink::rest_sink {
   }
 
   template <class Derived>
-  void SessionImpl<Derived>::writeChunk(const std::string &body, Complete complete)
+  void SessionImpl<Derived>::writeChunk(std::string &&body, Complete complete,
+                                        std::optional<SequenceNumber_t> id)
   {
     NAMED_SCOPE("SessionImpl::writeChunk");
 
     using namespace http;
+    using boost::asio::buffer;
+    using boost::asio::const_buffer;
+
+    static constexpr string_view DATA("data: ");
+    static constexpr string_view LF("\n");
+    static constexpr string_view CRLF("\r\n");
 
     beast::get_lowest_layer(derived().stream()).expires_after(30s);
 
     m_complete = complete;
-    m_streamBuffer.emplace();
-    ostream str(&m_streamBuffer.value());
 
-    str << "--" + m_boundary << "\r\n"
-        << to_string(field::content_type) << ": " << m_mimeType << "\r\n"
-        << to_string(field::content_length) << ": " << to_string(body.length()) << "\r\n\r\n"
-        << body << "\r\n";
+    // The previous chunk has been completely written. The body is kept by the session and
+    // written with the framing as a sequence of buffers.
+    m_chunk = std::move(body);
+    m_chunkHeader.clear();
+    vector<const_buffer> buffers;
 
-    async_write(derived().stream(), http::make_chunk(m_streamBuffer->data()),
+    if (m_streamFormat == StreamFormat::EVENT_STREAM)
+    {
+      // Each document is a single event. Every line of the document must be its own data field,
+      // the event is terminated by a blank line.
+      if (id)
+      {
+        m_chunkHeader.append("id: ").append(to_string(*id)).append(LF);
+        buffers.emplace_back(buffer(m_chunkHeader));
+      }
+
+      string_view lines(m_chunk);
+      while (!lines.empty())
+      {
+        auto eol = lines.find('\n');
+        auto line = lines.substr(0, eol);
+        if (!line.empty() && line.back() == '\r')
+          line.remove_suffix(1);
+        buffers.emplace_back(buffer(DATA.data(), DATA.size()));
+        buffers.emplace_back(buffer(line.data(), line.size()));
+        buffers.emplace_back(buffer(LF.data(), LF.size()));
+
+        if (eol == string_view::npos)
+          break;
+        lines.remove_prefix(eol + 1);
+      }
+      buffers.emplace_back(buffer(LF.data(), LF.size()));
+    }
+    else
+    {
+      m_chunkHeader.append("--")
+          .append(m_boundary)
+          .append(CRLF)
+          .append("Content-Type: ")
+          .append(m_mimeType)
+          .append(CRLF)
+          .append("Content-Length: ")
+          .append(to_string(m_chunk.length()))
+          .append(CRLF)
+          .append(CRLF);
+      buffers.emplace_back(buffer(m_chunkHeader));
+      buffers.emplace_back(buffer(m_chunk));
+      buffers.emplace_back(buffer(CRLF.data(), CRLF.size()));
+    }
+
+    async_write(derived().stream(), http::make_chunk(buffers),
                 beast::bind_front_handler(&SessionImpl::sent, shared_ptr()));
   }
 
@@ -350,8 +462,7 @@ namespace mtconnect::sink::rest_sink {
   void SessionImpl<Derived>::addHeaders(const Response &response, Message &res)
   {
     res->set(http::field::server, "MTConnectAgent");
-    if (response.m_close || m_close)
-      res->set(http::field::connection, "close");
+    res->keep_alive(!(response.m_close || m_close));
     if (response.m_expires == 0s)
     {
       res->set(http::field::expires, "-1");
@@ -366,6 +477,10 @@ namespace mtconnect::sink::rest_sink {
     {
       res->set(http::field::location, *response.m_location);
     }
+    for (const auto &f : response.m_fields)
+    {
+      res->set(f.first, f.second);
+    }
   }
 
   template <class Derived>
@@ -380,6 +495,8 @@ namespace mtconnect::sink::rest_sink {
 
     m_complete = complete;
     m_outgoing = std::move(responsePtr);
+    if (m_outgoing->m_close)
+      m_close = true;
 
     if (m_outgoing->m_file && !m_outgoing->m_file->m_cached)
     {
@@ -406,7 +523,7 @@ namespace mtconnect::sink::rest_sink {
       auto size = body.size();
       auto res = make_shared<http::response<http::file_body>>(
           std::piecewise_construct, std::make_tuple(std::move(body)),
-          std::make_tuple(m_outgoing->m_status, 11));
+          std::make_tuple(m_outgoing->m_status, m_version));
       res->set(http::field::content_type, m_outgoing->m_mimeType);
       res->content_length(size);
       if (encoding)
@@ -435,7 +552,7 @@ namespace mtconnect::sink::rest_sink {
 
       auto res = make_shared<http::response<http::span_body<const char>>>(
           std::piecewise_construct, std::make_tuple(bp, size),
-          std::make_tuple(m_outgoing->m_status, 11));
+          std::make_tuple(m_outgoing->m_status, m_version));
 
       addHeaders(*m_outgoing, res);
       res->chunked(false);
@@ -454,7 +571,7 @@ namespace mtconnect::sink::rest_sink {
     if (m_streaming)
     {
       m_outgoing = std::move(response);
-      writeChunk(m_outgoing->m_body, [this] { closeStream(); });
+      writeChunk(std::move(m_outgoing->m_body), [this] { closeStream(); });
     }
     else
     {
@@ -597,6 +714,7 @@ namespace mtconnect::sink::rest_sink {
         session->allowPutsFrom(m_allowPutsFrom);
       else if (m_allowPuts)
         session->allowPuts();
+      session->setBodyLimit(m_bodyLimit);
 
       session->run();
     }
@@ -69,14 +69,17 @@ namespace mtconnect {
       void run() override;
       void writeResponse(ResponsePtr &&response, Complete complete = nullptr) override;
       void writeFailureResponse(ResponsePtr &&response, Complete complete = nullptr) override;
-      void beginStreaming(const std::string &mimeType, Complete complete) override;
-      void writeChunk(const std::string &chunk, Complete complete) override;
+      void beginStreaming(const std::string &mimeType, Complete complete,
+                          StreamFormat format = StreamFormat::MULTIPART) override;
+      void writeChunk(std::string &&chunk, Complete complete,
+                      std::optional<SequenceNumber_t> id = std::nullopt) override;
       void closeStream() override;
       ///@}
     protected:
       template <typename T>
       void addHeaders(const Response &response, T &res);
 
+      void headerRead(boost::system::error_code ec, size_t len);
       void requested(boost::system::error_code ec, size_t len);
       void sent(boost::system::error_code ec, size_t len);
       void read();
@@ -91,15 +94,25 @@ namespace mtconnect {
       // For Streaming
       std::string m_boundary;
       std::string m_mimeType;
+      StreamFormat m_streamFormat {StreamFormat::MULTIPART};
       bool m_close {false};
 
+      // HTTP version of the current request, responses are sent with the same version
+      unsigned m_version {11};
+
       // Additional fields
       FieldList m_fields;
 
       // References to retain lifecycle for callbacks.
       RequestPtr m_request;
+
+      // The read buffer is kept for the life of the session so bytes of pipelined requests that
+      // arrive with the current request are parsed by the next read.
       boost::beast::flat_buffer m_buffer;
-      std::optional<boost::asio::streambuf> m_streamBuffer;
+
+      // The chunk being written and its framing, the body is sent as is without copying.
+      std::string m_chunk;
+      std::string m_chunkHeader;
       std::optional<RequestParser> m_parser;
       std::shared_ptr<void> m_response;
       std::shared_ptr<void> m_serializer;
@@ -40,9 +40,11 @@ namespace mtconnect::sink::rest_sink {
     /// @param[in] list the header fields
     /// @param[in] dispatch a dispatcher function
     /// @param[in] error an error function
+    /// @param[in] bodyLimit the body limit function
     TlsDector(boost::asio::ip::tcp::socket &&socket, boost::asio::ssl::context &context,
               bool tlsOnly, bool allowPuts, const std::set<boost::asio::ip::address> &allowPutsFrom,
-              const FieldList &list, Dispatch dispatch, ErrorFunction error)
+              const FieldList &list, Dispatch dispatch, ErrorFunction error,
+              BodyLimit bodyLimit = nullptr)
       : m_stream(std::move(socket)),
         m_tlsContext(context),
         m_tlsOnly(tlsOnly),
@@ -50,7 +52,8 @@ namespace mtconnect::sink::rest_sink {
         m_allowPutsFrom(allowPutsFrom),
         m_fields(list),
         m_dispatch(dispatch),
-        m_errorFunction(error)
+        m_errorFunction(error),
+        m_bodyLimit(bodyLimit)
     {}
 
     ~TlsDector() {}
@@ -91,5 +94,6 @@ namespace mtconnect::sink::rest_sink {
     FieldList m_fields;
     Dispatch m_dispatch;
     ErrorFunction m_errorFunction;
+    BodyLimit m_bodyLimit;
   };
 }  // namespace mtconnect::sink::rest_sink
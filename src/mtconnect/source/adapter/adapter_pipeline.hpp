@@ -70,6 +70,8 @@ namespace mtconnect::source::adapter {
     /// @return the device
     const auto &getDevice() const { return m_device; }
 
+    std::string getIdentity() const override { return m_identity; }
+
   protected:
     void buildDeviceList();
     void buildCommandAndStatusDelivery();
@@ -40,6 +40,8 @@ namespace mtconnect::source {
     /// @param options configuration options
     void build(const ConfigOptions &options) override;
 
+    std::string getIdentity() const override { return "Loopback"; }
+
   protected:
     ConfigOptions m_options;
   };
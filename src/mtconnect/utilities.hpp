@@ -27,7 +27,9 @@
 #include <boost/regex.hpp>
 #include <boost/uuid/detail/sha1.hpp>
 
+#include <charconv>
 #include <chrono>
+#include <cstdio>
 #include <date/date.h>
 #include <mtconnect/version.h>
 
@@ -107,15 +109,68 @@ namespace mtconnect {
     return value;
   }
 
+  /// @brief buffer size sufficient for any double written by `format(double, char *)`
+  constexpr size_t FORMAT_DOUBLE_SIZE = 32;
+
+  /// @brief writes a double to a character buffer without allocating
+  ///
+  /// Produces the same text as streaming the value with `std::setprecision(digits10)`, the
+  /// equivalent of `printf("%.15g")`.
+  ///
+  /// @param[in] value the double
+  /// @param[out] buffer a buffer of at least `FORMAT_DOUBLE_SIZE` characters
+  /// @return the number of characters written, the buffer is not null terminated
+  inline size_t format(double value, char *buffer)
+  {
+    constexpr int precision = std::numeric_limits<double>::digits10;
+#if defined(__cpp_lib_to_chars)
+    auto res = std::to_chars(buffer, buffer + FORMAT_DOUBLE_SIZE, value,
+                             std::chars_format::general, precision);
+    return res.ptr - buffer;
+#else
+    return std::snprintf(buffer, FORMAT_DOUBLE_SIZE, "%.*g", precision, value);
+#endif
+  }
+
   /// @brief converts a double to a string
   /// @param[in] value the double
-  /// @return the string representation of the double (10 places max)
+  /// @return the string representation of the double (15 significant digits max)
   inline std::string format(double value)
   {
-    std::stringstream s;
-    constexpr int precision = std::numeric_limits<double>::digits10;
-    s << std::setprecision(precision) << value;
-    return s.str();
+    char buffer[FORMAT_DOUBLE_SIZE];
+    return std::string(buffer, format(value, buffer));
+  }
+
+  /// @brief appends a double to a string
+  /// @param[in,out] out the string to append to
+  /// @param[in] value the double
+  inline void formatTo(std::string &out, double value)
+  {
+    char buffer[FORMAT_DOUBLE_SIZE];
+    out.append(buffer, format(value, buffer));
+  }
+
+  /// @brief parses a double from a character range without allocating
+  ///
+  /// Uses the locale independent `std::from_chars` when the value is followed by whitespace or
+  /// the end of the range, otherwise falls back to `strtod` for the forms `from_chars` does not
+  /// accept, like a leading `+` or hexadecimal values. The range must be null terminated for the
+  /// fallback.
+  ///
+  /// @param[in] first the first character
+  /// @param[in] last one past the last character
+  /// @param[out] value the double
+  /// @return one past the last character parsed, `first` if no value was parsed
+  inline const char *parseDouble(const char *first, const char *last, double &value)
+  {
+#if defined(__cpp_lib_to_chars)
+    auto res = std::from_chars(first, last, value);
+    if (res.ec == std::errc() && (res.ptr == last || std::isspace((unsigned char)*res.ptr)))
+      return res.ptr;
+#endif
+    char *np = nullptr;
+    value = std::strtod(first, &np);
+    return np;
   }
 
   /// @brief inline formattor support for doubles
@@ -129,7 +184,7 @@ namespace mtconnect {
     /// @param[in] v the value
     format_double_stream(double v) { val = v; }
 
-    /// @brief writes a double to an output stream with up to 10 digits of precision
+    /// @brief writes a double to an output stream with up to 15 digits of precision
     /// @tparam _CharT from std::basic_ostream
     /// @tparam _Traits from std::basic_ostream
     /// @param[in,out] os output stream
@@ -139,8 +194,10 @@ namespace mtconnect {
     inline friend std::basic_ostream<_CharT, _Traits> &operator<<(
         std::basic_ostream<_CharT, _Traits> &os, const format_double_stream &fmter)
     {
-      constexpr int precision = std::numeric_limits<double>::digits10;
-      os << std::setprecision(precision) << fmter.val;
+      char buffer[FORMAT_DOUBLE_SIZE];
+      auto len = format(fmter.val, buffer);
+      for (size_t i = 0; i < len; i++)
+        os << os.widen(buffer[i]);
       return os;
     }
   };
@@ -2347,6 +2347,77 @@ TEST_F(AgentTest, RemoveAssetUsingHttpDelete)
   }
 }
 
+TEST_F(AgentTest, should_follow_asset_changes_with_removals)
+{
+  auto agent = m_agentTestHelper->createAgent("/samples/test_config.xml", 8, 4, "1.3", 4, true);
+  addAdapter();
+
+  auto nextChange = [this]() -> string {
+    for (auto &f : m_agentTestHelper->session()->m_fields)
+    {
+      if (f.first == "MTConnect-Next-Asset-Change")
+        return f.second;
+    }
+    return "";
+  };
+
+  m_agentTestHelper->m_adapter->processData(
+      "2021-02-01T12:00:00Z|@ASSET@|P1|Part|<Part assetId='P1'>TEST 1</Part>");
+  m_agentTestHelper->m_adapter->processData(
+      "2021-02-01T12:01:00Z|@ASSET@|P2|Part|<Part assetId='P2'>TEST 2</Part>");
+  m_agentTestHelper->m_adapter->processData(
+      "2021-02-01T12:02:00Z|@ASSET@|P3|Part|<Part assetId='P3'>TEST 3</Part>");
+  ASSERT_EQ((unsigned int)3, agent->getAssetStorage()->getCount());
+
+  QueryMap query {{"from", "0"}, {"count", "2"}};
+  {
+    PARSE_XML_RESPONSE_QUERY("/asset", query);
+    ASSERT_XML_PATH_COUNT(doc, "//m:Assets/*", 2);
+    ASSERT_XML_PATH_EQUAL(doc, "//m:Assets/*[1]@assetId", "P1");
+    ASSERT_XML_PATH_EQUAL(doc, "//m:Assets/*[2]@assetId", "P2");
+    ASSERT_EQ("3", nextChange());
+  }
+
+  query["from"] = "3";
+  {
+    PARSE_XML_RESPONSE_QUERY("/asset", query);
+    ASSERT_XML_PATH_COUNT(doc, "//m:Assets/*", 1);
+    ASSERT_XML_PATH_EQUAL(doc, "//m:Assets/*[1]@assetId", "P3");
+    ASSERT_EQ("4", nextChange());
+  }
+
+  // A removal is a change and is returned without asking for removed assets
+  m_agentTestHelper->m_adapter->processData("2021-02-01T12:03:00Z|@REMOVE_ASSET@|P2\r");
+
+  query["from"] = "4";
+  {
+    PARSE_XML_RESPONSE_QUERY("/asset", query);
+    ASSERT_XML_PATH_COUNT(doc, "//m:Assets/*", 1);
+    ASSERT_XML_PATH_EQUAL(doc, "//m:Assets/*[1]@assetId", "P2");
+    ASSERT_XML_PATH_EQUAL(doc, "//m:Assets/*[1]@removed", "true");
+    ASSERT_EQ("5", nextChange());
+  }
+
+  query.erase("from");
+  query["since"] = "2021-02-01T12:01:00Z";
+  query["count"] = "10";
+  {
+    PARSE_XML_RESPONSE_QUERY("/asset", query);
+    ASSERT_XML_PATH_COUNT(doc, "//m:Assets/*", 2);
+    ASSERT_XML_PATH_EQUAL(doc, "//m:Assets/*[1]@assetId", "P3");
+    ASSERT_XML_PATH_EQUAL(doc, "//m:Assets/*[2]@assetId", "P2");
+    ASSERT_XML_PATH_EQUAL(doc, "//m:Assets/*[2]@removed", "true");
+    ASSERT_EQ("5", nextChange());
+  }
+
+  // Without from or since only the active assets are returned
+  {
+    PARSE_XML_RESPONSE("/asset");
+    ASSERT_XML_PATH_COUNT(doc, "//m:Assets/*", 2);
+    ASSERT_EQ("", nextChange());
+  }
+}
+
 TEST_F(AgentTest, AssetChangedWhenUnavailable)
 {
   addAdapter();
@@ -2718,6 +2789,125 @@ TEST_F(AgentTest, StreamDataObserver)
   }
 }
 
+TEST_F(AgentTest, should_stream_server_sent_events_and_resume_from_last_event_id)
+{
+  addAdapter();
+  auto rest = m_agentTestHelper->getRestService();
+  rest->start();
+
+  auto &circ = m_agentTestHelper->getAgent()->getCircularBuffer();
+  for (int i = 0; i < 5; i++)
+    m_agentTestHelper->m_adapter->processData("2021-02-01T12:00:00Z|line|" + to_string(i));
+  auto next = circ.getSequence();
+
+  auto request = make_shared<Request>();
+  request->m_verb = boost::beast::http::verb::get;
+  request->m_path = "/LinuxCNC/sample";
+  request->m_accepts = "text/event-stream";
+  request->m_query = {{"interval", "100"},
+                      {"heartbeat", "1000"},
+                      {"count", "10"},
+                      {"path", "//DataItem[@name='line']"}};
+  request->m_lastEventId = to_string(next - 2);
+
+  auto session = m_agentTestHelper->m_session;
+  ASSERT_TRUE(rest->getServer()->dispatch(session, request));
+  m_agentTestHelper->m_ioContext.run_for(50ms);
+
+  EXPECT_EQ(StreamFormat::EVENT_STREAM, session->m_streamFormat);
+  ASSERT_TRUE(session->m_chunkId);
+  EXPECT_EQ(next, *session->m_chunkId);
+
+  PARSE_XML_CHUNK();
+  ASSERT_XML_PATH_COUNT(doc, "//m:Line", 2);
+  ASSERT_XML_PATH_EQUAL(doc, "//m:Header@nextSequence", to_string(next).c_str());
+
+  session->closeStream();
+}
+
+TEST_F(AgentTest, should_send_latest_values_when_streaming_client_falls_out_of_the_buffer)
+{
+  addAdapter();
+  auto rest = m_agentTestHelper->getRestService();
+  auto &circ = m_agentTestHelper->getAgent()->getCircularBuffer();
+  rest->start();
+
+  QueryMap query;
+  query["interval"] = "10";
+  query["heartbeat"] = "1000";
+  query["count"] = "10";
+  query["from"] = to_string(circ.getSequence());
+  query["path"] = "//DataItem[@name='line']";
+
+  PARSE_XML_STREAM_QUERY("/LinuxCNC/sample", query);
+  m_agentTestHelper->m_ioContext.run_for(20ms);
+
+  // Overrun the buffer before the client is given a chance to read
+  int size = circ.getBufferSize() + 20;
+  for (int i = 0; i < size; i++)
+    m_agentTestHelper->m_adapter->processData("2021-02-01T12:00:00Z|line|" + to_string(i));
+  auto next = circ.getSequence();
+
+  m_agentTestHelper->m_ioContext.run_for(50ms);
+
+  auto session = m_agentTestHelper->m_session;
+  ASSERT_TRUE(session->m_streaming);
+  ASSERT_TRUE(session->m_chunkId);
+  EXPECT_EQ(next, *session->m_chunkId);
+
+  {
+    PARSE_XML_CHUNK();
+    ASSERT_XML_PATH_COUNT(doc, "//m:Line", 1);
+    ASSERT_XML_PATH_EQUAL(doc, "//m:Line", to_string(size - 1).c_str());
+    ASSERT_XML_PATH_EQUAL(doc, "//m:Header@nextSequence", to_string(next).c_str());
+  }
+
+  auto metrics = rest->getStreamMetrics();
+  ASSERT_EQ(1, metrics.size());
+  EXPECT_EQ(1, metrics.front().m_coalesced);
+  EXPECT_LT(SequenceNumber_t(circ.getBufferSize()), metrics.front().m_maxLag);
+  EXPECT_EQ(0, metrics.front().m_bytesQueued);
+  EXPECT_LT(0, metrics.front().m_bytesSent);
+
+  session->closeStream();
+}
+
+TEST_F(AgentTest, should_disconnect_streaming_client_that_falls_out_of_the_buffer_when_configured)
+{
+  m_agentTestHelper->createAgent("/samples/test_config.xml", 8, 4, "1.3", 25, true, true,
+                                 {{configuration::DisconnectSlowClients, true}});
+  addAdapter();
+  auto rest = m_agentTestHelper->getRestService();
+  auto &circ = m_agentTestHelper->getAgent()->getCircularBuffer();
+  rest->start();
+
+  QueryMap query;
+  query["interval"] = "10";
+  query["heartbeat"] = "1000";
+  query["count"] = "10";
+  query["from"] = to_string(circ.getSequence());
+  query["path"] = "//DataItem[@name='line']";
+
+  PARSE_XML_STREAM_QUERY("/LinuxCNC/sample", query);
+  m_agentTestHelper->m_ioContext.run_for(20ms);
+
+  int size = circ.getBufferSize() + 20;
+  for (int i = 0; i < size; i++)
+    m_agentTestHelper->m_adapter->processData("2021-02-01T12:00:00Z|line|" + to_string(i));
+
+  m_agentTestHelper->m_ioContext.run_for(50ms);
+
+  auto session = m_agentTestHelper->m_session;
+  {
+    PARSE_XML_CHUNK();
+    ASSERT_XML_PATH_COUNT(doc, "//m:Line", 0);
+    ASSERT_XML_PATH_EQUAL(doc, "//m:Error@errorCode", "INVALID_REQUEST");
+    ASSERT_XML_PATH_EQUAL(doc, "//m:Error", "Client fell too far behind, disconnecting");
+  }
+
+  session->closeStream();
+}
+
 // ------------- Put tests
 
 TEST_F(AgentTest, Put)
@@ -2966,3 +3156,47 @@ TEST_F(AgentTest, device_should_have_hash_for_2_2)
     ASSERT_XML_PATH_EQUAL(doc, "//m:DeviceAdded[3]@hash", (*di)->get<string>("hash").c_str());
   }
 }
+
+TEST_F(AgentTest, observations_should_resolve_to_the_new_data_item_after_a_device_update)
+{
+  m_agentTestHelper->createAgent("/samples/test_config.xml", 8, 4, "2.0", 4, true);
+  addAdapter();
+  auto agent = m_agentTestHelper->getAgent();
+
+  m_agentTestHelper->m_adapter->processData("2021-02-01T12:00:00Z|line|204");
+
+  auto oldDataItem = agent->getDataItemById("p3");
+  ASSERT_TRUE(oldDataItem);
+  auto observation = agent->getCircularBuffer().getLatest().getObservation("p3");
+  ASSERT_TRUE(observation);
+  ASSERT_EQ(oldDataItem, observation->getDataItem());
+
+  auto deviceXml = R"DOC(
+<Device uuid="000" name="LinuxCNC" id="d">
+  <Components>
+    <Controller name="Controller" id="cont">
+      <Components>
+        <Path id="path">
+          <DataItems>
+            <DataItem type="LINE" category="EVENT" id="p3" name="line"/>
+            <DataItem type="EXECUTION" category="EVENT" id="p5" name="execution"/>
+          </DataItems>
+        </Path>
+      </Components>
+    </Controller>
+  </Components>
+</Device>
+)DOC";
+
+  auto printer = dynamic_cast<printer::XmlPrinter *>(agent->getPrinter("xml"));
+  auto device = agent->getXmlParser()->parseDevice(deviceXml, printer);
+  ASSERT_TRUE(device);
+  ASSERT_TRUE(agent->receiveDevice(device, false));
+  oldDataItem.reset();
+
+  // The observation in the buffer was not visited, the handle resolves to the new model
+  auto newDataItem = agent->getDataItemById("p3");
+  ASSERT_TRUE(newDataItem);
+  EXPECT_EQ(newDataItem, observation->getDataItem());
+  EXPECT_FALSE(observation->isOrphan());
+}
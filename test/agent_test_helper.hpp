@@ -63,6 +63,7 @@ namespace mtconnect {
           else
             m_body = response->m_body;
           m_mimeType = response->m_mimeType;
+          m_fields = response->m_fields;
           if (complete)
             complete();
         }
@@ -70,24 +71,31 @@ namespace mtconnect {
         {
           if (m_streaming)
           {
-            writeChunk(response->m_body, complete);
+            writeChunk(std::move(response->m_body), complete);
           }
           else
           {
             writeResponse(std::move(response), complete);
           }
         }
-        void beginStreaming(const std::string &mimeType, Complete complete) override
+        void beginStreaming(const std::string &mimeType, Complete complete,
+                            StreamFormat format = StreamFormat::MULTIPART) override
         {
           m_mimeType = mimeType;
+          m_streamFormat = format;
           m_streaming = true;
           complete();
         }
-        void writeChunk(const std::string &chunk, Complete complete) override
+        void writeChunk(std::string &&chunk, Complete complete,
+                        std::optional<mtconnect::SequenceNumber_t> id = std::nullopt) override
         {
-          m_chunkBody = chunk;
+          m_chunkBody = std::move(chunk);
+          m_chunkId = id;
           if (m_streaming)
-            complete();
+          {
+            if (complete)
+              complete();
+          }
           else
             std::cout << "Streaming done" << std::endl;
         }
@@ -96,11 +104,14 @@ namespace mtconnect {
 
         std::string m_body;
         std::string m_mimeType;
+        FieldList m_fields;
         boost::beast::http::status m_code;
         std::chrono::seconds m_expires;
 
         std::string m_chunkBody;
         std::string m_chunkMimeType;
+        std::optional<mtconnect::SequenceNumber_t> m_chunkId;
+        StreamFormat m_streamFormat {StreamFormat::MULTIPART};
         bool m_streaming {false};
       };
 
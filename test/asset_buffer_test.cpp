@@ -332,3 +332,94 @@ TEST_F(AssetBufferTest, verify_asset_counts_with_removal)
   ASSERT_EQ(6, counts10["Asset2"]);
   ASSERT_EQ(2, counts10["Asset3"]);
 }
+
+TEST_F(AssetBufferTest, should_page_through_asset_changes)
+{
+  ErrorList errors;
+  for (int i = 1; i <= 5; i++)
+  {
+    auto asset = makeAsset("Asset1", "A" + to_string(i), "D1",
+                           "2020-12-01T12:0" + to_string(i - 1) + ":00Z", errors);
+    ASSERT_EQ(0, errors.size());
+    m_assetBuffer->addAsset(asset);
+  }
+  ASSERT_EQ(6, m_assetBuffer->getNextChange());
+
+  AssetList list;
+  uint64_t next;
+  ASSERT_EQ(2, m_assetBuffer->getAssetChanges(list, next, 2, 0));
+  ASSERT_EQ("A1", list.front()->getAssetId());
+  ASSERT_EQ("A2", list.back()->getAssetId());
+  ASSERT_EQ(3, next);
+
+  list.clear();
+  ASSERT_EQ(2, m_assetBuffer->getAssetChanges(list, next, 2, next));
+  ASSERT_EQ("A3", list.front()->getAssetId());
+  ASSERT_EQ("A4", list.back()->getAssetId());
+  ASSERT_EQ(5, next);
+
+  list.clear();
+  ASSERT_EQ(1, m_assetBuffer->getAssetChanges(list, next, 2, next));
+  ASSERT_EQ("A5", list.front()->getAssetId());
+  ASSERT_EQ(6, next);
+
+  // Updates and removals are changes
+  auto asset = makeAsset("Asset1", "A2", "D1", "2020-12-01T12:05:00Z", errors);
+  m_assetBuffer->addAsset(asset);
+  m_assetBuffer->removeAsset("A3");
+
+  // Removed assets are part of the changes
+  list.clear();
+  ASSERT_EQ(2, m_assetBuffer->getAssetChanges(list, next, 10, next));
+  ASSERT_EQ("A2", list.front()->getAssetId());
+  ASSERT_EQ("A3", list.back()->getAssetId());
+  ASSERT_TRUE(list.back()->isRemoved());
+  ASSERT_EQ(8, next);
+
+  list.clear();
+  ASSERT_EQ(3, m_assetBuffer->getAssetChanges(list, next, 10, 0, nullopt, nullopt,
+                                              parseTimestamp("2020-12-01T12:04:00Z")));
+  auto it = list.begin();
+  ASSERT_EQ("A5", (*it++)->getAssetId());
+  ASSERT_EQ("A2", (*it++)->getAssetId());
+  ASSERT_EQ("A3", (*it++)->getAssetId());
+  ASSERT_EQ(8, next);
+
+  list.clear();
+  ASSERT_EQ(0, m_assetBuffer->getAssetChanges(list, next, 10, 0, "D2"s));
+
+  // Active assets are still returned most recently added first
+  list.clear();
+  ASSERT_EQ(4, m_assetBuffer->getAssets(list, 10));
+  it = list.begin();
+  ASSERT_EQ("A2", (*it++)->getAssetId());
+  ASSERT_EQ("A5", (*it++)->getAssetId());
+  ASSERT_EQ("A4", (*it++)->getAssetId());
+  ASSERT_EQ("A1", (*it++)->getAssetId());
+}
+
+TEST_F(AssetBufferTest, should_only_add_an_asset_when_it_changed)
+{
+  ErrorList errors;
+  auto asset = makeAsset("Asset1", "A1", "D1", "2020-12-01T12:00:00Z", errors);
+  ASSERT_EQ(0, errors.size());
+
+  int prepared = 0;
+  auto prepare = [&prepared](Asset &) { prepared++; };
+  ASSERT_TRUE(m_assetBuffer->addChangedAsset(asset, prepare));
+  ASSERT_EQ(1, prepared);
+  ASSERT_EQ(2, m_assetBuffer->getNextChange());
+
+  // Only the timestamp is different, the stored asset is kept
+  auto same = makeAsset("Asset1", "A1", "D1", "2020-12-01T12:05:00Z", errors);
+  ASSERT_FALSE(m_assetBuffer->addChangedAsset(same, prepare));
+  ASSERT_EQ(1, prepared);
+  ASSERT_EQ(2, m_assetBuffer->getNextChange());
+  ASSERT_EQ(asset, m_assetBuffer->getAsset("A1"));
+
+  auto moved = makeAsset("Asset1", "A1", "D2", "2020-12-01T12:05:00Z", errors);
+  ASSERT_TRUE(m_assetBuffer->addChangedAsset(moved, prepare));
+  ASSERT_EQ(2, prepared);
+  ASSERT_EQ(3, m_assetBuffer->getNextChange());
+  ASSERT_EQ(moved, m_assetBuffer->getAsset("A1"));
+}
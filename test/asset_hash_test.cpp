@@ -116,14 +116,16 @@ TEST_F(AssetHashTest, should_assign_hash_when_receiving_asset)
 --multiline--AAAA
 )");
 
+  // The content is the same, the stored asset is kept and no change is published
   auto asset2 = storage->getAsset("P1");
   auto hash2 = asset2->get<string>("hash");
 
+  ASSERT_EQ(asset, asset2);
   ASSERT_EQ(hash, hash2);
 
   {
     PARSE_XML_RESPONSE("/asset/P1");
-    ASSERT_XML_PATH_EQUAL(doc, "//m:Part@timestamp", "2023-02-01T12:00:00Z");
+    ASSERT_XML_PATH_EQUAL(doc, "//m:Part@timestamp", "2021-02-01T12:00:00Z");
     ASSERT_XML_PATH_EQUAL(doc, "//m:Part@hash", hash.c_str());
   }
 
@@ -131,6 +133,11 @@ TEST_F(AssetHashTest, should_assign_hash_when_receiving_asset)
     PARSE_XML_RESPONSE("/LinuxCNC/current");
     ASSERT_XML_PATH_EQUAL(doc, "//m:DeviceStream//m:AssetChanged@hash", hash.c_str());
   }
+
+  {
+    PARSE_XML_RESPONSE("/LinuxCNC/sample");
+    ASSERT_XML_PATH_COUNT(doc, "//m:DeviceStream//m:AssetChanged[.='P1']", 1);
+  }
 }
 
 TEST_F(AssetHashTest, hash_should_change_when_doc_changes)
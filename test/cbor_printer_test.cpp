@@ -0,0 +1,280 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "mtconnect/buffer/checkpoint.hpp"
+#include "mtconnect/device_model/data_item/data_item.hpp"
+#include "mtconnect/device_model/device.hpp"
+#include "mtconnect/observation/observation.hpp"
+#include "mtconnect/parser/xml_parser.hpp"
+#include "mtconnect/printer/cbor_printer.hpp"
+#include "mtconnect/printer/json_printer.hpp"
+#include "mtconnect/printer/xml_printer.hpp"
+#include "mtconnect/utilities.hpp"
+#include "test_utilities.hpp"
+
+using json = nlohmann::json;
+using namespace std;
+using namespace std::chrono;
+using namespace mtconnect;
+using namespace mtconnect::buffer;
+using namespace mtconnect::observation;
+using namespace mtconnect::entity;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+class CborPrinterTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_xmlPrinter = std::make_unique<printer::XmlPrinter>();
+    m_jsonPrinter = std::make_unique<printer::JsonPrinter>(2);
+    m_printer = std::make_unique<printer::CborPrinter>();
+    m_config = std::make_unique<parser::XmlParser>();
+    m_devices =
+        m_config->parseFile(PROJECT_ROOT_DIR "/samples/SimpleDevlce.xml", m_xmlPrinter.get());
+  }
+
+  void TearDown() override
+  {
+    m_config.reset();
+    m_xmlPrinter.reset();
+    m_jsonPrinter.reset();
+    m_printer.reset();
+  }
+
+  DataItemPtr getDataItem(const char *name)
+  {
+    for (auto &device : m_devices)
+    {
+      auto di = device->getDeviceDataItem(name);
+      if (di)
+        return di;
+    }
+    return nullptr;
+  }
+
+  void addObservationToList(ObservationList &list, const char *name, uint64_t sequence,
+                            Properties props, Timestamp time = chrono::system_clock::now())
+  {
+    const auto d = getDataItem(name);
+    ASSERT_TRUE(d) << "Could not find data item " << name;
+    ErrorList errors;
+    auto event = Observation::make(d, props, time, errors);
+    ASSERT_TRUE(event);
+    ASSERT_EQ(0, errors.size());
+
+    event->setSequence(sequence);
+    list.emplace_back(event);
+  }
+
+  json decode(const string &doc)
+  {
+    return json::from_cbor(doc, true, true, json::cbor_tag_handler_t::ignore);
+  }
+
+  vector<float> floats(const json &value)
+  {
+    const auto &bin = value.get_binary();
+    vector<float> result(bin.size() / 4);
+    for (size_t i = 0; i < result.size(); i++)
+    {
+      uint32_t bits = uint32_t(bin[i * 4]) | uint32_t(bin[i * 4 + 1]) << 8 |
+                      uint32_t(bin[i * 4 + 2]) << 16 | uint32_t(bin[i * 4 + 3]) << 24;
+      memcpy(&result[i], &bits, sizeof(float));
+    }
+    return result;
+  }
+
+protected:
+  std::unique_ptr<printer::CborPrinter> m_printer;
+  std::unique_ptr<printer::JsonPrinter> m_jsonPrinter;
+  std::unique_ptr<printer::XmlPrinter> m_xmlPrinter;
+  std::unique_ptr<parser::XmlParser> m_config;
+  std::list<DevicePtr> m_devices;
+};
+
+TEST_F(CborPrinterTest, should_print_stream_header)
+{
+  ObservationList list;
+  auto doc = m_printer->printSample(123, 131072, 10254805, 10123733, 10123800, list);
+  auto jdoc = decode(doc);
+
+  auto header = jdoc.at("/MTConnectStreams/Header"_json_pointer);
+  ASSERT_EQ(123, header.at("/instanceId"_json_pointer).get<int64_t>());
+  ASSERT_EQ(131072, header.at("/bufferSize"_json_pointer).get<int32_t>());
+  ASSERT_EQ(10254805, header.at("/nextSequence"_json_pointer).get<uint64_t>());
+  ASSERT_EQ(10123733, header.at("/firstSequence"_json_pointer).get<uint64_t>());
+  ASSERT_EQ(10123800, header.at("/lastSequence"_json_pointer).get<uint64_t>());
+  ASSERT_TRUE(jdoc.at("/MTConnectStreams/Observations"_json_pointer).empty());
+  ASSERT_EQ("application/mtconnect+cbor", m_printer->mimeType());
+}
+
+TEST_F(CborPrinterTest, should_intern_data_item_ids_and_use_binary_values)
+{
+  Timestamp now = chrono::system_clock::now();
+  ObservationList list;
+  addObservationToList(list, "dcbc0570", 10, Properties {{"VALUE", 1.5}}, now);
+  addObservationToList(list, "dcbc0570", 11, Properties {{"VALUE", 0.1}}, now);
+  addObservationToList(list, "if36ff60", 12, Properties {{"VALUE", "AUTOMATIC"s}}, now);
+  addObservationToList(list, "dcbc0570", 13, Properties {{"VALUE", 2.0}}, now);
+
+  auto doc = m_printer->printSample(123, 131072, 14, 1, 13, list);
+  auto jdoc = decode(doc);
+
+  auto ids = jdoc.at("/MTConnectStreams/DataItems"_json_pointer);
+  ASSERT_EQ(2, ids.size());
+  ASSERT_EQ("dcbc0570", ids[0].get<string>());
+  ASSERT_EQ("if36ff60", ids[1].get<string>());
+
+  auto obs = jdoc.at("/MTConnectStreams/Observations"_json_pointer);
+  ASSERT_EQ(4, obs.size());
+
+  auto micros = duration_cast<microseconds>(now.time_since_epoch()).count();
+  ASSERT_EQ(4, obs[0].size());
+  ASSERT_EQ(0, obs[0][0].get<int>());
+  ASSERT_EQ(10, obs[0][1].get<uint64_t>());
+  ASSERT_EQ(micros, obs[0][2].get<int64_t>());
+  ASSERT_EQ(1.5, obs[0][3].get<double>());
+
+  ASSERT_EQ(0.1, obs[1][3].get<double>());
+
+  ASSERT_EQ(1, obs[2][0].get<int>());
+  ASSERT_EQ("AUTOMATIC", obs[2][3].get<string>());
+
+  ASSERT_EQ(0, obs[3][0].get<int>());
+  ASSERT_EQ(2.0, obs[3][3].get<double>());
+}
+
+TEST_F(CborPrinterTest, should_pack_time_series_as_float_array)
+{
+  ObservationList list;
+  addObservationToList(list, "tc9edc70", 10254804,
+                       Properties {{"sampleCount", int64_t(4)},
+                                   {"sampleRate", 100.0},
+                                   {"VALUE", Vector {1.0, 2.5, 3.0, 4.25}}});
+  auto doc = m_printer->printSample(123, 131072, 10254805, 10123733, 10123800, list);
+
+  // Tag 85 (0xD8 0x55) marks a little endian float32 typed array
+  ASSERT_NE(string::npos, doc.find("\xD8\x55"));
+
+  auto jdoc = decode(doc);
+  auto obs = jdoc.at("/MTConnectStreams/Observations/0"_json_pointer);
+  ASSERT_EQ(5, obs.size());
+
+  ASSERT_TRUE(obs[3].is_binary());
+  auto values = floats(obs[3]);
+  ASSERT_EQ(4, values.size());
+  ASSERT_EQ(1.0f, values[0]);
+  ASSERT_EQ(2.5f, values[1]);
+  ASSERT_EQ(3.0f, values[2]);
+  ASSERT_EQ(4.25f, values[3]);
+
+  ASSERT_EQ(4, obs[4].at("sampleCount").get<int>());
+  ASSERT_EQ(100.0, obs[4].at("sampleRate").get<double>());
+}
+
+TEST_F(CborPrinterTest, should_include_condition_level_and_native_code)
+{
+  ObservationList list;
+  addObservationToList(list, "a5b23650", 10254804,
+                       Properties {{"level", "fault"s},
+                                   {"nativeCode", "syn"s},
+                                   {"nativeSeverity", "ack"s},
+                                   {"qualifier", "HIGH"s},
+                                   {"VALUE", "Syntax error"s}});
+  auto doc = m_printer->printSample(123, 131072, 10254805, 10123733, 10123800, list);
+  auto jdoc = decode(doc);
+
+  auto obs = jdoc.at("/MTConnectStreams/Observations/0"_json_pointer);
+  ASSERT_EQ(5, obs.size());
+  ASSERT_EQ("Syntax error", obs[3].get<string>());
+  ASSERT_EQ("Fault", obs[4].at("level").get<string>());
+  ASSERT_EQ("syn", obs[4].at("nativeCode").get<string>());
+  ASSERT_EQ("ack", obs[4].at("nativeSeverity").get<string>());
+  ASSERT_EQ("HIGH", obs[4].at("qualifier").get<string>());
+}
+
+TEST_F(CborPrinterTest, should_print_probe_and_errors)
+{
+  auto probe = decode(m_printer->printProbe(123, 9999, 1, 1024, 10, m_devices));
+  auto devices = probe.at("/MTConnectDevices/Devices"_json_pointer);
+  ASSERT_EQ(1, devices.size());
+  ASSERT_TRUE(devices[0].contains("Device"));
+  ASSERT_EQ(1024, probe.at("/MTConnectDevices/Header/assetBufferSize"_json_pointer).get<int>());
+
+  auto error = decode(m_printer->printError(123, 9999, 1, "BAD_BAD", "Never do that again"));
+  auto errors = error.at("/MTConnectError/Errors"_json_pointer);
+  ASSERT_EQ(1, errors.size());
+  ASSERT_EQ("BAD_BAD", errors[0].at("errorCode").get<string>());
+  ASSERT_EQ("Never do that again", errors[0].at("value").get<string>());
+}
+
+TEST_F(CborPrinterTest, should_be_smaller_than_xml_and_json)
+{
+  // Identical observation window printed by each printer
+  ObservationList list;
+  Timestamp now = chrono::system_clock::now();
+  uint64_t seq = 1;
+  for (int i = 0; i < 1000; i++)
+  {
+    auto ts = now + microseconds(i * 1000);
+    addObservationToList(list, "dcbc0570", seq++, Properties {{"VALUE", 100.0 + i * 0.123}}, ts);
+    addObservationToList(list, "f646f730", seq++, Properties {{"VALUE", double(i % 100)}}, ts);
+    addObservationToList(list, "r186cd60", seq++,
+                         Properties {{"VALUE", Vector {i * 1.0, i * 2.0, i * 3.0}}}, ts);
+    if (i % 10 == 0)
+    {
+      Vector values;
+      for (int j = 0; j < 100; j++)
+        values.push_back(j * 0.5);
+      addObservationToList(list, "tc9edc70", seq++,
+                           Properties {{"sampleCount", int64_t(values.size())},
+                                       {"sampleRate", 1000.0},
+                                       {"VALUE", values}},
+                           ts);
+    }
+  }
+
+  auto size = [&](const printer::Printer *printer) {
+    return printer->printSample(123, 131072, seq, 1, seq - 1, list).size();
+  };
+
+  auto xml = size(m_xmlPrinter.get());
+  auto jsn = size(m_jsonPrinter.get());
+  auto cbor = size(m_printer.get());
+
+  EXPECT_LT(cbor, jsn);
+  EXPECT_LT(cbor, xml);
+}
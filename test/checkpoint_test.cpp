@@ -108,36 +108,36 @@ TEST_F(CheckpointTest, AddObservations)
   ASSERT_TRUE(p1);
   EXPECT_EQ(1, p1.use_count());
   m_checkpoint->addObservation(p1);
-  EXPECT_EQ(2, p1.use_count());
+  EXPECT_EQ(3, p1.use_count());
 
   auto p2 = observation::Observation::make(m_dataItem1, warning2, time, errors);
   ASSERT_TRUE(p2);
   m_checkpoint->addObservation(p2);
 
   {
-    auto prev = dynamic_pointer_cast<Condition>(p2)->getPrev();
-    ASSERT_TRUE(prev);
-    EXPECT_EQ(p1, prev);
+    auto set = m_checkpoint->getConditions("1");
+    ASSERT_TRUE(set);
+    ASSERT_EQ(2, set->size());
+    EXPECT_EQ(p1, set->getConditions().front());
+    EXPECT_EQ(p2, set->getNewest());
   }
 
   auto p3 = observation::Observation::make(m_dataItem1, normal, time, errors);
   ASSERT_TRUE(p3);
   m_checkpoint->addObservation(p3);
 
-  {
-    auto prev = dynamic_pointer_cast<Condition>(p3)->getPrev();
-    ASSERT_FALSE(prev);
-  }
-
-  EXPECT_EQ(2, p1.use_count());
+  ASSERT_FALSE(m_checkpoint->getConditions("1"));
+  EXPECT_EQ(1, p1.use_count());
   EXPECT_EQ(1, p2.use_count());
 
   auto p4 = observation::Observation::make(m_dataItem1, warning1, time, errors);
   m_checkpoint->addObservation(p4);
 
   {
-    auto prev = dynamic_pointer_cast<Condition>(p4)->getPrev();
-    ASSERT_FALSE(prev);
+    auto set = m_checkpoint->getConditions("1");
+    ASSERT_TRUE(set);
+    ASSERT_EQ(1, set->size());
+    EXPECT_EQ(p4, set->getNewest());
   }
   EXPECT_EQ(1, p3.use_count());
 
@@ -171,17 +171,19 @@ TEST_F(CheckpointTest, Copy)
 
   auto p1 = observation::Observation::make(m_dataItem1, warning1, time, errors);
   m_checkpoint->addObservation(p1);
-  ASSERT_EQ(2, p1.use_count());
+  ASSERT_EQ(3, p1.use_count());
 
   auto p2 = observation::Observation::make(m_dataItem1, warning2, time, errors);
   m_checkpoint->addObservation(p2);
-  ASSERT_EQ(2, p2.use_count());
+  ASSERT_EQ(3, p2.use_count());
+  ASSERT_EQ(2, p1.use_count());
 
+  // The active condition set is shared with the copy
   auto copy = make_unique<Checkpoint>(*m_checkpoint);
   ASSERT_EQ(2, p1.use_count());
-  ASSERT_EQ(3, p2.use_count());
+  ASSERT_EQ(4, p2.use_count());
   copy.reset();
-  ASSERT_EQ(2, p2.use_count());
+  ASSERT_EQ(3, p2.use_count());
 }
 
 TEST_F(CheckpointTest, GetObservations)
@@ -404,7 +406,7 @@ TEST_F(CheckpointTest, ConditionChaining)
 
   auto p1 = observation::Observation::make(m_dataItem1, warning1, time, errors);
   m_checkpoint->addObservation(p1);
-  ASSERT_EQ(2, p1.use_count());
+  ASSERT_EQ(3, p1.use_count());
 
   m_checkpoint->getObservations(list);
   ASSERT_EQ(1, list.size());
@@ -412,24 +414,29 @@ TEST_F(CheckpointTest, ConditionChaining)
 
   auto p2 = observation::Observation::make(m_dataItem1, warning2, time, errors);
   m_checkpoint->addObservation(p2);
-  ASSERT_EQ(2, p2.use_count());
+  ASSERT_EQ(3, p2.use_count());
   ASSERT_EQ(2, p1.use_count());
 
   list.clear();
   m_checkpoint->getObservations(list);
   ASSERT_EQ(2, list.size());
-  ASSERT_EQ(p1, dynamic_pointer_cast<Condition>(p2)->getPrev());
+  ASSERT_EQ(p2, list.front());
+  ASSERT_EQ(p1, list.back());
   list.clear();
 
   auto p3 = observation::Observation::make(m_dataItem1, warning3, time, errors);
   m_checkpoint->addObservation(p3);
-  ASSERT_EQ(2, p3.use_count());
+  ASSERT_EQ(3, p3.use_count());
   ASSERT_EQ(2, p2.use_count());
   ASSERT_EQ(2, p1.use_count());
 
-  ASSERT_EQ(p2, dynamic_pointer_cast<Condition>(p3)->getPrev());
-  ASSERT_EQ(p1, dynamic_pointer_cast<Condition>(p2)->getPrev());
-  ASSERT_FALSE(dynamic_pointer_cast<Condition>(p1)->getPrev());
+  {
+    auto conditions = m_checkpoint->getConditions("1")->getConditions();
+    ASSERT_EQ(3, conditions.size());
+    ASSERT_EQ(p1, conditions[0]);
+    ASSERT_EQ(p2, conditions[1]);
+    ASSERT_EQ(p3, conditions[2]);
+  }
 
   list.clear();
   m_checkpoint->getObservations(list);
@@ -439,20 +446,23 @@ TEST_F(CheckpointTest, ConditionChaining)
   // Replace Warning on CODE 2 with a fault
   auto p4 = observation::Observation::make(m_dataItem1, fault2, time, errors);
   m_checkpoint->addObservation(p4);
-  ASSERT_EQ(2, p4.use_count());
-  ASSERT_EQ(1, p3.use_count());
-  ASSERT_EQ(2, p2.use_count());
+  ASSERT_EQ(3, p4.use_count());
+  ASSERT_EQ(2, p3.use_count());
+  ASSERT_EQ(1, p2.use_count());
   ASSERT_EQ(2, p1.use_count());
 
-  // Should have been deep copyied
-  ASSERT_NE(p3, Cond(p4)->getPrev());
-
-  // Codes should still match
-  ASSERT_EQ(Cond(p3)->getCode(), Cond(p4)->getPrev()->getCode());
-  ASSERT_EQ(2, Cond(p4)->getPrev().use_count());
-  ASSERT_EQ(Cond(p1)->getCode(), Cond(p4)->getPrev()->getPrev()->getCode());
-  ASSERT_EQ(2, Cond(p4)->getPrev()->getPrev().use_count());
-  ASSERT_FALSE(Cond(p4)->getPrev()->getPrev()->getPrev());
+  // The other conditions are not copied, the fault is now the newest
+  {
+    auto conditions = m_checkpoint->getConditions("1")->getConditions();
+    ASSERT_EQ(3, conditions.size());
+    ASSERT_EQ(p1, conditions[0]);
+    ASSERT_EQ(p3, conditions[1]);
+    ASSERT_EQ(p4, conditions[2]);
+
+    // Codes should still match
+    ASSERT_EQ(Cond(p3)->getCode(), conditions[1]->getCode());
+    ASSERT_EQ(Cond(p1)->getCode(), conditions[0]->getCode());
+  }
 
   list.clear();
   m_checkpoint->getObservations(list);
@@ -461,16 +471,20 @@ TEST_F(CheckpointTest, ConditionChaining)
 
   auto p5 = observation::Observation::make(m_dataItem1, normal2, time, errors);
   m_checkpoint->addObservation(p5);
-  ASSERT_FALSE(Cond(p5)->getPrev());
+  ASSERT_EQ(1, p5.use_count());
+  ASSERT_EQ(1, p4.use_count());
 
-  // Check cleanup
+  // Check cleanup, the newest remaining condition is the current observation
   ObservationPtr p7 = m_checkpoint->getObservations().at(std::string("1"));
   ASSERT_TRUE(p7);
-  ASSERT_EQ(2, p7.use_count());
   ASSERT_NE(p5, p7);
+  ASSERT_EQ(p3, p7);
   ASSERT_EQ(std::string("CODE3"), Cond(p7)->getCode());
-  ASSERT_EQ(std::string("CODE1"), Cond(p7)->getPrev()->getCode());
-  ASSERT_FALSE(Cond(p7)->getPrev()->getPrev());
+  {
+    auto conditions = m_checkpoint->getConditions("1")->getConditions();
+    ASSERT_EQ(2, conditions.size());
+    ASSERT_EQ(std::string("CODE1"), conditions.front()->getCode());
+  }
 
   list.clear();
   m_checkpoint->getObservations(list);
@@ -480,13 +494,52 @@ TEST_F(CheckpointTest, ConditionChaining)
   // Clear all
   auto p6 = observation::Observation::make(m_dataItem1, normal, time, errors);
   m_checkpoint->addObservation(p6);
-  ASSERT_FALSE(Cond(p6)->getPrev());
+  ASSERT_FALSE(m_checkpoint->getConditions("1"));
+  ASSERT_EQ(1, p1.use_count());
+  ASSERT_EQ(2, p3.use_count());
 
   list.clear();
   m_checkpoint->getObservations(list);
   ASSERT_EQ(1, (int)list.size());
 }
 
+TEST_F(CheckpointTest, should_share_active_conditions_until_changed)
+{
+  entity::ErrorList errors;
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h + 1min;
+  auto warning1 = entity::Properties {{"level", "WARNING"s}, {"nativeCode", "CODE1"s}};
+  auto warning2 = entity::Properties {{"level", "WARNING"s}, {"nativeCode", "CODE2"s}};
+  auto normal1 = entity::Properties {{"nativeCode", "CODE1"s}, {"level", "NORMAL"s}};
+
+  auto p1 = observation::Observation::make(m_dataItem1, warning1, time, errors);
+  m_checkpoint->addObservation(p1);
+  auto p2 = observation::Observation::make(m_dataItem1, warning2, time, errors);
+  m_checkpoint->addObservation(p2);
+
+  Checkpoint copy(*m_checkpoint);
+  ASSERT_EQ(m_checkpoint->getConditions("1"), copy.getConditions("1"));
+
+  auto p3 = observation::Observation::make(m_dataItem1, normal1, time, errors);
+  copy.addObservation(p3);
+
+  auto original = m_checkpoint->getConditions("1");
+  ASSERT_EQ(2, original->size());
+  ASSERT_EQ(p1, original->find("CODE1"));
+
+  auto changed = copy.getConditions("1");
+  ASSERT_NE(original, changed);
+  ASSERT_EQ(1, changed->size());
+  ASSERT_FALSE(changed->find("CODE1"));
+  ASSERT_EQ(p2, copy.getObservation("1"));
+
+  ObservationList list;
+  m_checkpoint->getObservations(list);
+  ASSERT_EQ(2, list.size());
+  list.clear();
+  copy.getObservations(list);
+  ASSERT_EQ(1, list.size());
+}
+
 TEST_F(CheckpointTest, LastConditionNormal)
 {
   entity::ErrorList errors;
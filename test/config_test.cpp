@@ -130,6 +130,23 @@ namespace {
     ASSERT_EQ("1.1", *agent->getSchemaVersion());
   }
 
+  TEST_F(ConfigTest, should_ignore_rules_that_cannot_be_loaded)
+  {
+    string str("Devices = " PROJECT_ROOT_DIR
+               "/samples/test_config.xml\n"
+               "Rules {\n"
+               "  BadDrop {\n    DataItem = exec\n    Drop = maybe\n  }\n"
+               "  BadWhen {\n    DataItem = exec\n    When = value >\n  }\n"
+               "}\n");
+    ASSERT_NO_THROW(m_config->loadConfig(str));
+
+    const auto agent = m_config->getAgent();
+    ASSERT_TRUE(agent);
+    auto pipeline = agent->getSources().back()->getPipeline();
+    ASSERT_TRUE(pipeline);
+    ASSERT_TRUE(pipeline->find("RuleTransform").empty());
+  }
+
   TEST_F(ConfigTest, BufferSize)
   {
     m_config->loadConfig("BufferSize = 4\n");
@@ -1180,6 +1197,99 @@ Port = 0
     th.join();
   }
 
+  TEST_F(ConfigTest, should_rebuild_only_the_changed_adapter_without_restarting)
+  {
+    fs::path root {createTempDirectory("adapters")};
+    auto &context = m_config->getAsyncContext();
+
+    fs::path devices(root / "Devices.xml");
+    fs::path config {root / "agent.cfg"};
+    auto writeConfig = [&](int port) {
+      ofstream cfg(config.string());
+      cfg << R"DOC(
+MonitorConfigFiles = true
+MonitorInterval = 1
+MinimumConfigReloadAge = 1
+Port = 0
+)DOC";
+      cfg << "Devices = " << devices << endl;
+      cfg << "Adapters {\n  a {\n    Device = LinuxCNC\n    Port = " << port
+          << "\n  }\n  b {\n    Device = LinuxCNC\n    Port = 7900\n  }\n}\n";
+    };
+    writeConfig(7878);
+
+    copyFile("min_config.xml", devices, 0s);
+
+    boost::program_options::variables_map options;
+    boost::program_options::variable_value value(boost::optional<string>(config.string()), false);
+    options.insert(make_pair("config-file"s, value));
+
+    auto t = fs::last_write_time(config);
+    fs::last_write_time(config, t - 1min);
+
+    m_config->initialize(options);
+
+    auto agent = m_config->getAgent();
+    const auto rest =
+        dynamic_pointer_cast<sink::rest_sink::RestService>(agent->findSink("RestService"));
+    ASSERT_TRUE(rest);
+    auto instance = rest->instanceId();
+
+    auto ports = [](Agent *agent) {
+      set<unsigned int> ports;
+      for (auto &s : agent->getSources())
+      {
+        if (auto adapter = dynamic_pointer_cast<source::adapter::shdr::ShdrAdapter>(s))
+          ports.insert(adapter->getPort());
+      }
+      return ports;
+    };
+    ASSERT_EQ((set<unsigned int> {7878, 7900}), ports(agent));
+    auto other = agent->getSources().back();
+
+    boost::asio::steady_timer timer1(context.get());
+    timer1.expires_from_now(1s);
+    timer1.async_wait([&](boost::system::error_code ec) {
+      if (ec)
+      {
+        m_config->stop();
+      }
+      else
+      {
+        writeConfig(7879);
+        fs::last_write_time(config, fs::file_time_type::clock::now());
+      }
+    });
+
+    auto th = thread([this, agent, instance, other, &ports, &context]() {
+      this_thread::sleep_for(5s);
+
+      boost::asio::steady_timer timer1(context.get());
+      timer1.expires_from_now(1s);
+      timer1.async_wait([this, agent, instance, other, &ports](boost::system::error_code ec) {
+        if (!ec)
+        {
+          // Same agent and instance, only adapter a was replaced
+          auto agent2 = m_config->getAgent();
+          EXPECT_EQ(agent, agent2);
+          const auto rest =
+              dynamic_pointer_cast<sink::rest_sink::RestService>(agent2->findSink("RestService"));
+          EXPECT_EQ(instance, rest->instanceId());
+          EXPECT_EQ((set<unsigned int> {7879, 7900}), ports(agent2));
+
+          bool kept = false;
+          for (auto &s : agent2->getSources())
+            kept = kept || s == other;
+          EXPECT_TRUE(kept);
+        }
+      });
+      m_config->stop();
+    });
+
+    m_config->start();
+    th.join();
+  }
+
   TEST_F(ConfigTest, should_reload_device_xml_and_add_new_devices)
   {
     fs::path root {createTempDirectory("4")};
@@ -532,3 +532,63 @@ TEST_F(DataItemMappingTest, continue_after_conversion_error)
   ASSERT_TRUE(prog->isEvent());
   ASSERT_EQ("program", program->getValue<string>());
 }
+
+TEST_F(DataItemMappingTest, should_build_simple_observations_the_same_as_the_factory)
+{
+  auto pos = makeDataItem(
+      {{"id", "a"s}, {"type", "POSITION"s}, {"category", "SAMPLE"s}, {"units", "MILLIMETER"s}});
+  auto count = makeDataItem(
+      {{"id", "b"s}, {"type", "PART_COUNT"s}, {"category", "EVENT"s}, {"units", "COUNT"s}});
+  auto dbl = makeDataItem(
+      {{"id", "c"s}, {"type", "LENGTH"s}, {"category", "EVENT"s}, {"units", "MILLIMETER"s}});
+  auto prog = makeDataItem({{"id", "d"s}, {"type", "PROGRAM"s}, {"category", "EVENT"s}});
+  auto cond = makeDataItem({{"id", "e"s}, {"type", "TEMPERATURE"s}, {"category", "CONDITION"s}});
+
+  ASSERT_EQ(ObservationBuilder::SAMPLE, ObservationBuilder(pos).getKind());
+  ASSERT_EQ(ObservationBuilder::INT_EVENT, ObservationBuilder(count).getKind());
+  ASSERT_EQ(ObservationBuilder::DOUBLE_EVENT, ObservationBuilder(dbl).getKind());
+  ASSERT_EQ(ObservationBuilder::EVENT, ObservationBuilder(prog).getKind());
+  ASSERT_FALSE(ObservationBuilder(cond).isDirect());
+
+  auto ts = makeTimestamped({"a", "1.5", "b", "12", "c", "2.5", "d", "program", "a",
+                             "unavailable", "a", "ABC"});
+  auto observations = (*m_mapper)(ts);
+  auto oblist = observations->getValue<EntityList>();
+  ASSERT_EQ(6, oblist.size());
+
+  ErrorList errors;
+  auto expected = [&](DataItemPtr di, const Properties &props) {
+    return Observation::make(di, props, ts->m_timestamp, errors);
+  };
+  auto check = [](ObservationPtr exp, EntityPtr ent) {
+    auto obs = dynamic_pointer_cast<Observation>(ent);
+    ASSERT_TRUE(obs);
+    ASSERT_EQ(typeid(*exp), typeid(*obs));
+    ASSERT_EQ(exp->getName(), obs->getName());
+    ASSERT_EQ(exp->getDataItem(), obs->getDataItem());
+    ASSERT_EQ(exp->getTimestamp(), obs->getTimestamp());
+    ASSERT_EQ(exp->isUnavailable(), obs->isUnavailable());
+    ASSERT_EQ(exp->getProperties(), obs->getProperties());
+  };
+
+  auto it = oblist.begin();
+  check(expected(pos, {{"VALUE", 1.5}}), *it++);
+  check(expected(count, {{"VALUE", int64_t(12)}}), *it++);
+  check(expected(dbl, {{"VALUE", 2.5}}), *it++);
+  check(expected(prog, {{"VALUE", "program"s}}), *it++);
+  check(expected(pos, {}), *it++);
+
+  // Values that cannot be converted fall back to the factory
+  auto bad = dynamic_pointer_cast<Sample>(*it++);
+  ASSERT_TRUE(bad);
+  ASSERT_TRUE(bad->isUnavailable());
+
+  // Numbers are parsed the same way as the factory converts them
+  ObservationBuilder builder(pos);
+  for (auto value : {"1.5"s, "+1.5"s, "-2e3"s, "0x10"s, "3.25 "s, "7mm"s})
+  {
+    auto obs = builder.make(pos, value, ts->m_timestamp);
+    ASSERT_TRUE(obs) << value;
+    check(expected(pos, {{"VALUE", value}}), obs);
+  }
+}
@@ -234,3 +234,26 @@ TEST_F(DataItemTest, SampleRate)
 
   ASSERT_EQ(42000, d->get<double>("sampleRate"));
 }
+
+TEST_F(DataItemTest, should_create_the_handle_with_the_data_item)
+{
+  const auto &handle = m_dataItemA->getHandle();
+  ASSERT_TRUE(handle);
+  ASSERT_EQ(m_dataItemA, handle->get());
+  ASSERT_NE(handle, m_dataItemB->getHandle());
+
+  // A new version of the data item takes over the handle
+  Properties props {{"id", "1"s},
+                    {"name", "DataItemTest1"s},
+                    {"type", "ACCELERATION"s},
+                    {"category", "SAMPLE"s},
+                    {"units", "PERCENT"s}};
+  ErrorList errors;
+  auto update = DataItem::make(props, errors);
+  EXPECT_EQ(0, errors.size());
+
+  auto previous = handle;
+  update->setHandle(previous);
+  ASSERT_EQ(previous, update->getHandle());
+  ASSERT_EQ(update, previous->get());
+}
@@ -19,7 +19,9 @@
 #include <gtest/gtest.h>
 // Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
 
+#include <atomic>
 #include <cstdio>
+#include <thread>
 
 #include "agent_test_helper.hpp"
 #include "json_helper.hpp"
@@ -243,6 +245,107 @@ TEST_F(DataSetTest, UpdateOneElement)
   ASSERT_EQ(6, get<int64_t>(map2.find("e"_E)->m_value));
 }
 
+TEST_F(DataSetTest, should_merge_without_changing_shared_data_sets)
+{
+  ErrorList errors;
+  auto time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h + 1min;
+
+  string value;
+  for (int i = 0; i < 200; i++)
+    value += "k" + to_string(i) + "=" + to_string(i) + " ";
+  auto ce = Observation::make(m_dataItem1, Properties {{"VALUE", value}}, time, errors);
+  ASSERT_EQ(0, errors.size());
+  m_checkpoint->addObservation(ce);
+
+  auto ce2 = Observation::make(m_dataItem1, Properties {{"VALUE", "k5=50"s}}, time, errors);
+  m_checkpoint->addObservation(ce2);
+
+  // Hold a reference to the merged event so the next merge must copy it
+  auto shared = m_checkpoint->getObservation("v1");
+  ASSERT_EQ(200, shared->getValue<DataSet>().size());
+  ASSERT_EQ(50, shared->getValue<DataSet>().get<int64_t>("k5"));
+
+  auto ce3 = Observation::make(m_dataItem1, Properties {{"VALUE", "k6=60 k7"s}}, time, errors);
+  m_checkpoint->addObservation(ce3);
+
+  ASSERT_EQ(200, shared->getValue<DataSet>().size());
+  ASSERT_EQ(6, shared->getValue<DataSet>().get<int64_t>("k6"));
+  ASSERT_EQ(200, shared->get<int64_t>("count"));
+
+  // Merge again without any other references
+  shared.reset();
+  auto ce4 =
+      Observation::make(m_dataItem1, Properties {{"VALUE", "k8=80 k300=300"s}}, time, errors);
+  m_checkpoint->addObservation(ce4);
+
+  auto latest = m_checkpoint->getObservation("v1");
+  auto &set = latest->getValue<DataSet>();
+  ASSERT_EQ(200, set.size());
+  ASSERT_EQ(200, latest->get<int64_t>("count"));
+  ASSERT_EQ(50, set.get<int64_t>("k5"));
+  ASSERT_EQ(60, set.get<int64_t>("k6"));
+  ASSERT_FALSE(set.maybeGet<int64_t>("k7"));
+  ASSERT_EQ(80, set.get<int64_t>("k8"));
+  ASSERT_EQ(300, set.get<int64_t>("k300"));
+  ASSERT_EQ(199, set.get<int64_t>("k199"));
+
+  // The events that were merged are not changed
+  ASSERT_EQ(200, ce->getValue<DataSet>().size());
+  ASSERT_EQ(1, ce2->getValue<DataSet>().size());
+  ASSERT_EQ(2, ce3->getValue<DataSet>().size());
+}
+
+TEST_F(DataSetTest, should_read_the_latest_data_set_while_it_is_updated)
+{
+  ErrorList errors;
+  auto time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h + 1min;
+  CircularBuffer buffer(8, 4);
+
+  string value;
+  for (int i = 0; i < 200; i++)
+    value += "k" + to_string(i) + "=" + to_string(i) + " ";
+  auto obs = Observation::make(m_dataItem1, Properties {{"VALUE", value}}, time, errors);
+  ASSERT_EQ(0, errors.size());
+  buffer.addToBuffer(obs);
+
+  // The agent updates the checkpoint while readers copy the observations under the buffer lock
+  // and use the data set after releasing it.
+  atomic_bool done {false};
+  thread writer([&]() {
+    for (int i = 0; i < 2000; i++)
+    {
+      ErrorList errs;
+      auto o = Observation::make(
+          m_dataItem1, Properties {{"VALUE", "k" + to_string(i % 200) + "=" + to_string(i)}},
+          time, errs);
+      buffer.addToBuffer(o);
+    }
+    done = true;
+  });
+
+  int reads = 0;
+  while (!done || reads == 0)
+  {
+    ObservationList list;
+    {
+      std::lock_guard<CircularBuffer> lock(buffer);
+      buffer.getLatest().getObservations(list);
+    }
+
+    ASSERT_EQ(1, list.size());
+    auto &set = list.front()->getValue<DataSet>();
+    ASSERT_EQ(200, set.size());
+    for (auto &e : set)
+      ASSERT_EQ(stoi(e.m_key.substr(1)), get<int64_t>(e.m_value) % 200);
+    reads++;
+  }
+  writer.join();
+
+  auto &latest = buffer.getLatest().getObservation("v1")->getValue<DataSet>();
+  ASSERT_EQ(200, latest.size());
+  ASSERT_EQ(1999, latest.get<int64_t>("k199"));
+}
+
 TEST_F(DataSetTest, UpdateMany)
 {
   ErrorList errors;
@@ -245,9 +245,10 @@ TEST_F(DuplicateFilterTest, test_condition_duplicates)
     ASSERT_TRUE(cond);
     ASSERT_EQ("YYY", cond->get<string>("nativeCode"));
     ASSERT_EQ(Condition::WARNING, cond->getLevel());
-    auto prev = cond->getPrev();
-    ASSERT_TRUE(prev);
-    ASSERT_FALSE(prev->getPrev());
+    auto set = contract->m_checkpoint.getConditions("c1");
+    ASSERT_TRUE(set);
+    ASSERT_EQ(2, set->size());
+    auto prev = set->getConditions().front();
     ASSERT_EQ("XXX", prev->get<string>("nativeCode"));
     ASSERT_EQ("100", prev->get<string>("nativeSeverity"));
   }
@@ -264,10 +265,11 @@ TEST_F(DuplicateFilterTest, test_condition_duplicates)
     ASSERT_EQ("101", cond->get<string>("nativeSeverity"));
     ASSERT_EQ("XXX", cond->get<string>("nativeCode"));
 
-    auto prev = cond->getPrev();
-    ASSERT_TRUE(prev);
+    auto set = contract->m_checkpoint.getConditions("c1");
+    ASSERT_TRUE(set);
+    ASSERT_EQ(2, set->size());
+    auto prev = set->getConditions().front();
     ASSERT_EQ("YYY", prev->get<string>("nativeCode"));
-    ASSERT_FALSE(prev->getPrev());
   }
 
   {
@@ -280,7 +282,7 @@ TEST_F(DuplicateFilterTest, test_condition_duplicates)
     auto cond = dynamic_pointer_cast<Condition>(obs);
     ASSERT_EQ("YYY", cond->get<string>("nativeCode"));
     ASSERT_TRUE(cond);
-    ASSERT_FALSE(cond->getPrev());
+    ASSERT_EQ(1, contract->m_checkpoint.getConditions("c1")->size());
   }
 
   {
@@ -299,7 +301,7 @@ TEST_F(DuplicateFilterTest, test_condition_duplicates)
     auto cond = dynamic_pointer_cast<Condition>(obs);
     ASSERT_TRUE(cond);
     ASSERT_EQ(Condition::NORMAL, cond->getLevel());
-    ASSERT_FALSE(cond->getPrev());
+    ASSERT_FALSE(contract->m_checkpoint.getConditions("c1"));
   }
 
   {
@@ -37,15 +37,18 @@
 #include <mruby/proc.h>
 #include <mruby/string.h>
 #include <mruby/variable.h>
+#include <set>
 #include <string>
 
 #include "mtconnect/agent.hpp"
 #include "mtconnect/configuration/agent_config.hpp"
 #include "mtconnect/configuration/config_options.hpp"
+#include "mtconnect/configuration/parser.hpp"
 #include "mtconnect/device_model/data_item/data_item.hpp"
 #include "mtconnect/pipeline/shdr_tokenizer.hpp"
 #include "mtconnect/printer//xml_printer.hpp"
 #include "mtconnect/ruby/ruby_smart_ptr.hpp"
+#include "mtconnect/ruby/ruby_transform.hpp"
 #include "mtconnect/ruby/ruby_vm.hpp"
 #include "mtconnect/sink/rest_sink/rest_service.hpp"
 #include "mtconnect/source/adapter/shdr/shdr_adapter.hpp"
@@ -101,6 +104,12 @@ namespace {
     AssetPtr m_asset;
   };
 
+  class ReloadConfiguration : public AgentConfiguration
+  {
+  public:
+    using AgentConfiguration::reloadAdapters;
+  };
+
   class EmbeddedRubyTest : public testing::Test
   {
   protected:
@@ -316,6 +325,131 @@ $source.pipeline.splice_after('Start', FixExecution.new('FixExec', :Event))
     ASSERT_EQ("READY", contract->m_observation->getValue<string>());
   }
 
+  TEST_F(EmbeddedRubyTest, should_load_the_module_into_a_vm_for_each_pipeline)
+  {
+    string str("Devices = " PROJECT_ROOT_DIR
+               "/samples/test_config.xml\n"
+               "Ruby {\n"
+               "  module = " PROJECT_ROOT_DIR
+               "/test/resources/ruby/should_transform_each_pipeline.rb\n"
+               "  PerPipeline = true\n"
+               "}\n");
+    m_config->loadConfig(str);
+
+    auto sources = m_config->getAgent()->getSources();
+    ASSERT_FALSE(sources.empty());
+
+    set<RubyVM *> vms;
+    for (auto &source : sources)
+    {
+      auto pipeline = source->getPipeline();
+      ASSERT_NE(nullptr, pipeline);
+
+      auto xforms = pipeline->find("FixExecution");
+      ASSERT_EQ(1, xforms.size());
+
+      // Each transform belongs to a different VM
+      auto trans = dynamic_pointer_cast<RubyTransform>(xforms.front());
+      ASSERT_TRUE(trans);
+      auto vm = trans->getVM();
+      ASSERT_TRUE(vm);
+      vms.insert(vm.get());
+    }
+
+    ASSERT_EQ(sources.size(), vms.size());
+  }
+
+  TEST_F(EmbeddedRubyTest, should_not_load_the_module_again_in_a_shared_vm_on_reload)
+  {
+    auto config = new ReloadConfiguration();
+    m_config.reset(config);
+    m_config->setDebug(true);
+
+    string adapters(
+        "Adapters {\n"
+        "  a {\n    Device = LinuxCNC\n    Port = 7878\n  }\n"
+        "  b {\n    Device = LinuxCNC\n    Port = 7900\n  }\n"
+        "}\n");
+    string str("Devices = " PROJECT_ROOT_DIR
+               "/samples/test_config.xml\n"
+               "Ruby {\n"
+               "  module = " PROJECT_ROOT_DIR
+               "/test/resources/ruby/should_transform_each_source.rb\n"
+               "}\n");
+    m_config->loadConfig(str + adapters);
+
+    auto agent = m_config->getAgent();
+    ASSERT_EQ(2, agent->getSources().size());
+    set<source::Source *> before;
+    for (auto &source : agent->getSources())
+      before.insert(source.get());
+
+    boost::replace_first(adapters, "7878", "7879");
+    config->reloadAdapters(configuration::Parser::parse(str + adapters));
+
+    // The module is not run again, so the rebuilt adapter has no transform and the other
+    // adapter does not get a second one
+    auto sources = agent->getSources();
+    ASSERT_EQ(2, sources.size());
+    for (auto &source : sources)
+    {
+      auto pipeline = source->getPipeline();
+      ASSERT_NE(nullptr, pipeline);
+      if (before.count(source.get()) > 0)
+        ASSERT_EQ(1, pipeline->find("FixExecution").size());
+      else
+        ASSERT_EQ(0, pipeline->find("FixExecution").size());
+    }
+  }
+
+  TEST_F(EmbeddedRubyTest, should_create_a_vm_for_adapters_added_on_reload)
+  {
+    auto config = new ReloadConfiguration();
+    m_config.reset(config);
+    m_config->setDebug(true);
+
+    string adapters(
+        "Adapters {\n"
+        "  a {\n    Device = LinuxCNC\n    Port = 7878\n  }\n"
+        "  b {\n    Device = LinuxCNC\n    Port = 7900\n  }\n"
+        "}\n");
+    string str("Devices = " PROJECT_ROOT_DIR
+               "/samples/test_config.xml\n"
+               "Ruby {\n"
+               "  module = " PROJECT_ROOT_DIR
+               "/test/resources/ruby/should_transform_each_pipeline.rb\n"
+               "  PerPipeline = true\n"
+               "}\n");
+    m_config->loadConfig(str + adapters);
+
+    auto agent = m_config->getAgent();
+    ASSERT_EQ(2, agent->getSources().size());
+
+    boost::replace_first(adapters, "7878", "7879");
+    config->reloadAdapters(configuration::Parser::parse(str + adapters));
+
+    auto sources = agent->getSources();
+    ASSERT_EQ(2, sources.size());
+
+    set<RubyVM *> vms;
+    for (auto &source : sources)
+    {
+      auto pipeline = source->getPipeline();
+      ASSERT_NE(nullptr, pipeline);
+
+      auto xforms = pipeline->find("FixExecution");
+      ASSERT_EQ(1, xforms.size());
+
+      auto trans = dynamic_pointer_cast<RubyTransform>(xforms.front());
+      ASSERT_TRUE(trans);
+      auto vm = trans->getVM();
+      ASSERT_TRUE(vm);
+      vms.insert(vm.get());
+    }
+
+    ASSERT_EQ(2, vms.size());
+  }
+
   TEST_F(EmbeddedRubyTest, should_create_sample)
   {
     using namespace std::chrono;
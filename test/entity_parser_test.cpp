@@ -20,12 +20,19 @@
 // Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
 
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <functional>
 #include <memory>
+#include <random>
 #include <sstream>
 #include <string>
 
+#include <libxml/parser.h>
+#include <libxml/xmlmemory.h>
+
 #include "json_helper.hpp"
 #include "mtconnect/agent.hpp"
 #include "mtconnect/entity/entity.hpp"
@@ -44,6 +51,78 @@ int main(int argc, char *argv[])
   return RUN_ALL_TESTS();
 }
 
+namespace {
+  /// @brief Tracks the bytes libxml2 has allocated to find the peak while parsing
+  struct XmlMemoryCounter
+  {
+    static constexpr size_t Header = 16;
+    static inline size_t s_current {0};
+    static inline size_t s_peak {0};
+
+    static void *allocate(size_t size)
+    {
+      auto block = static_cast<char *>(malloc(size + Header));
+      if (block == nullptr)
+        return nullptr;
+      *reinterpret_cast<size_t *>(block) = size;
+      grow(size);
+      return block + Header;
+    }
+    static void release(void *mem)
+    {
+      if (mem == nullptr)
+        return;
+      auto block = static_cast<char *>(mem) - Header;
+      s_current -= *reinterpret_cast<size_t *>(block);
+      free(block);
+    }
+    static void *reallocate(void *mem, size_t size)
+    {
+      if (mem == nullptr)
+        return allocate(size);
+      auto block = static_cast<char *>(mem) - Header;
+      auto previous = *reinterpret_cast<size_t *>(block);
+      block = static_cast<char *>(realloc(block, size + Header));
+      if (block == nullptr)
+        return nullptr;
+      *reinterpret_cast<size_t *>(block) = size;
+      s_current -= previous;
+      grow(size);
+      return block + Header;
+    }
+    static char *duplicate(const char *str)
+    {
+      auto size = strlen(str) + 1;
+      auto copy = static_cast<char *>(allocate(size));
+      if (copy != nullptr)
+        memcpy(copy, str, size);
+      return copy;
+    }
+    static void grow(size_t size)
+    {
+      s_current += size;
+      s_peak = max(s_peak, s_current);
+    }
+
+    /// @brief get the peak number of bytes libxml2 allocated while running `f`
+    template <typename F>
+    static size_t peak(F f)
+    {
+      xmlFreeFunc freeFunc;
+      xmlMallocFunc mallocFunc;
+      xmlReallocFunc reallocFunc;
+      xmlStrdupFunc strdupFunc;
+      xmlMemGet(&freeFunc, &mallocFunc, &reallocFunc, &strdupFunc);
+
+      s_current = s_peak = 0;
+      xmlMemSetup(release, allocate, reallocate, duplicate);
+      f();
+      xmlMemSetup(freeFunc, mallocFunc, reallocFunc, strdupFunc);
+      return s_peak;
+    }
+  };
+}  // namespace
+
 class EntityParserTest : public testing::Test
 {
 protected:
@@ -292,6 +371,175 @@ TEST_F(EntityParserTest, TestRawContent)
   ASSERT_EQ(expected, get<string>(entity->getProperty("RAW")));
 }
 
+TEST_F(EntityParserTest, should_stream_nested_raw_content_as_libxml2_writes_it)
+{
+  auto definition =
+      make_shared<Factory>(Requirements({Requirement("format", false), Requirement("RAW", true)}));
+  auto wrapper = make_shared<Factory>(
+      Requirements({Requirement("id", true), Requirement("Definition", ENTITY, definition, true)}));
+
+  auto root = make_shared<Factory>(Requirements({Requirement("Wrapper", ENTITY, wrapper, true)}));
+
+  auto doc = R"DOC(
+<Wrapper id="w1" xmlns:q="urn:q">
+  <Definition format="XML">
+    <q:Header version="1">
+      <Name>Part &amp; Fixture</Name>
+      <!-- a comment -->
+    </q:Header>
+    <Rows>
+      <Row n="1"><Cell>a</Cell>  <Cell/></Row>
+      <Row n="2"><![CDATA[x < y]]><![CDATA[ & z]]></Row>
+      <Row n="3">  </Row>
+    </Rows>
+    Some text
+  </Definition>
+</Wrapper>
+)DOC";
+
+  ErrorList errors;
+  entity::XmlParser parser;
+
+  auto entity = parser.parse(root, doc, errors);
+  ASSERT_EQ(0, errors.size());
+  ASSERT_EQ("w1", get<string>(entity->getProperty("id")));
+
+  auto def = entity->get<EntityPtr>("Definition");
+  ASSERT_TRUE(def);
+
+  auto expected =
+      "<q:Header version=\"1\"><Name>Part &amp; Fixture</Name><!-- a comment --></q:Header>"
+      "<Rows><Row n=\"1\"><Cell>a</Cell><Cell/></Row><Row n=\"2\"><![CDATA[x < y & z]]></Row>"
+      "<Row n=\"3\">  </Row></Rows>\n    Some text\n  ";
+
+  ASSERT_EQ("XML", get<string>(def->getProperty("format")));
+  ASSERT_EQ(expected, get<string>(def->getProperty("RAW")));
+}
+
+TEST_F(EntityParserTest, should_stream_random_raw_content_the_same_as_the_document_tree)
+{
+  auto definition =
+      make_shared<Factory>(Requirements({Requirement("format", false), Requirement("RAW", false)}));
+  auto root =
+      make_shared<Factory>(Requirements({Requirement("Definition", ENTITY, definition, true)}));
+
+  // Text with markup, entity and character references, whitespace and multibyte characters
+  const vector<string> texts {"abc",     " ",        "\n  ",   "&amp;",   "&lt;b&gt;", "&#13;",
+                              "\t",      "a &gt; b", "&quot;'", "&#233;",  "\xC3\xA9",   "]]&gt;",
+                              "  x  \n", "&#x1F600;"};
+  const vector<string> names {"A", "b", "q:C", "Row", "r:D"};
+
+  mt19937 rng(5050);
+  auto text = [&]() {
+    string s;
+    for (auto n = rng() % 3 + 1; n > 0; n--)
+      s += texts[rng() % texts.size()];
+    return s;
+  };
+
+  function<string(int)> content = [&](int depth) {
+    string s;
+    for (auto n = rng() % 5; n > 0; n--)
+    {
+      switch (rng() % 8)
+      {
+        case 0:
+        case 1:
+        {
+          auto name = names[rng() % names.size()];
+          s += "<" + name;
+          if (name[0] == 'r')
+            s += " xmlns:r=\"urn:r\"";
+          if (rng() % 2)
+            s += " a=\"" + text() + "\"";
+          if (depth > 3 || rng() % 4 == 0)
+            s += "/>";
+          else
+            s += ">" + content(depth + 1) + "</" + name + ">";
+          break;
+        }
+
+        case 2:
+          s += "<![CDATA[" + string(rng() % 2 ? "x < y & z" : "") + "]]>";
+          break;
+
+        case 3:
+          s += "<!-- note " + to_string(rng() % 10) + " -->";
+          break;
+
+        case 4:
+          s += "<?pi data?>";
+          break;
+
+        default:
+          s += text();
+          break;
+      }
+    }
+    return s;
+  };
+
+  for (int i = 0; i < 2000; i++)
+  {
+    auto doc = "<Definition format=\"XML\" xmlns:q=\"urn:q\">" + content(0) + "</Definition>";
+
+    ErrorList errors;
+    auto streamed = entity::XmlParser::parse(root, doc, errors);
+    ASSERT_EQ(0, errors.size()) << doc;
+    ASSERT_TRUE(streamed) << doc;
+
+    unique_ptr<xmlDoc, function<void(xmlDocPtr)>> tree(
+        xmlReadMemory(doc.c_str(), int(doc.size()), "document.xml", nullptr, XML_PARSE_NOBLANKS),
+        [](xmlDocPtr d) { xmlFreeDoc(d); });
+    ASSERT_TRUE(tree) << doc;
+    auto expected = entity::XmlParser::parseXmlNode(root, xmlDocGetRootElement(tree.get()), errors);
+    ASSERT_EQ(0, errors.size()) << doc;
+    ASSERT_TRUE(expected) << doc;
+
+    auto raw = [](EntityPtr entity) {
+      auto value = entity->getProperty("RAW");
+      return holds_alternative<string>(value) ? get<string>(value) : "<none>"s;
+    };
+    ASSERT_EQ(raw(expected), raw(streamed)) << doc;
+  }
+}
+
+TEST_F(EntityParserTest, should_not_keep_the_document_tree_of_large_raw_content)
+{
+  auto definition =
+      make_shared<Factory>(Requirements({Requirement("format", false), Requirement("RAW", true)}));
+  auto root =
+      make_shared<Factory>(Requirements({Requirement("Definition", ENTITY, definition, true)}));
+
+  string doc("<Definition format=\"XML\"><Rows>");
+  for (int i = 0; i < 20000; i++)
+    doc += "<Row n=\"" + to_string(i) + "\"><Cell>a &amp; b</Cell> <Cell/></Row>";
+  doc += "</Rows></Definition>";
+
+  // Allocations made the first time the parser is used are not counted
+  ErrorList errors;
+  xmlInitParser();
+  ASSERT_TRUE(entity::XmlParser::parse(root, "<Definition>x</Definition>", errors));
+  xmlResetLastError();
+
+  EntityPtr entity;
+  auto streamed =
+      XmlMemoryCounter::peak([&]() { entity = entity::XmlParser::parse(root, doc, errors); });
+  ASSERT_EQ(0, errors.size());
+  ASSERT_TRUE(entity);
+
+  auto tree = XmlMemoryCounter::peak([&]() {
+    auto d = xmlReadMemory(doc.c_str(), int(doc.size()), "document.xml", nullptr,
+                           XML_PARSE_NOBLANKS);
+    ASSERT_TRUE(d);
+    xmlFreeDoc(d);
+  });
+
+  // The raw content is kept as a string, libxml2 only needs the input and a few nodes
+  EXPECT_LT(streamed, doc.size() * 2) << "tree: " << tree;
+  EXPECT_LT(streamed * 4, tree) << "streamed: " << streamed;
+}
+
 TEST_F(EntityParserTest, check_proper_line_truncation)
 {
   auto description = make_shared<Factory>(
@@ -280,6 +280,35 @@ TEST_F(EntityPrinterTest, TestRawContent)
   ASSERT_EQ(expected, m_writer->getContent());
 }
 
+TEST_F(EntityPrinterTest, should_escape_attributes_and_text_like_libxml2)
+{
+  using namespace printer;
+
+  openElement(*m_writer, "Root");
+  m_writer->writeAttribute("a", "x<y & \"z\"\n");
+  {
+    AutoElement e(*m_writer, "Text");
+    m_writer->writeString("1 < 2 & \"3\"");
+  }
+  {
+    AutoElement e(*m_writer, "Entities");
+    m_writer->writeEntities("\xCE\xA9 > \xCE\xB1");
+  }
+  {
+    AutoElement e(*m_writer, "Empty");
+  }
+
+  auto expected = R"DOC(<Root a="x&lt;y &amp; &quot;z&quot;&#10;">
+  <Text>1 &lt; 2 &amp; &quot;3&quot;</Text>
+  <Entities>&#x3A9; &gt; &#x3B1;</Entities>
+  <Empty/>
+</Root>
+)DOC";
+
+  ASSERT_EQ(expected, m_writer->getContent());
+  ASSERT_THROW(m_writer->writeAttribute("b", "c"), XmlError);
+}
+
 TEST_F(EntityPrinterTest, should_honor_include_hidden_parameter)
 {
   auto component = make_shared<Factory>(Requirements {
@@ -21,10 +21,12 @@
 
 #include <cstdio>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "mtconnect/entity/entity.hpp"
 #include "mtconnect/entity/factory.hpp"
@@ -464,6 +466,59 @@ TEST_F(EntityTest, TestRequirementVectorConversions)
   EXPECT_THROW(r6.convertType(v), PropertyError);
 }
 
+TEST_F(EntityTest, should_parse_long_time_series_vectors)
+{
+  string series;
+  for (int i = 0; i < 1000; i++)
+  {
+    if (i > 0)
+      series.append(i % 7 == 0 ? "\t  " : " ");
+    series.append(to_string(i * 0.25));
+  }
+
+  Value v(series);
+  Requirement r1("vector", VECTOR);
+  ASSERT_TRUE(r1.convertType(v));
+  auto &vec = get<Vector>(v);
+  ASSERT_EQ(1000, vec.size());
+  for (int i = 0; i < 1000; i++)
+    ASSERT_EQ(i * 0.25, vec[i]);
+
+  v = "+1.5 -2e3 0x10"s;
+  ASSERT_TRUE(r1.convertType(v));
+  ASSERT_EQ(3, get<Vector>(v).size());
+  EXPECT_EQ(1.5, get<Vector>(v)[0]);
+  EXPECT_EQ(-2000.0, get<Vector>(v)[1]);
+  EXPECT_EQ(16.0, get<Vector>(v)[2]);
+
+  v = "1.5 2.5x"s;
+  EXPECT_THROW(r1.convertType(v), PropertyError);
+}
+
+TEST_F(EntityTest, should_format_doubles_the_same_as_a_stream)
+{
+  auto streamed = [](double d) {
+    stringstream s;
+    s << setprecision(numeric_limits<double>::digits10) << d;
+    return s.str();
+  };
+
+  vector<double> values {0.0,    -0.0,   1.0,    0.1,        -2.5,
+                         1e15,   1e16,   1e-5,   0.0001,     1.0 / 3.0,
+                         1e-300, 1e300,  5e-324, 123.456789, 1234567890123456789.0,
+                         -99.999, 100.000001, numeric_limits<double>::max()};
+  for (int i = 0; i < 10000; i++)
+    values.push_back((i - 5000) * 0.0123 + i * 1e-9);
+
+  for (auto d : values)
+  {
+    ASSERT_EQ(streamed(d), format(d));
+    stringstream s;
+    s << formatted(d);
+    ASSERT_EQ(streamed(d), s.str());
+  }
+}
+
 TEST_F(EntityTest, TestRequirementUpperCaseStringConversion)
 {
   Value v("hello kitty"s);
@@ -501,6 +556,58 @@ TEST_F(EntityTest, TestControlledVocabulary)
             string(errors.front()->what()));
 }
 
+TEST_F(EntityTest, should_match_vocabularies_and_patterns_without_regex)
+{
+  Vocabulary vocab({"UP", "DOWN", "LEFT", "RIGHT", "UP"});
+  ASSERT_EQ(4, vocab.size());
+  ASSERT_TRUE(vocab.contains("UP"));
+  ASSERT_TRUE(vocab.contains("RIGHT"));
+  ASSERT_FALSE(vocab.contains("up"));
+  ASSERT_FALSE(vocab.contains(""));
+  ASSERT_FALSE(Vocabulary().contains("UP"));
+
+  PatternMatcher any(".+");
+  ASSERT_FALSE(any.usesRegex());
+  ASSERT_TRUE(any.matches("Measurement"));
+  ASSERT_FALSE(any.matches(""));
+
+  PatternMatcher prefix("x:.*");
+  ASSERT_FALSE(prefix.usesRegex());
+  ASSERT_TRUE(prefix.matches("x:"));
+  ASSERT_TRUE(prefix.matches("x:auto"));
+  ASSERT_FALSE(prefix.matches("y:auto"));
+
+  PatternMatcher suffix(".+TimeSeries");
+  ASSERT_FALSE(suffix.usesRegex());
+  ASSERT_TRUE(suffix.matches("PositionTimeSeries"));
+  ASSERT_FALSE(suffix.matches("TimeSeries"));
+
+  PatternMatcher alternatives("BIG|SMALL");
+  ASSERT_FALSE(alternatives.usesRegex());
+  ASSERT_TRUE(alternatives.matches("SMALL"));
+  ASSERT_FALSE(alternatives.matches("BIG|SMALL"));
+
+  PatternMatcher regex("[0-9]+");
+  ASSERT_TRUE(regex.usesRegex());
+  ASSERT_TRUE(regex.matches("123"));
+  ASSERT_FALSE(regex.matches("12a"));
+
+  FactoryPtr root = make_shared<Factory>();
+  FactoryPtr simpleFact = make_shared<Factory>(
+      Requirements({{"id", true}, {"code", PatternMatcher("E[0-9]+|W[0-9]+"), false}}));
+  root->registerFactory(PatternMatcher(".+"), simpleFact);
+
+  ErrorList errors;
+  auto entity = root->create("simple", {{"id", "abc"s}, {"code", "E12"s}}, errors);
+  ASSERT_EQ(0, errors.size());
+  ASSERT_TRUE(entity);
+
+  entity = root->create("other", {{"id", "abc"s}, {"code", "X12"s}}, errors);
+  ASSERT_EQ(1, errors.size());
+  ASSERT_EQ("other(code): Invalid value for 'code': 'X12' is not allowed",
+            string(errors.front()->what()));
+}
+
 TEST_F(EntityTest, entity_list_requirements_need_with_at_least_one_requiremenet)
 {
   auto ref1 = make_shared<Factory>(Requirements {{"id", true}, {"name", false}, {"type", true}});
@@ -176,6 +176,13 @@ public:
           fail(ev, "Failed in chunked body");
 
         string b(body.cbegin(), body.cend());
+        if (m_contentType == "text/event-stream")
+        {
+          m_result = b;
+          m_done = true;
+          return body.size();
+        }
+
         auto le = b.find("\r\n");
         if (le == string::npos)
           return 0;
@@ -219,6 +226,48 @@ public:
     m_done = true;
   }
 
+  void pipelineRequests(const std::list<std::string>& targets, asio::yield_context yield)
+  {
+    beast::error_code ec;
+
+    m_done = false;
+    m_results.clear();
+
+    // Send all the requests before reading any of the responses
+    for (const auto& target : targets)
+    {
+      http::request<http::empty_body> req {http::verb::get, target, 11};
+      req.set(http::field::host, "localhost");
+      req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+
+      m_stream.expires_after(std::chrono::seconds(30));
+      http::async_write(m_stream, req, yield[ec]);
+      if (ec)
+        return fail(ec, "write");
+    }
+
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+      http::response<http::string_body> res;
+      http::async_read(m_stream, m_b, res, yield[ec]);
+      if (ec)
+        return fail(ec, "async_read");
+      m_results.emplace_back(res.body());
+    }
+
+    m_done = true;
+  }
+
+  void spawnPipelineRequests(const std::list<std::string>& targets)
+  {
+    m_done = false;
+    asio::spawn(m_context,
+                std::bind(&Client::pipelineRequests, this, targets, std::placeholders::_1));
+
+    while (!m_done && m_context.run_for(20ms) > 0)
+      ;
+  }
+
   void readChunk(asio::yield_context yield)
   {
     boost::system::error_code ec;
@@ -259,6 +308,7 @@ public:
   bool m_connected {false};
   int m_status;
   std::string m_result;
+  std::list<std::string> m_results;
   asio::io_context& m_context;
   bool m_done {false};
   beast::tcp_stream m_stream;
@@ -516,6 +566,69 @@ TEST_F(RestServiceTest, request_with_connect_close)
   EXPECT_FALSE(savedSession.lock());
 }
 
+TEST_F(RestServiceTest, should_keep_connection_alive_for_http_1_0_when_requested)
+{
+  weak_ptr<Session> savedSession;
+
+  auto handler = [&](SessionPtr session, RequestPtr request) -> bool {
+    savedSession = session;
+    session->writeResponse(make_unique<Response>(status::ok, "Probe"));
+    return true;
+  };
+
+  m_server->addRouting(Routing {boost::beast::http::verb::get, "/probe", handler});
+
+  start();
+  startClient();
+
+  bool done = false;
+  asio::spawn(m_context, [&](asio::yield_context yield) {
+    beast::error_code ec;
+    for (int i = 0; i < 2; i++)
+    {
+      http::request<http::empty_body> req {http::verb::get, "/probe", 10};
+      req.set(http::field::host, "localhost");
+      req.keep_alive(true);
+      http::async_write(m_client->m_stream, req, yield[ec]);
+      ASSERT_FALSE(ec);
+
+      http::response<http::string_body> res;
+      http::async_read(m_client->m_stream, m_client->m_b, res, yield[ec]);
+      ASSERT_FALSE(ec);
+      EXPECT_EQ(10, res.version());
+      EXPECT_TRUE(res.keep_alive());
+      EXPECT_EQ("Probe", res.body());
+    }
+    done = true;
+  });
+
+  while (!done && m_context.run_for(20ms) > 0)
+    ;
+  ASSERT_TRUE(done);
+  EXPECT_TRUE(savedSession.lock());
+}
+
+TEST_F(RestServiceTest, should_respond_to_pipelined_requests_in_order)
+{
+  auto handler = [&](SessionPtr session, RequestPtr request) -> bool {
+    ResponsePtr resp = make_unique<Response>(status::ok);
+    resp->m_body = "Sample " + get<string>(request->m_parameters["device"]);
+    session->writeResponse(std::move(resp));
+    return true;
+  };
+
+  m_server->addRouting({boost::beast::http::verb::get, "/{device}/sample", handler});
+
+  start();
+  startClient();
+
+  m_client->spawnPipelineRequests({"/d1/sample", "/d2/sample", "/d3/sample", "/d4/sample"});
+  ASSERT_TRUE(m_client->m_done);
+
+  list<string> expected {"Sample d1", "Sample d2", "Sample d3", "Sample d4"};
+  EXPECT_EQ(expected, m_client->m_results);
+}
+
 TEST_F(RestServiceTest, put_content_to_server)
 {
   string body;
@@ -565,6 +678,60 @@ TEST_F(RestServiceTest, put_content_with_put_values)
   ASSERT_EQ("application/x-www-form-urlencoded", ct);
 }
 
+TEST_F(RestServiceTest, should_limit_the_request_body_by_routing)
+{
+  size_t received = 0;
+  auto handler = [&](SessionPtr session, RequestPtr request) -> bool {
+    received = request->m_body.size();
+    ResponsePtr resp = make_unique<Response>(status::ok, "Put ok");
+    session->writeResponse(std::move(resp));
+    return true;
+  };
+
+  m_server->addRouting({boost::beast::http::verb::put, "/asset", handler}).bodyLimit(200000);
+  m_server->addRouting({boost::beast::http::verb::put, "/small", handler}).bodyLimit(100);
+  m_server->allowPuts();
+
+  start();
+  startClient();
+
+  m_client->spawnRequest(http::verb::put, "/asset", string(150000, 'x'));
+  ASSERT_TRUE(m_client->m_done);
+  EXPECT_EQ(int(http::status::ok), m_client->m_status);
+  EXPECT_EQ(150000, received);
+
+  received = 0;
+  m_client->spawnRequest(http::verb::put, "/small", string(1000, 'x'));
+  ASSERT_TRUE(m_client->m_done);
+  EXPECT_EQ(int(http::status::payload_too_large), m_client->m_status);
+  EXPECT_EQ("Request body is too large", m_client->m_result);
+  EXPECT_EQ(0, received);
+}
+
+TEST_F(RestServiceTest, should_accept_a_body_larger_than_the_default_limit_for_the_routing)
+{
+  string body;
+  auto handler = [&](SessionPtr session, RequestPtr request) -> bool {
+    body = request->m_body;
+    ResponsePtr resp = make_unique<Response>(status::ok, "Put ok");
+    session->writeResponse(std::move(resp));
+    return true;
+  };
+
+  m_server->addRouting({boost::beast::http::verb::put, "/asset", handler}).bodyLimit(1024 * 1024);
+  m_server->allowPuts();
+
+  start();
+  startClient();
+
+  // Sent with a Content-Length, above the default limit and below the limit of the routing
+  auto large = string(DEFAULT_BODY_LIMIT * 5, 'x');
+  m_client->spawnRequest(http::verb::put, "/asset", large);
+  ASSERT_TRUE(m_client->m_done);
+  EXPECT_EQ(int(http::status::ok), m_client->m_status);
+  EXPECT_EQ(large, body);
+}
+
 TEST_F(RestServiceTest, streaming_response)
 {
   struct context
@@ -648,6 +815,51 @@ TEST_F(RestServiceTest, streaming_response)
     ;
 }
 
+TEST_F(RestServiceTest, should_stream_server_sent_events)
+{
+  struct context
+  {
+    context(RequestPtr r, SessionPtr s) : m_request(r), m_session(s) {}
+    RequestPtr m_request;
+    SessionPtr m_session;
+    bool m_written {false};
+  };
+
+  shared_ptr<context> ctx;
+  auto begin = [&](SessionPtr session, RequestPtr request) -> bool {
+    ctx = make_shared<context>(request, session);
+    session->beginStreaming(
+        "text/xml", [ctx]() { ctx->m_written = true; }, StreamFormat::EVENT_STREAM);
+    return true;
+  };
+
+  m_server->addRouting({boost::beast::http::verb::get, "/sample", begin});
+
+  start();
+  startClient();
+
+  m_client->spawnRequest(http::verb::get, "/sample");
+  while (!ctx->m_written && m_context.run_for(20ms) > 0)
+    ;
+  EXPECT_EQ("text/event-stream", m_client->m_contentType);
+  m_client->spawnReadChunk();
+  while (m_context.run_for(20ms) > 0)
+    ;
+
+  m_client->m_done = false;
+  ctx->m_written = false;
+  ctx->m_session->writeChunk(
+      "<Streams>\r\n  <Line>1</Line>\n</Streams>", [ctx]() { ctx->m_written = true; }, 1234);
+  while ((!ctx->m_written || !m_client->m_done) && m_context.run_for(20ms) > 0)
+    ;
+  EXPECT_EQ("id: 1234\ndata: <Streams>\ndata:   <Line>1</Line>\ndata: </Streams>\n\n",
+            m_client->m_result);
+
+  ctx->m_session->closeStream();
+  while (m_context.run_for(20ms) > 0)
+    ;
+}
+
 TEST_F(RestServiceTest, additional_header_fields)
 {
   m_server->setHttpHeaders({"Access-Control-Allow-Origin:*", "Origin:https://foo.example"});
@@ -18,6 +18,7 @@
 #include <gtest/gtest.h>
 // Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
 
+#include <map>
 #include <string>
 
 #include <nlohmann/json.hpp>
@@ -516,3 +517,235 @@ TEST_F(MqttIsolatedUnitTest, mqtt_tcp_client_authentication)
   client->async_connect([](mqtt::error_code ec) { ASSERT_FALSE(ec) << "CAnnot connect"; });
   ASSERT_TRUE(waitFor(5s, [&received]() { return received; }));
 }
+
+TEST_F(MqttIsolatedUnitTest, topic_trie_should_match_wildcard_subscriptions)
+{
+  using Trie = mtconnect::mqtt_server::TopicTrie<int, int>;
+  Trie trie;
+  trie.subscribe("MTConnect/Observation/000/Line", 1, 0);
+  trie.subscribe("MTConnect/+/000/Line", 2, 1);
+  trie.subscribe("MTConnect/#", 3, 0);
+  trie.subscribe("#", 4, 1);
+  trie.subscribe("MTConnect/Observation/000/Line", 2, 0);
+
+  Trie::Matches matches;
+  trie.match("MTConnect/Observation/000/Line", matches);
+  ASSERT_EQ(4, matches.size());
+  EXPECT_EQ(1, matches[2]);
+
+  matches.clear();
+  trie.match("MTConnect", matches);
+  ASSERT_EQ(2, matches.size());
+  EXPECT_EQ(1, matches.count(3));
+  EXPECT_EQ(1, matches.count(4));
+
+  matches.clear();
+  trie.match("$SYS/clients", matches);
+  EXPECT_TRUE(matches.empty());
+
+  trie.unsubscribeAll(2);
+  matches.clear();
+  trie.match("MTConnect/Observation/000/Line", matches);
+  EXPECT_EQ(3, matches.size());
+
+  trie.unsubscribe("MTConnect/Observation/000/Line", 1);
+  matches.clear();
+  trie.match("MTConnect/Observation/000/Line", matches);
+  EXPECT_EQ(2, matches.size());
+  EXPECT_EQ(2, trie.subscriberCount());
+
+  EXPECT_TRUE(Trie::matches("a/+/c", "a/b/c"));
+  EXPECT_TRUE(Trie::matches("a/#", "a"));
+  EXPECT_FALSE(Trie::matches("a/+", "a/b/c"));
+  EXPECT_FALSE(Trie::matches("#", "$SYS/x"));
+}
+
+TEST_F(MqttIsolatedUnitTest, server_should_send_retained_messages_on_subscribe)
+{
+  ConfigOptions options {{ServerIp, "127.0.0.1"s},
+                         {MqttPort, 0},
+                         {MqttTls, false},
+                         {AutoAvailable, false},
+                         {RealTime, false}};
+
+  createServer(options);
+  startServer();
+  ASSERT_NE(0, m_port);
+
+  auto handler = make_unique<ClientHandler>();
+  vector<pair<string, string>> received;
+  handler->m_receive = [&received](std::shared_ptr<MqttClient>, const std::string &topic,
+                                   const std::string &payload) {
+    received.emplace_back(topic, payload);
+  };
+  createClient(options, std::move(handler));
+  ASSERT_TRUE(startClient());
+
+  // The client publishes with retain
+  m_client->publish("cell/machine1/state", "ACTIVE");
+  m_client->publish("cell/machine2/state", "READY");
+  m_client->publish("cell/machine1/state", "STOPPED");
+  m_agentTestHelper->m_ioContext.run_for(200ms);
+
+  m_client->subscribe("cell/+/state");
+  ASSERT_TRUE(waitFor(5s, [&received]() { return received.size() >= 2; }));
+  m_agentTestHelper->m_ioContext.run_for(200ms);
+
+  ASSERT_EQ(2, received.size());
+  sort(received.begin(), received.end());
+  EXPECT_EQ("cell/machine1/state", received[0].first);
+  EXPECT_EQ("STOPPED", received[0].second);
+  EXPECT_EQ("cell/machine2/state", received[1].first);
+  EXPECT_EQ("READY", received[1].second);
+}
+
+TEST_F(MqttIsolatedUnitTest, server_should_deliver_every_message_to_every_subscriber)
+{
+  ConfigOptions options {{ServerIp, "127.0.0.1"s},   {MqttPort, 0},         {MqttTls, false},
+                         {AutoAvailable, false},     {RealTime, false},     {MqttMaxInFlight, 32}};
+
+  createServer(options);
+  startServer();
+  ASSERT_NE(0, m_port);
+
+  // More messages than the in-flight window so deliveries are queued until acknowledged
+  const int publishers = 4, subscribers = 8, messages = 100;
+  const size_t expected = size_t(publishers) * messages * subscribers;
+
+  auto &ioc = m_agentTestHelper->m_ioContext.get();
+  using client_t = decltype(mqtt::make_async_client(ioc, "localhost", m_port));
+  vector<client_t> subs, pubs;
+  int subscribed = 0, connected = 0;
+  size_t received = 0;
+  map<string, int> counts;
+
+  for (int i = 0; i < subscribers; i++)
+  {
+    auto client = mqtt::make_async_client(ioc, "localhost", m_port);
+    client->set_client_id("sub" + to_string(i));
+    client->set_clean_session(true);
+    std::weak_ptr<typename client_t::element_type> wp = client;
+    client->set_connack_handler([wp](bool, mqtt::connect_return_code rc) {
+      if (auto c = wp.lock(); c && rc == mqtt::connect_return_code::accepted)
+        c->async_subscribe(c->acquire_unique_packet_id(), "load/#", MQTT_NS::qos::at_least_once,
+                           [](MQTT_NS::error_code ec) { EXPECT_FALSE(ec); });
+      return true;
+    });
+    client->set_suback_handler([&subscribed](std::uint16_t, std::vector<mqtt::suback_return_code>) {
+      subscribed++;
+      return true;
+    });
+    client->set_publish_handler([&received, &counts](mqtt::optional<std::uint16_t>,
+                                                     mqtt::publish_options, mqtt::buffer,
+                                                     mqtt::buffer contents) {
+      counts[string(contents)]++;
+      received++;
+      return true;
+    });
+    client->async_connect([](mqtt::error_code ec) { ASSERT_FALSE(ec); });
+    subs.emplace_back(client);
+  }
+  ASSERT_TRUE(waitFor(5s, [&subscribed]() { return subscribed == subscribers; }));
+
+  for (int i = 0; i < publishers; i++)
+  {
+    auto client = mqtt::make_async_client(ioc, "localhost", m_port);
+    client->set_client_id("pub" + to_string(i));
+    client->set_clean_session(true);
+    client->set_connack_handler([&connected](bool, mqtt::connect_return_code rc) {
+      if (rc == mqtt::connect_return_code::accepted)
+        connected++;
+      return true;
+    });
+    client->async_connect([](mqtt::error_code ec) { ASSERT_FALSE(ec); });
+    pubs.emplace_back(client);
+  }
+  ASSERT_TRUE(waitFor(5s, [&connected]() { return connected == publishers; }));
+
+  for (int m = 0; m < messages; m++)
+  {
+    for (int p = 0; p < publishers; p++)
+    {
+      pubs[p]->async_publish("load/" + to_string(p) + "/" + to_string(m % 10),
+                             to_string(p) + ":" + to_string(m), MQTT_NS::qos::at_least_once,
+                             [](MQTT_NS::error_code ec) {});
+    }
+  }
+
+  EXPECT_TRUE(waitFor(30s, [&received, expected]() { return received >= expected; }));
+  m_agentTestHelper->m_ioContext.run_for(100ms);
+
+  // Each subscriber receives each message once
+  ASSERT_EQ(expected, received);
+  ASSERT_EQ(size_t(publishers * messages), counts.size());
+  for (const auto &count : counts)
+    ASSERT_EQ(subscribers, count.second) << count.first;
+
+  for (auto &c : pubs)
+    c->async_disconnect();
+  for (auto &c : subs)
+    c->async_disconnect();
+  m_agentTestHelper->m_ioContext.run_for(500ms);
+}
+
+TEST_F(MqttIsolatedUnitTest, server_should_disconnect_a_subscriber_that_stops_acknowledging)
+{
+  ConfigOptions options {{ServerIp, "127.0.0.1"s},   {MqttPort, 0},         {MqttTls, false},
+                         {AutoAvailable, false},     {RealTime, false},     {MqttMaxInFlight, 1}};
+
+  createServer(options);
+  startServer();
+  ASSERT_NE(0, m_port);
+
+  auto &ioc = m_agentTestHelper->m_ioContext.get();
+
+  // The subscriber never sends a PUBACK, so every message after the first is queued
+  auto sub = mqtt::make_async_client(ioc, "localhost", m_port);
+  sub->set_client_id("slow");
+  sub->set_clean_session(true);
+  sub->set_auto_pub_response(false);
+  bool subscribed = false, closed = false;
+  size_t received = 0;
+  std::weak_ptr<typename decltype(sub)::element_type> wp = sub;
+  sub->set_connack_handler([wp](bool, mqtt::connect_return_code rc) {
+    if (auto c = wp.lock(); c && rc == mqtt::connect_return_code::accepted)
+      c->async_subscribe(c->acquire_unique_packet_id(), "slow/#", MQTT_NS::qos::at_least_once,
+                         [](MQTT_NS::error_code ec) { EXPECT_FALSE(ec); });
+    return true;
+  });
+  sub->set_suback_handler([&subscribed](std::uint16_t, std::vector<mqtt::suback_return_code>) {
+    subscribed = true;
+    return true;
+  });
+  sub->set_publish_handler([&received](mqtt::optional<std::uint16_t>, mqtt::publish_options,
+                                       mqtt::buffer, mqtt::buffer) {
+    received++;
+    return true;
+  });
+  sub->set_close_handler([&closed]() { closed = true; });
+  sub->set_error_handler([&closed](MQTT_NS::error_code) { closed = true; });
+  sub->async_connect([](mqtt::error_code ec) { ASSERT_FALSE(ec); });
+  ASSERT_TRUE(waitFor(5s, [&subscribed]() { return subscribed; }));
+
+  bool connected = false;
+  auto pub = mqtt::make_async_client(ioc, "localhost", m_port);
+  pub->set_client_id("publisher");
+  pub->set_clean_session(true);
+  pub->set_connack_handler([&connected](bool, mqtt::connect_return_code rc) {
+    connected = rc == mqtt::connect_return_code::accepted;
+    return true;
+  });
+  pub->async_connect([](mqtt::error_code ec) { ASSERT_FALSE(ec); });
+  ASSERT_TRUE(waitFor(5s, [&connected]() { return connected; }));
+
+  // One message in flight and 10000 queued fill the subscriber's queue
+  for (int m = 0; m < 10002; m++)
+    pub->async_publish("slow/" + to_string(m % 10), to_string(m), MQTT_NS::qos::at_least_once,
+                       [](MQTT_NS::error_code ec) {});
+
+  ASSERT_TRUE(waitFor(30s, [&closed]() { return closed; }));
+  EXPECT_EQ(1, received);
+
+  pub->async_disconnect();
+  m_agentTestHelper->m_ioContext.run_for(500ms);
+}
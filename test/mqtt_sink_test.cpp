@@ -48,6 +48,13 @@ int main(int argc, char *argv[])
 
 using json = nlohmann::json;
 
+// The broker sends the retained observation from the connect snapshot on subscribe
+static bool isUnavailable(const json &doc)
+{
+  auto value = doc.find("value");
+  return value != doc.end() && value->is_string() && value->get<string>() == "UNAVAILABLE";
+}
+
 class MqttSinkTest : public testing::Test
 {
 protected:
@@ -286,6 +293,8 @@ TEST_F(MqttSinkTest, mqtt_sink_should_publish_Streams)
     EXPECT_EQ("MTConnect/Observation/000/Controller[Controller]/Path/Events/Line[line]", topic);
 
     auto jdoc = json::parse(payload);
+    if (isUnavailable(jdoc))
+      return;
     string value = jdoc.at("/value"_json_pointer).get<string>();
     EXPECT_EQ("204", value);
     foundLineDataItem = true;
@@ -319,6 +328,8 @@ TEST_F(MqttSinkTest, mqtt_sink_should_publish_Asset)
                                                 const std::string &payload) {
     EXPECT_EQ("MTConnect/Asset/0001", topic);
     auto jdoc = json::parse(payload);
+    if (isUnavailable(jdoc))
+      return;
     string id = jdoc.at("/Part/assetId"_json_pointer).get<string>();
     EXPECT_EQ("0001", id);
     gotControllerDataItem = true;
@@ -353,6 +364,8 @@ TEST_F(MqttSinkTest, mqtt_sink_should_publish_RotaryMode)
     EXPECT_EQ("MTConnect/Observation/000/Axes[Axes]/Rotary[C]/Samples/SpindleSpeed.Actual[Sspeed]",
               topic);
     auto jdoc = json::parse(payload);
+    if (isUnavailable(jdoc))
+      return;
 
     double v = jdoc.at("/value"_json_pointer).get<double>();
     EXPECT_EQ(5000.0, v);
@@ -390,6 +403,8 @@ TEST_F(MqttSinkTest, mqtt_sink_should_publish_Dataset)
         "MTConnect/Observation/000/Controller[Controller]/Path[path]/Events/VariableDataSet[vars]",
         topic);
     auto jdoc = json::parse(payload);
+    if (isUnavailable(jdoc))
+      return;
     auto id = jdoc.at("/value/a"_json_pointer).get<int>();
     EXPECT_EQ(1, id);
     gotControllerDataItem = true;
@@ -422,6 +437,8 @@ TEST_F(MqttSinkTest, mqtt_sink_should_publish_Table)
         "MTConnect/Observation/000/Controller[Controller]/Path[path]/Events/WorkOffsetTable[wpo]",
         topic);
     auto jdoc = json::parse(payload);
+    if (isUnavailable(jdoc))
+      return;
 
     auto jValue = jdoc.at("/value"_json_pointer);
     int count = 0;
@@ -493,6 +510,8 @@ TEST_F(MqttSinkTest, mqtt_sink_should_publish_Temperature)
         "Temperature[z_motor_temp]",
         topic);
     auto jdoc = json::parse(payload);
+    if (isUnavailable(jdoc))
+      return;
 
     auto value = jdoc.at("/value"_json_pointer).get<double>();
     EXPECT_EQ(81.0, value);
@@ -527,6 +546,8 @@ TEST_F(MqttSinkTest, mqtt_sink_should_publish_LinearLoad)
                                         const std::string &payload) {
     EXPECT_EQ("MTConnect/Observation/000/Axes[Axes]/Linear[X]/Samples/Load[Xload]", topic);
     auto jdoc = json::parse(payload);
+    if (isUnavailable(jdoc))
+      return;
     auto value = jdoc.at("/value"_json_pointer).get<double>();
     EXPECT_EQ(50.0, value);
     gotLinearLoad = true;
@@ -560,6 +581,8 @@ TEST_F(MqttSinkTest, mqtt_sink_should_publish_DynamicCalibration)
         "MTConnect/Observation/000/Axes[Axes]/Linear[X]/Samples/PositionTimeSeries.Actual[Xts]",
         topic);
     auto jdoc = json::parse(payload);
+    if (isUnavailable(jdoc))
+      return;
 
     auto value = jdoc.at("/value"_json_pointer);
     ASSERT_TRUE(value.is_array());
@@ -584,3 +607,149 @@ TEST_F(MqttSinkTest, mqtt_sink_should_publish_DynamicCalibration)
 
   ASSERT_TRUE(waitFor(5s, [&gotCalibration]() { return gotCalibration; }));
 }
+
+TEST_F(MqttSinkTest, mqtt_sink_should_coalesce_observations_in_flush_window)
+{
+  ConfigOptions options;
+  createServer(options);
+  startServer();
+  ASSERT_NE(0, m_port);
+
+  auto handler = make_unique<ClientHandler>();
+  vector<string> values;
+  handler->m_receive = [&values](std::shared_ptr<MqttClient>, const std::string &topic,
+                                 const std::string &payload) {
+    EXPECT_EQ("MTConnect/Observation/000/Controller[Controller]/Path/Events/Line[line]", topic);
+    auto jdoc = json::parse(payload);
+    if (isUnavailable(jdoc))
+      return;
+    values.emplace_back(jdoc.at("/value"_json_pointer).get<string>());
+  };
+  createClient(options, std::move(handler));
+  ASSERT_TRUE(startClient());
+
+  createAgent("", {{MqttFlushInterval, 200ms}, {MqttMaxInFlight, 2}});
+  auto service = m_agentTestHelper->getMqttService();
+  ASSERT_TRUE(waitFor(5s, [&service]() { return service->isConnected(); }));
+
+  m_client->subscribe("MTConnect/Observation/000/Controller[Controller]/Path/Events/Line[line]");
+  m_agentTestHelper->m_ioContext.run_for(100ms);
+
+  m_agentTestHelper->m_adapter->processData("2021-02-01T12:00:00Z|line|204");
+  m_agentTestHelper->m_adapter->processData("2021-02-01T12:00:01Z|line|205");
+  m_agentTestHelper->m_adapter->processData("2021-02-01T12:00:02Z|line|206");
+
+  ASSERT_TRUE(waitFor(5s, [&values]() { return !values.empty(); }));
+  m_agentTestHelper->m_ioContext.run_for(300ms);
+
+  ASSERT_EQ(1, values.size());
+  EXPECT_EQ("206", values.front());
+}
+
+TEST_F(MqttSinkTest, mqtt_sink_should_publish_device_batches)
+{
+  ConfigOptions options;
+  createServer(options);
+  startServer();
+  ASSERT_NE(0, m_port);
+
+  auto handler = make_unique<ClientHandler>();
+  json batch;
+  handler->m_receive = [&batch](std::shared_ptr<MqttClient>, const std::string &topic,
+                                const std::string &payload) {
+    EXPECT_EQ("MTConnect/Observation/000", topic);
+    batch = json::parse(payload);
+  };
+  createClient(options, std::move(handler));
+  ASSERT_TRUE(startClient());
+
+  createAgent("", {{MqttFlushInterval, 100ms}, {MqttDeviceBatch, true}});
+  auto service = m_agentTestHelper->getMqttService();
+  ASSERT_TRUE(waitFor(5s, [&service]() { return service->isConnected(); }));
+
+  m_client->subscribe("MTConnect/Observation/000");
+  m_agentTestHelper->m_ioContext.run_for(100ms);
+
+  m_agentTestHelper->m_adapter->processData("2021-02-01T12:00:00Z|line|204|Sspeed|5000");
+  m_agentTestHelper->m_adapter->processData("2021-02-01T12:00:01Z|line|205");
+
+  ASSERT_TRUE(waitFor(5s, [&batch]() { return !batch.is_null(); }));
+  ASSERT_TRUE(batch.is_array());
+  ASSERT_EQ(2, batch.size());
+  EXPECT_EQ("205", batch.at("/0/Line/value"_json_pointer).get<string>());
+  EXPECT_EQ(5000.0, batch.at("/1/SpindleSpeed/value"_json_pointer).get<double>());
+}
+
+TEST_F(MqttSinkTest, mqtt_sink_should_not_replay_older_values_after_live_observations)
+{
+  ConfigOptions options;
+  createServer(options);
+  startServer();
+  ASSERT_NE(0, m_port);
+
+  auto handler = make_unique<ClientHandler>();
+  vector<string> values;
+  handler->m_receive = [&values](std::shared_ptr<MqttClient>, const std::string &topic,
+                                 const std::string &payload) {
+    auto jdoc = json::parse(payload);
+    values.emplace_back(jdoc.at("/value"_json_pointer).get<string>());
+  };
+  createClient(options, std::move(handler));
+  ASSERT_TRUE(startClient());
+  m_client->subscribe("MTConnect/Observation/000/Controller[Controller]/Path/Events/Line[line]");
+
+  createAgent();
+  auto service = m_agentTestHelper->getMqttService();
+  ASSERT_TRUE(waitFor(5s, [&service]() { return service->isConnected(); }));
+
+  // Arrives while the connect snapshot is being published
+  m_agentTestHelper->m_adapter->processData("2021-02-01T12:00:00Z|line|204");
+
+  ASSERT_TRUE(waitFor(5s, [&values]() { return !values.empty() && values.back() == "204"; }));
+  m_agentTestHelper->m_ioContext.run_for(200ms);
+  EXPECT_EQ("204", values.back());
+}
+
+TEST_F(MqttSinkTest, mqtt_sink_should_publish_sample_and_current_documents)
+{
+  ConfigOptions options;
+  createServer(options);
+  startServer();
+  ASSERT_NE(0, m_port);
+
+  auto handler = make_unique<ClientHandler>();
+  json sample, current;
+  handler->m_receive = [&sample, &current](std::shared_ptr<MqttClient>, const std::string &topic,
+                                           const std::string &payload) {
+    if (topic == "MTConnect/Sample/000")
+      sample = json::parse(payload);
+    else if (topic == "MTConnect/Current/000")
+      current = json::parse(payload);
+    else
+      FAIL() << "Unexpected topic: " << topic;
+  };
+  createClient(options, std::move(handler));
+  ASSERT_TRUE(startClient());
+  m_client->subscribe("MTConnect/Sample/000");
+  m_client->subscribe("MTConnect/Current/000");
+
+  createAgent("", {{MqttSampleInterval, 100ms}, {MqttCurrentInterval, 100ms}});
+  auto service = m_agentTestHelper->getMqttService();
+  ASSERT_TRUE(waitFor(5s, [&service]() { return service->isConnected(); }));
+  m_agentTestHelper->m_ioContext.run_for(200ms);
+
+  m_agentTestHelper->m_adapter->processData("2021-02-01T12:00:00Z|line|204");
+
+  ASSERT_TRUE(waitFor(5s, [&sample]() { return !sample.is_null(); }));
+  ASSERT_TRUE(waitFor(5s, [&current]() {
+    return !current.is_null() && current.dump().find("\"204\"") != string::npos;
+  }));
+
+  auto &header = sample.at("/MTConnectStreams/Header"_json_pointer);
+  auto &circ = m_agentTestHelper->getAgent()->getCircularBuffer();
+  EXPECT_EQ(circ.getSequence(), header.at("nextSequence").get<int64_t>());
+  EXPECT_NE(string::npos, sample.dump().find("\"204\""));
+
+  // The current document has every data item of the device
+  EXPECT_NE(string::npos, current.dump().find("\"UNAVAILABLE\""));
+}
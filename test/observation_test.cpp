@@ -196,39 +196,82 @@ TEST_F(ObservationTest, ConvertSimpleUnits)
   TEST_VALUE(attributes, "PERCENT", "PERCENT", 2.0f, 2.0);
 }
 
-TEST_F(ObservationTest, ConditionEventChaining)
+TEST_F(ObservationTest, ConditionSetActivation)
 {
   ErrorList errors;
   auto dataItem =
       DataItem::make({{"id", "c1"s}, {"category", "CONDITION"s}, {"type", "TEMPERATURE"s}}, errors);
 
-  ConditionPtr event1 = Cond(Observation::make(dataItem, {{"level", "FAULT"s}}, m_time, errors));
-  ConditionPtr event2 = Cond(Observation::make(dataItem, {{"level", "FAULT"s}}, m_time, errors));
-  ConditionPtr event3 = Cond(Observation::make(dataItem, {{"level", "FAULT"s}}, m_time, errors));
+  ConditionPtr event1 = Cond(Observation::make(
+      dataItem, {{"level", "FAULT"s}, {"nativeCode", "CODE1"s}}, m_time, errors));
+  ConditionPtr event2 = Cond(Observation::make(
+      dataItem, {{"level", "FAULT"s}, {"nativeCode", "CODE2"s}}, m_time, errors));
+  ConditionPtr event3 = Cond(Observation::make(
+      dataItem, {{"level", "WARNING"s}, {"nativeCode", "CODE1"s}}, m_time, errors));
+
+  ConditionSet set;
+  ASSERT_TRUE(set.empty());
+
+  set.activate(event1);
+  set.activate(event2);
+  ASSERT_EQ(2, set.size());
+  ASSERT_TRUE(event2 == set.getNewest());
+  ASSERT_TRUE(event1 == set.find("CODE1"));
+  ASSERT_FALSE(set.find("CODE3"));
+
+  set.activate(event3);
+  ASSERT_EQ(2, set.size());
+  ASSERT_TRUE(event2 == set.getConditions().front());
+  ASSERT_TRUE(event3 == set.getNewest());
+  ASSERT_TRUE(event3 == set.find("CODE1"));
+  ASSERT_EQ(1, event1.use_count());
+
+  ASSERT_TRUE(set.clear("CODE2"));
+  ASSERT_FALSE(set.clear("CODE2"));
+  ASSERT_EQ(1, set.size());
+  ASSERT_FALSE(set.find("CODE2"));
+  ASSERT_EQ(1, event2.use_count());
+}
 
-  ASSERT_TRUE(event1 == event1->getFirst());
+TEST_F(ObservationTest, should_keep_activation_order_when_conditions_are_cleared)
+{
+  ErrorList errors;
+  auto dataItem =
+      DataItem::make({{"id", "c1"s}, {"category", "CONDITION"s}, {"type", "TEMPERATURE"s}}, errors);
 
-  event1->appendTo(event2);
-  ASSERT_TRUE(event1->getFirst() == event2);
+  ConditionSet set;
+  vector<ConditionPtr> events;
+  for (int i = 0; i < 10; i++)
+  {
+    events.push_back(Cond(Observation::make(
+        dataItem, {{"level", "FAULT"s}, {"nativeCode", "CODE"s + to_string(i)}}, m_time, errors)));
+    set.activate(events.back());
+  }
 
-  event2->appendTo(event3);
-  ASSERT_TRUE(event1->getFirst() == event3);
+  // Clear all but CODE3 and CODE7, the list is compacted along the way
+  for (int i = 0; i < 10; i++)
+  {
+    if (i != 3 && i != 7)
+      ASSERT_TRUE(set.clear("CODE"s + to_string(i)));
+  }
 
-  ASSERT_EQ(1, event1.use_count());
-  ASSERT_EQ(2, event2.use_count());
-  ASSERT_EQ(2, event3.use_count());
-
-  ConditionList list;
-  event1->getConditionList(list);
-  ASSERT_EQ(3, list.size());
-  ASSERT_TRUE(list.front() == event3);
-  ASSERT_TRUE(list.back() == event1);
-
-  ConditionList list2;
-  event2->getConditionList(list2);
-  ASSERT_EQ(2, list2.size());
-  ASSERT_TRUE(list2.front() == event3);
-  ASSERT_TRUE(list2.back() == event2);
+  ASSERT_EQ(2, set.size());
+  ASSERT_EQ(events[7], set.getNewest());
+  ASSERT_EQ(events[3], set.find("CODE3"));
+  ASSERT_EQ(events[7], set.find("CODE7"));
+  ASSERT_FALSE(set.find("CODE9"));
+
+  auto conditions = set.getConditions();
+  ASSERT_EQ(2, conditions.size());
+  ASSERT_EQ(events[3], conditions[0]);
+  ASSERT_EQ(events[7], conditions[1]);
+
+  set.activate(events[3]);
+  ASSERT_EQ(events[3], set.getNewest());
+  ASSERT_TRUE(set.clear("CODE3"));
+  ASSERT_EQ(events[7], set.getNewest());
+  ASSERT_TRUE(set.clear("CODE7"));
+  ASSERT_TRUE(set.empty());
 }
 
 TEST_F(ObservationTest, subType_prefix_should_be_passed_through)
@@ -284,7 +327,7 @@ TEST_F(ObservationTest, should_treat_events_with_non_count_units_as_doubles)
   printer::XmlWriter writer(true);
   entity::XmlPrinter printer;
 
-  printer.print((xmlTextWriterPtr)writer, event, {});
+  printer.print(writer, event, {});
 
   auto expected = string {
       R"DOC(<FeedrateOverride dataItemId="x" timestamp="2021-01-19T10:01:00Z">123.555</FeedrateOverride>
@@ -325,7 +368,7 @@ TEST_F(ObservationTest, should_treat_events_with_count_as_integer)
   printer::XmlWriter writer(true);
   entity::XmlPrinter printer;
 
-  printer.print((xmlTextWriterPtr)writer, event, {});
+  printer.print(writer, event, {});
 
   auto expected = string {
       R"DOC(<PartCount dataItemId="x" timestamp="2021-01-19T10:01:00Z">123</PartCount>
@@ -374,7 +417,7 @@ TEST_F(ObservationTest, should_use_three_space_sample_for_3_space_events)
   printer::XmlWriter writer(true);
   entity::XmlPrinter printer;
 
-  printer.print((xmlTextWriterPtr)writer, event, {});
+  printer.print(writer, event, {});
 
   auto expected = string {
       R"DOC(<WorkpieceOffset dataItemId="x" timestamp="2021-01-19T10:01:00Z">1.2 2.3 3.4</WorkpieceOffset>
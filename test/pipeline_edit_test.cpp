@@ -196,3 +196,50 @@ TEST_F(PipelineEditTest, append_R_last_after_B)
 
   ASSERT_EQ("SABC", result->getValue<string>());
 }
+
+TEST_F(PipelineEditTest, should_profile_transforms_when_profiling_is_enabled)
+{
+  auto context = make_shared<PipelineContext>();
+  context->m_profiler = make_shared<PipelineProfiler>();
+  boost::asio::io_context::strand strand(m_ioContext);
+  auto pipeline = make_unique<TestPipeline>(context, strand);
+  pipeline->getStart()->bind(m_pipeline->getStart()->getNext().front());
+
+  TestTransformPtr td = make_shared<TestTransform>("D"s, EntityNameGuard("X", RUN));
+  td->m_function = [&td](EntityPtr &&entity) -> EntityPtr {
+    if (entity->getValue<string>() == "DropAB")
+      return nullptr;
+    return td->next(std::move(entity));
+  };
+  ASSERT_TRUE(pipeline->spliceBefore("C", td));
+
+  pipeline->start();
+
+  auto entity = shared_ptr<Entity>(new Entity("X", Properties {{"VALUE", "S"s}}));
+  ASSERT_EQ("SABC", pipeline->run(std::move(entity))->getValue<string>());
+  entity = shared_ptr<Entity>(new Entity("X", Properties {{"VALUE", "Drop"s}}));
+  ASSERT_FALSE(pipeline->run(std::move(entity)));
+
+  auto pipelines = context->m_profiler->getProfiles();
+  ASSERT_EQ(1, pipelines.size());
+  ASSERT_EQ("Pipeline", pipelines.front().first);
+
+  auto &profiles = pipelines.front().second;
+  ASSERT_EQ(4, profiles.size());
+  auto it = profiles.begin();
+  for (auto [name, calls, dropped] : {make_tuple("A"s, 2, 0), make_tuple("B"s, 2, 0),
+                                      make_tuple("D"s, 2, 1), make_tuple("C"s, 1, 0)})
+  {
+    EXPECT_EQ(name, it->first);
+    EXPECT_EQ(calls, it->second->getCalls());
+    EXPECT_EQ(dropped, it->second->getDropped());
+    EXPECT_GE(it->second->getMax(), it->second->getPercentile(50.0));
+    it++;
+  }
+
+  auto json = context->m_profiler->toJson();
+  EXPECT_NE(string::npos, json.find("\"name\":\"D\",\"calls\":2,\"dropped\":1"));
+
+  pipeline.reset();
+  ASSERT_TRUE(context->m_profiler->getProfiles().empty());
+}
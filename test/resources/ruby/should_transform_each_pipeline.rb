@@ -0,0 +1,11 @@
+
+$trans =  MTConnect::RubyTransform.new("FixExecution", :Event) { |obs|
+  if obs.data_item.type == 'EXECUTION' and obs.value == "1"
+    obs = obs.dup
+    obs.value = "READY"
+  end
+  
+  forward(obs)  
+}
+
+MTConnect.pipeline.splice_after('Start', $trans)
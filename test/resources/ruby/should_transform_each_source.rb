@@ -0,0 +1,14 @@
+class FixExecution < MTConnect::RubyTransform
+  def transform(obs)
+    if obs.data_item.type == 'EXECUTION' and obs.value == "1"
+      obs = obs.dup
+      obs.value = "READY"
+    end
+
+    forward(obs)
+  end
+end
+
+MTConnect.agent.sources.each do |s|
+  s.pipeline.splice_after('Start', FixExecution.new('FixExecution', :Event))
+end
@@ -0,0 +1,246 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <chrono>
+
+#include "mtconnect/buffer/checkpoint.hpp"
+#include "mtconnect/observation/observation.hpp"
+#include "mtconnect/pipeline/deliver.hpp"
+#include "mtconnect/pipeline/pipeline.hpp"
+#include "mtconnect/pipeline/rule_transform.hpp"
+#include "mtconnect/pipeline/shdr_token_mapper.hpp"
+
+using namespace mtconnect;
+using namespace mtconnect::pipeline;
+using namespace mtconnect::observation;
+using namespace mtconnect::asset;
+using namespace device_model;
+using namespace data_item;
+using namespace entity;
+using namespace std;
+using namespace std::literals;
+using namespace std::chrono_literals;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+class MockPipelineContract : public PipelineContract
+{
+public:
+  MockPipelineContract(std::map<string, DataItemPtr> &items) : m_dataItems(items) {}
+  DevicePtr findDevice(const std::string &device) override { return nullptr; }
+  DataItemPtr findDataItem(const std::string &device, const std::string &name) override
+  {
+    return m_dataItems[name];
+  }
+  void eachDataItem(EachDataItem fun) override {}
+  void deliverObservation(observation::ObservationPtr obs) override
+  {
+    m_checkpoint.addObservation(obs);
+  }
+  void deliverAsset(AssetPtr) override {}
+  void deliverDevice(DevicePtr) override {}
+  void deliverAssetCommand(entity::EntityPtr) override {}
+  void deliverCommand(entity::EntityPtr) override {}
+  void deliverConnectStatus(entity::EntityPtr, const StringList &, bool) override {}
+  void sourceFailed(const std::string &id) override {}
+  const ObservationPtr checkDuplicate(const ObservationPtr &obs) const override
+  {
+    return m_checkpoint.checkDuplicate(obs);
+  }
+
+  std::map<string, DataItemPtr> &m_dataItems;
+  buffer::Checkpoint m_checkpoint;
+};
+
+class RuleTransformTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    ErrorList errors;
+    m_component = Component::make("Linear", {{"id", "x"s}, {"name", "X"s}}, errors);
+
+    m_context = make_shared<PipelineContext>();
+    m_context->m_contract = make_unique<MockPipelineContract>(m_dataItems);
+    m_mapper = make_shared<ShdrTokenMapper>(m_context);
+    m_mapper->bind(make_shared<NullTransform>(TypeGuard<Observations>(RUN)));
+
+    makeDataItem({{"id", "exec"s}, {"type", "EXECUTION"s}, {"category", "EVENT"s}});
+    makeDataItem({{"id", "pos"s},
+                  {"name", "Xpos"s},
+                  {"type", "POSITION"s},
+                  {"category", "SAMPLE"s},
+                  {"units", "MILLIMETER"s}});
+    makeDataItem({{"id", "act"s},
+                  {"type", "POSITION"s},
+                  {"subType", "ACTUAL"s},
+                  {"category", "SAMPLE"s},
+                  {"units", "MILLIMETER"s}});
+  }
+
+  void TearDown() override { m_dataItems.clear(); }
+
+  DataItemPtr makeDataItem(Properties attributes)
+  {
+    ErrorList errors;
+    auto di = DataItem::make(attributes, errors);
+    m_dataItems.emplace(di->getId(), di);
+    m_component->addDataItem(di, errors);
+
+    return di;
+  }
+
+  void bindRules(const RuleList &rules)
+  {
+    auto transform = make_shared<RuleTransform>(m_context, rules);
+    m_mapper->bind(transform);
+    transform->bind(make_shared<DeliverObservation>(m_context));
+  }
+
+  EntityList observe(TokenList tokens, Timestamp now = chrono::system_clock::now())
+  {
+    auto ts = make_shared<Timestamped>();
+    ts->m_tokens = tokens;
+    ts->m_timestamp = now;
+    ts->setProperty("timestamp", ts->m_timestamp);
+
+    return (*m_mapper)(ts)->getValue<EntityList>();
+  }
+
+  shared_ptr<ShdrTokenMapper> m_mapper;
+  std::map<string, DataItemPtr> m_dataItems;
+  shared_ptr<PipelineContext> m_context;
+  ComponentPtr m_component;
+};
+
+TEST_F(RuleTransformTest, should_evaluate_expressions)
+{
+  ErrorList errors;
+  auto di = m_dataItems["pos"];
+  auto obs = Observation::make(di, {{"VALUE", "25.4"s}}, chrono::system_clock::now(), errors);
+  ASSERT_TRUE(obs);
+
+  auto eval = [&obs](const string &text) { return RuleExpression::compile(text)->evaluate(*obs); };
+
+  ASSERT_EQ(RuleExpression::Result(1.0), eval("value / 25.4"));
+  ASSERT_EQ(RuleExpression::Result(7.0), eval("1 + 2 * 3"));
+  ASSERT_EQ(RuleExpression::Result(9.0), eval("(1 + 2) * 3"));
+  ASSERT_EQ(RuleExpression::Result(-2.0), eval("-(1 + 1)"));
+  ASSERT_EQ(RuleExpression::Result(true), eval("value > 10 && value < 30"));
+  ASSERT_EQ(RuleExpression::Result(false), eval("value > 30 or not (value > 10)"));
+  ASSERT_EQ(RuleExpression::Result(true), eval("value == '25.40'"));
+  ASSERT_EQ(RuleExpression::Result(true), eval("dataItemId == \"pos\""));
+  ASSERT_EQ(RuleExpression::Result(true), eval("value != UNAVAILABLE"));
+  // Upper case words are strings, other words are properties
+  ASSERT_EQ(RuleExpression::Result("READY_2"s), eval("READY_2"));
+  ASSERT_EQ(RuleExpression::Result("pos"s), eval("dataItemId"));
+  ASSERT_EQ(RuleExpression::Result(monostate()), eval("Ready"));
+  ASSERT_EQ(RuleExpression::Result(monostate()), eval("value / 0"));
+  ASSERT_EQ(RuleExpression::Result(monostate()), eval("missing * 2"));
+
+  ASSERT_THROW(RuleExpression::compile("value >"), std::invalid_argument);
+  ASSERT_THROW(RuleExpression::compile("(value"), std::invalid_argument);
+  ASSERT_THROW(RuleExpression::compile("value == 'READY"), std::invalid_argument);
+  ASSERT_THROW(RuleExpression::compile("value 1"), std::invalid_argument);
+}
+
+TEST_F(RuleTransformTest, should_map_and_compute_values)
+{
+  auto map = make_shared<Rule>();
+  map->m_name = "MapExecution";
+  map->m_dataItem = "exec";
+  map->m_map = {{"1", "READY"}, {"2", "ACTIVE"}};
+
+  auto scale = make_shared<Rule>();
+  scale->m_name = "Inches";
+  scale->m_dataItem = "Xpos";
+  scale->m_value = RuleExpression::compile("value * 25.4");
+
+  bindRules({map, scale});
+
+  auto list = observe({"exec", "1", "pos", "2", "act", "2"});
+  ASSERT_EQ(3, list.size());
+
+  auto it = list.begin();
+  ASSERT_EQ("READY", (*it++)->getValue<string>());
+  ASSERT_NEAR(50.8, (*it++)->getValue<double>(), 0.000001);
+  ASSERT_EQ(2.0, (*it++)->getValue<double>());
+
+  list = observe({"exec", "3"});
+  ASSERT_EQ(1, list.size());
+  ASSERT_EQ("3", list.front()->getValue<string>());
+
+  list = observe({"pos", "UNAVAILABLE"});
+  ASSERT_EQ(1, list.size());
+  ASSERT_TRUE(dynamic_pointer_cast<Observation>(list.front())->isUnavailable());
+}
+
+TEST_F(RuleTransformTest, should_drop_observations_matching_the_predicate)
+{
+  auto drop = make_shared<Rule>();
+  drop->m_name = "DropNoise";
+  drop->m_type = "POSITION";
+  drop->m_when = RuleExpression::compile("value < 0.5 && value > -0.5");
+  drop->m_drop = true;
+
+  bindRules({drop});
+
+  auto list = observe({"pos", "0.1", "act", "-0.2", "exec", "0"});
+  ASSERT_EQ(1, list.size());
+  ASSERT_EQ("0", list.front()->getValue<string>());
+
+  list = observe({"pos", "1.1", "act", "UNAVAILABLE"});
+  ASSERT_EQ(2, list.size());
+}
+
+TEST_F(RuleTransformTest, should_rename_data_items_without_changing_the_original)
+{
+  auto rename = make_shared<Rule>();
+  rename->m_name = "ActualPosition";
+  rename->m_dataItem = "pos";
+  rename->m_when = RuleExpression::compile("value >= 10");
+  rename->m_rename = "act";
+
+  auto wrong = make_shared<Rule>();
+  wrong->m_name = "NotAnEvent";
+  wrong->m_dataItem = "act";
+  wrong->m_rename = "exec";
+
+  bindRules({rename, wrong});
+
+  auto list = observe({"pos", "12"});
+  ASSERT_EQ(1, list.size());
+  auto obs = dynamic_pointer_cast<Observation>(list.front());
+  ASSERT_EQ("act", obs->getDataItem()->getId());
+  ASSERT_EQ("act", obs->get<string>("dataItemId"));
+  ASSERT_EQ("ACTUAL", obs->get<string>("subType"));
+  ASSERT_EQ(12.0, obs->getValue<double>());
+
+  list = observe({"pos", "5"});
+  ASSERT_EQ(1, list.size());
+  obs = dynamic_pointer_cast<Observation>(list.front());
+  ASSERT_EQ("pos", obs->getDataItem()->getId());
+}
@@ -98,3 +98,20 @@ TEST(UnitConversionTest, check_revolution_per_second)
   auto conv = UnitConversion::make("REVOLUTION/SECOND", "REVOLUTION/MINUTE");
   EXPECT_NEAR(420.0, conv->convert(7.0), 0.0001);
 }
+
+TEST(UnitConversionTest, should_convert_vectors_the_same_as_scalars)
+{
+  auto conv = UnitConversion::make("FAHRENHEIT", "CELSIUS");
+  Vector values;
+  for (int i = 0; i < 1001; i++)
+    values.push_back(i * 0.5 - 100.0);
+
+  auto converted = conv->convert(std::as_const(values));
+  conv->convert(values);
+  ASSERT_EQ(1001, values.size());
+  for (int i = 0; i < 1001; i++)
+  {
+    EXPECT_EQ(conv->convert(i * 0.5 - 100.0), values[i]);
+    EXPECT_EQ(values[i], converted[i]);
+  }
+}
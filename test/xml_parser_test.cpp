@@ -24,6 +24,7 @@
 #include <stdexcept>
 
 #include "mtconnect/device_model/reference.hpp"
+#include "mtconnect/parser/device_model_cache.hpp"
 #include "mtconnect/parser/xml_parser.hpp"
 #include "mtconnect/printer//xml_printer.hpp"
 #include "test_utilities.hpp"
@@ -497,3 +498,43 @@ TEST_F(XmlParserTest, ParseDeviceMTConnectVersion)
 
   ASSERT_EQ(string("1.7"), dev->get<string>("mtconnectVersion"));
 }
+
+TEST_F(XmlParserTest, should_keep_the_order_of_devices_parsed_in_parallel)
+{
+  printer::XmlPrinter printer;
+  auto devices = m_xmlParser->parseFile(PROJECT_ROOT_DIR "/samples/two_devices.xml", &printer);
+  ASSERT_EQ((size_t)2, devices.size());
+  ASSERT_EQ("Device1", *devices.front()->getComponentName());
+  ASSERT_EQ("Device2", *devices.back()->getComponentName());
+}
+
+TEST_F(XmlParserTest, should_rebuild_the_device_model_from_the_cache)
+{
+  auto file = PROJECT_ROOT_DIR "/samples/test_config.xml"s;
+  auto hash = parser::DeviceModelCache::hashFile(file);
+  ASSERT_FALSE(hash.empty());
+  ASSERT_TRUE(parser::DeviceModelCache::hashFile(PROJECT_ROOT_DIR "/samples/badPath.xml").empty());
+
+  parser::DeviceModelCache cache(TEST_BIN_ROOT_DIR "/device_model.cache");
+  ASSERT_TRUE(
+      cache.save(hash, {m_xmlParser->getSchemaVersion(), m_xmlParser->getNamespaces(), m_devices}));
+
+  auto model = cache.load(hash);
+  ASSERT_TRUE(model);
+  ASSERT_EQ(m_xmlParser->getSchemaVersion(), model->m_schemaVersion);
+  ASSERT_EQ(m_devices.size(), model->m_devices.size());
+
+  printer::XmlPrinter printer;
+  printer.setSchemaVersion("1.7");
+  ASSERT_EQ(printer.printProbe(0, 0, 0, 0, 0, m_devices),
+            printer.printProbe(0, 0, 0, 0, 0, model->m_devices));
+
+  auto device = model->m_devices.front();
+  auto di = device->getDeviceDataItem("p3");
+  ASSERT_TRUE(di);
+  ASSERT_EQ(device, di->getComponent()->getDevice());
+
+  // A different devices file does not use the cache
+  ASSERT_FALSE(cache.load(parser::DeviceModelCache::hashFile(PROJECT_ROOT_DIR
+                                                             "/samples/two_devices.xml")));
+}
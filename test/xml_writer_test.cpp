@@ -0,0 +1,268 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <libxml/xmlwriter.h>
+
+#include "mtconnect/printer/xml_printer_helper.hpp"
+
+using namespace std;
+using namespace mtconnect::printer;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+namespace {
+  // libxml2 reports the invalid characters it is given, they are expected here
+  void quiet(void *, const char *, ...) {}
+
+  /// @brief Writes the same operations as XmlWriter with the libxml2 text writer
+  class LibXmlWriter
+  {
+  public:
+    LibXmlWriter(bool pretty)
+    {
+      m_buffer = xmlBufferCreate();
+      m_writer = xmlNewTextWriterMemory(m_buffer, 0);
+      if (pretty)
+      {
+        xmlTextWriterSetIndent(m_writer, 1);
+        xmlTextWriterSetIndentString(m_writer, BAD_CAST "  ");
+      }
+    }
+    ~LibXmlWriter()
+    {
+      if (m_writer)
+        xmlFreeTextWriter(m_writer);
+      xmlBufferFree(m_buffer);
+    }
+
+    void startDocument() { xmlTextWriterStartDocument(m_writer, nullptr, "UTF-8", nullptr); }
+    void writeProcessingInstruction(const string &pi)
+    {
+      xmlTextWriterStartPI(m_writer, BAD_CAST pi.c_str());
+      xmlTextWriterEndPI(m_writer);
+    }
+    void startElement(const string &name)
+    {
+      xmlTextWriterStartElement(m_writer, BAD_CAST name.c_str());
+    }
+    void endElement() { xmlTextWriterEndElement(m_writer); }
+    void writeAttribute(const string &key, const string &value)
+    {
+      xmlTextWriterWriteAttribute(m_writer, BAD_CAST key.c_str(), BAD_CAST value.c_str());
+    }
+    void writeString(const string &text)
+    {
+      xmlTextWriterWriteString(m_writer, BAD_CAST text.c_str());
+    }
+    void writeEntities(const string &text)
+    {
+      xmlChar *encoded = xmlEncodeEntitiesReentrant(nullptr, BAD_CAST text.c_str());
+      xmlTextWriterWriteRaw(m_writer, encoded);
+      xmlFree(encoded);
+    }
+    void writeRaw(const string &text) { xmlTextWriterWriteRaw(m_writer, BAD_CAST text.c_str()); }
+
+    string getContent()
+    {
+      xmlTextWriterEndDocument(m_writer);
+      xmlFreeTextWriter(m_writer);
+      m_writer = nullptr;
+      return string((const char *)m_buffer->content, m_buffer->use);
+    }
+
+  protected:
+    xmlBufferPtr m_buffer;
+    xmlTextWriterPtr m_writer;
+  };
+
+  // Text with characters that need escaping, control characters, the CDATA terminator,
+  // quotes and line endings in attributes, and multibyte UTF-8.
+  const vector<string> Values {"",
+                               "plain text 123.5",
+                               "<>&",
+                               "'\"",
+                               "]]>",
+                               "a]]>b]]",
+                               "a\nb\r\nc\td",
+                               "line\n",
+                               "\x01\x08\x0B\x0C\x1F",
+                               "bell\x07 and escape\x1B",
+                               "\xC3\xA9t\xC3\xA9",
+                               "\xE2\x82\xAC 10",
+                               "\xE6\x97\xA5\xE6\x9C\xAC",
+                               "\xF0\x9D\x84\x9E",
+                               "\xCE\xA9 > \xCE\xB1 & \"\xCE\xB2\"\n"};
+}  // namespace
+
+class XmlWriterTest : public testing::Test
+{
+protected:
+  void SetUp() override { xmlSetGenericErrorFunc(nullptr, quiet); }
+  void TearDown() override { xmlSetGenericErrorFunc(nullptr, nullptr); }
+};
+
+TEST_F(XmlWriterTest, should_escape_text_and_attributes)
+{
+  XmlWriter writer(false);
+  writer.startElement("Root");
+  writer.writeAttribute("a", "\"q\" 'a'\n\r\t]]>");
+  writer.writeAttribute("b", "\xC3\xA9\xE2\x82\xAC\xF0\x9D\x84\x9E");
+  writer.startElement("Text");
+  writer.writeString("]]> a\r\nb \xC3\xA9");
+  writer.endElement();
+  writer.startElement("Entities");
+  writer.writeEntities("]]> \"\xC3\xA9\" \x01");
+  writer.endElement();
+  writer.endElement();
+
+  ASSERT_EQ(
+      "<Root a=\"&quot;q&quot; 'a'&#10;&#13;&#9;]]&gt;\" b=\"&#xE9;&#x20AC;&#x1D11E;\">"
+      "<Text>]]&gt; a&#13;\nb \xC3\xA9</Text>"
+      "<Entities>]]&gt; \"&#xE9;\" </Entities>"
+      "</Root>\n",
+      writer.getContent());
+}
+
+TEST_F(XmlWriterTest, should_write_the_same_document_as_libxml2)
+{
+  for (auto pretty : {false, true})
+  {
+    for (const auto &value : Values)
+    {
+      XmlWriter writer(pretty);
+      LibXmlWriter lib(pretty);
+
+      auto both = [&](auto f) {
+        f(writer);
+        f(lib);
+      };
+
+      both([](auto &w) { w.startDocument(); });
+      both([](auto &w) { w.writeProcessingInstruction("xml-stylesheet type=\"text/xsl\""); });
+      both([&](auto &w) {
+        w.startElement("Root");
+        w.writeAttribute("value", value);
+        w.startElement("Text");
+        w.writeString(value);
+        w.endElement();
+        w.startElement("Entities");
+        w.writeEntities(value);
+        w.endElement();
+        w.startElement("Empty");
+        w.writeAttribute("value", value);
+        w.endElement();
+        w.startElement("Mixed");
+        w.writeString(value);
+        w.startElement("Child");
+        w.endElement();
+        w.writeRaw("<Raw/>");
+        w.endElement();
+        w.endElement();
+      });
+
+      ASSERT_EQ(lib.getContent(), writer.getContent())
+          << "pretty: " << pretty << " value: " << value;
+    }
+  }
+}
+
+TEST_F(XmlWriterTest, should_match_libxml2_for_random_documents)
+{
+  mt19937 rng(4242);
+  auto text = [&]() {
+    string s;
+    for (auto n = rng() % 4; n > 0; n--)
+      s += Values[rng() % Values.size()];
+    return s;
+  };
+
+  for (int i = 0; i < 2000; i++)
+  {
+    bool pretty = rng() % 2;
+    XmlWriter writer(pretty);
+    LibXmlWriter lib(pretty);
+
+    if (rng() % 2)
+    {
+      writer.startDocument();
+      lib.startDocument();
+    }
+
+    int depth = 0;
+    bool open = false;
+    for (auto ops = rng() % 30; ops > 0; ops--)
+    {
+      auto op = rng() % 6;
+      if (op == 0 || depth == 0)
+      {
+        string name = "E" + to_string(rng() % 3);
+        writer.startElement(name);
+        lib.startElement(name);
+        depth++;
+        open = true;
+      }
+      else if (op == 1)
+      {
+        writer.endElement();
+        lib.endElement();
+        depth--;
+        open = false;
+      }
+      else if (op == 2 && open)
+      {
+        auto value = text();
+        writer.writeAttribute("a", value);
+        lib.writeAttribute("a", value);
+      }
+      else if (op == 3)
+      {
+        auto value = text();
+        writer.writeString(value);
+        lib.writeString(value);
+        open = false;
+      }
+      else if (op == 4)
+      {
+        auto value = text();
+        writer.writeEntities(value);
+        lib.writeEntities(value);
+        open = false;
+      }
+      else
+      {
+        writer.writeRaw("<r/>");
+        lib.writeRaw("<r/>");
+        open = false;
+      }
+    }
+
+    ASSERT_EQ(lib.getContent(), writer.getContent()) << "document " << i;
+  }
+}